@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Shader.h" 
+#include "UniformBlocks.h"
 #include <GLFW/glfw3.h> // <--- Adicione esta linha AQUI
 
 class Camera
@@ -11,6 +12,7 @@ class Camera
 public:
     Camera();
 
+    // shader pode ser nulo quando os programas já ligam os blocos (ShaderVariants)
     void initialize(Shader* shader, int width, int height);
     void update();
     void setCameraPos(int key);
@@ -22,6 +24,7 @@ public:
 
 private:
     Shader* shader;
+    UniformBuffer cameraBuffer; // bloco Camera (view, projection, viewPos) de todos os programas
     glm::vec3 cameraPos;
     glm::vec3 cameraFront;
     glm::vec3 cameraUp;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Hash e dados de origem usados para validar os caches gravados ao lado dos arquivos
+// (.vbm, .vbt, .vtx) e os binários de shader.
+
+// FNV-1a 64 bits
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+// hashBytes do arquivo inteiro (0 se não abrir)
+uint64_t hashFile(const string& path);
+
+// Tamanho e data de modificação do arquivo de origem de um cache (.vbm, .vbt, .vtx)
+bool sourceInfo(const string& path, uint64_t& size, int64_t& time);
+
+// Grava time no campo sourceTime (offset bytes após o início) de um cache que só foi aceito pelo
+// hash: a origem foi tocada sem mudar de conteúdo, e as próximas cargas voltam a conferir só a
+// data. O cache não pode estar mapeado (no Windows o mapeamento bloqueia a escrita).
+bool refreshSourceTime(const string& cachePath, size_t offset, int64_t time);
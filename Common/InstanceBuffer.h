@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+using namespace std;
+
+// Desenho instanciado: várias cópias da mesma malha (mesmo VAO) num glDraw*Instanced só.
+//
+// Cada instância tem uma matriz model e um vec4 livre, lidos como atributos de vértice com
+// divisor 1 (um valor por instância) de um VBO próprio; não há um glUniform por objeto. Com
+// OpenGL 3.3 não há SSBO, então os dados vão num VBO e não num buffer de armazenamento.
+//
+// Os atributos usam as locations INSTANCE_ATTRIB_MODEL (4 locations seguidas, uma por coluna)
+// e INSTANCE_ATTRIB_DATA; os shaders instanciados (sprite.vs com INSTANCED) declaram o mesmo.
+
+enum InstanceAttribute
+{
+    INSTANCE_ATTRIB_MODEL = 4, // mat4: locations 4 a 7
+    INSTANCE_ATTRIB_DATA = 8   // vec4
+};
+
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 data; // sprite.vs: x = camada da textura (< 0 usa o uniform texLayer); Modulo2: cor
+};
+static_assert(sizeof(InstanceData) == 80, "InstanceData deve ter 80 bytes");
+
+class InstanceBuffer
+{
+public:
+    InstanceBuffer() {}
+    ~InstanceBuffer() {}
+
+    // Cria o VBO e o liga aos atributos por instância do VAO (com o VBO de vértices dele intacto)
+    void create(GLuint vao);
+    void destroy();
+
+    // Instâncias do quadro: clear(), add() para cada uma e upload() antes de desenhar
+    void clear() { instances.clear(); }
+    void add(const glm::mat4& model, const glm::vec4& data = glm::vec4(0.0f))
+    {
+        instances.push_back({ model, data });
+    }
+
+    // Envia as instâncias; o buffer é órfão a cada envio, então o driver não espera a GPU
+    // terminar o quadro anterior
+    void upload();
+
+    // Com o VAO ligado: todas as instâncias, ou só as count primeiras
+    void drawArrays(GLenum mode, GLint first, GLsizei vertexCount) const;
+    void drawArrays(GLenum mode, GLint first, GLsizei vertexCount, GLsizei count) const;
+    void drawElements(GLenum mode, GLsizei indexCount, GLenum type, size_t byteOffset) const;
+
+    // Com o VAO ligado: só as instâncias [first, first + count) do último upload(). O OpenGL 3.3
+    // não tem base instance (4.2), então os atributos por instância são reapontados para first
+    // antes do desenho e voltam para o início depois.
+    void drawElements(GLenum mode, GLsizei indexCount, GLenum type, size_t byteOffset, GLsizei first, GLsizei count) const;
+
+    size_t size() const { return instances.size(); }
+    GLsizei uploaded() const { return uploadedCount; }
+
+private:
+    // glVertexAttribPointer dos atributos por instância, começando na instância first
+    // (com o VAO e o VBO ligados)
+    void pointAttributes(GLsizei first) const;
+
+    GLuint buffer = 0;
+    size_t capacity = 0;       // instâncias que cabem no VBO
+    GLsizei uploadedCount = 0; // instâncias do último upload()
+    vector<InstanceData> instances;
+};
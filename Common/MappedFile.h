@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// Arquivo somente leitura mapeado em memória (mmap / MapViewOfFile).
+// O conteúdo é acessado diretamente, sem cópia para std::string.
+class MappedFile
+{
+public:
+    MappedFile() : data(nullptr), size(0), opened(false), handle(nullptr) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& path);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+    size_t getSize() const { return size; }
+
+private:
+    const char* data;
+    size_t size;
+    bool opened;
+    void* handle; // HANDLE do mapeamento no Windows (não usado em POSIX)
+};
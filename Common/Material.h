@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+using namespace std;
+
+// Material de um bloco newmtl do .mtl (valores padrão iguais aos usados sem .mtl)
+struct Material
+{
+    string name;
+    glm::vec3 Ka = glm::vec3(0.1f, 0.1f, 0.1f);
+    glm::vec3 Kd = glm::vec3(0.7f, 0.7f, 0.7f);
+    glm::vec3 Ks = glm::vec3(1.0f, 1.0f, 1.0f);
+    float Ns = 32.0f;
+    float d = 1.0f;       // opacidade (d, ou 1 - Tr)
+    int illum = 2;        // modelo de iluminação do .mtl
+
+    // Mapas de textura, com o caminho já resolvido em relação à pasta do .mtl (vazio = sem mapa)
+    string map_Kd;
+    string map_Ks;
+    string map_Bump;      // map_Bump ou bump
+    string map_d;
+    float bumpMultiplier = 1.0f; // opção -bm de map_Bump
+
+    GLuint textureID = 0; // preenchido pelo programa ao carregar map_Kd
+    int textureLayer = -1; // camada de map_Kd quando textureID é um GL_TEXTURE_2D_ARRAY
+};
+
+// Lê todos os blocos newmtl do arquivo e os acrescenta a materials, na ordem do arquivo.
+// Nos mapas, as opções (-s, -o, -bm, -clamp, ...) são puladas e o resto da linha é o arquivo.
+bool loadMtl(const string& path, vector<Material>& materials);
+
+// Id em materials de cada nome de materialNames (os nomes de usemtl do .obj), procurando só a
+// partir de firstMaterial (materiais deste .mtl). Nomes sem material recebem defaultId.
+vector<int> resolveMaterials(const vector<Material>& materials, size_t firstMaterial, const vector<string>& materialNames, int defaultId);
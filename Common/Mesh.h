@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Shader.h" 
+#include "MeshCache.h"
 
 class Mesh
 {
@@ -14,6 +15,10 @@ public:
     void update(glm::vec3 position, bool rotateX, bool rotateY, bool rotateZ, float scale_val);
     void draw(GLuint textureID);
 
+    // Configura os atributos 0-3 do VBO ligado no momento conforme o formato dos vértices do cache
+    // (float: posição, uv e normal; quantizado: posição unorm16, uv half e normal em octaedro no 3)
+    static void setupVertexAttributes(const CachedMesh& mesh);
+
 protected:
     GLuint VAO;
     int nVertices;
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+
+#include "ObjLoader.h"
+#include "ObjStream.h"
+#include "FileHash.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+
+using namespace std;
+
+// Cache binário de malhas (.vbm), gravado ao lado do .obj na primeira carga.
+//
+// Layout (little-endian, blocos alinhados em 16 bytes):
+//   MeshCacheHeader
+//   vértices intercalados (vertexCount * vertexStride bytes)
+//   índices (indexCount * indexSize bytes)
+//   tabela de submalhas (submeshCount * MeshCacheSubmesh)
+//   tabela de níveis de detalhe (lodCount * MeshCacheLod), logo após as submalhas
+//   meshlets (meshletCount * Meshlet), logo após os níveis de detalhe
+//   strings terminadas em '\0': mtllib seguido dos nomes de material
+//
+// Nas execuções seguintes o arquivo é mapeado em memória e os blocos são
+// passados direto para glBufferData.
+
+const uint32_t MESH_CACHE_VERSION = 8;
+
+// Bits de MeshCacheHeader::flags: etapas de MeshOptimizer aplicadas aos índices e vértices
+const uint32_t MESH_FLAG_VERTEX_CACHE = 1u;
+const uint32_t MESH_FLAG_OVERDRAW = 2u;
+const uint32_t MESH_FLAG_MESHLETS = 4u;
+
+// materialId das submalhas sem usemtl
+const uint32_t MESH_NO_MATERIAL = 0xFFFFFFFFu;
+
+// Formato dos vértices no bloco intercalado
+enum MeshVertexFormat : uint32_t
+{
+    MESH_VERTEX_FLOAT32 = 0,  // posição vec3, uv vec2, normal vec3 (32 bytes)
+    MESH_VERTEX_QUANTIZED = 1 // MeshVertexQuantized (16 bytes)
+};
+
+struct MeshVertex
+{
+    float position[3];
+    float texcoord[2];
+    float normal[3];
+};
+static_assert(sizeof(MeshVertex) == 32, "MeshVertex deve ter 32 bytes");
+
+// Vértice compactado, decodificado no sprite.vs:
+//   posição unorm16 relativa à caixa da malha: p = positionOffset + q / 65535 * positionScale
+//   uv em half float (continua aceitando valores fora de [0, 1] para GL_REPEAT)
+//   normal em octaedro, 2 x snorm16
+struct MeshVertexQuantized
+{
+    uint16_t position[4]; // o 4º é preenchimento, para alinhar os atributos seguintes em 4 bytes
+    uint16_t texcoord[2];
+    int16_t normal[2];
+};
+static_assert(sizeof(MeshVertexQuantized) == 16, "MeshVertexQuantized deve ter 16 bytes");
+
+struct MeshCacheHeader
+{
+    char magic[4]; // "VBM1"
+    uint32_t version;
+    uint64_t sourceHash;  // FNV-1a 64 do conteúdo do .obj
+    uint64_t sourceSize;
+    int64_t sourceTime;   // data de modificação do .obj (atalho antes de calcular o hash)
+
+    uint32_t vertexFormat;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexSize;   // 2 ou 4 bytes
+    uint32_t indexCount;
+    uint32_t submeshCount;
+    uint32_t stringsSize;
+    uint32_t flags;       // MESH_FLAG_*
+
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t submeshOffset;
+    uint64_t stringsOffset;
+
+    float positionOffset[3]; // mínimo da caixa envolvente (MESH_VERTEX_QUANTIZED)
+    float positionScale[3];  // tamanho da caixa envolvente (MESH_VERTEX_QUANTIZED)
+    uint32_t lodCount;       // 0 = um único nível com todas as submalhas
+    uint32_t lodKey;         // parâmetros de MeshLodOptions usados na geração (0 = sem LODs)
+    uint32_t meshletCount;   // 0 = sem meshlets (modelos convertidos em streaming)
+    uint32_t reserved[3];
+};
+static_assert(sizeof(MeshCacheHeader) == 144, "MeshCacheHeader deve ter 144 bytes");
+
+// Faixa contígua de índices desenhada com um único material
+struct MeshCacheSubmesh
+{
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    uint32_t materialId;   // índice em CachedMesh::materialNames, ou MESH_NO_MATERIAL
+    uint32_t firstMeshlet; // meshlets da submalha: até o firstMeshlet da próxima (ou o fim da tabela)
+};
+
+// Nível de detalhe: as submalhas [firstSubmesh, firstSubmesh + submeshCount) desenham a malha inteira
+struct MeshCacheLod
+{
+    uint32_t firstSubmesh;
+    uint32_t submeshCount;
+    float error; // maior distância de um vértice do nível 0 à superfície deste nível, nas unidades das posições
+    uint32_t reserved;
+};
+
+// Etapas da última loadCachedMesh, para o programa imprimir (printMeshCacheStats) se quiser.
+// Só as etapas que rodaram ficam preenchidas.
+struct MeshCacheStats
+{
+    bool streamed = false; // convertido por streamObj em vez de loadObj
+    ObjLoadStats obj;
+    uint64_t streamChunks = 0;
+    double streamMs = 0.0;
+    MeshOptimizeStats optimize;
+    MeshLodStats lods;
+    double ms = 0.0;       // total, com a validação ou a gravação do cache
+};
+
+// Malha pronta para envio à GPU. Os ponteiros apontam para o arquivo mapeado
+// (cache válido) ou para a imagem montada em memória (cache recém-gerado).
+struct CachedMesh
+{
+    const void* vertices = nullptr;
+    uint32_t vertexFormat = MESH_VERTEX_FLOAT32;
+    uint32_t vertexStride = 0;
+    uint32_t vertexCount = 0;
+
+    const void* indices = nullptr;
+    uint32_t indexSize = 0;
+    uint32_t indexCount = 0;
+
+    // Decodificação da posição quantizada (0 e 1 no formato float)
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+
+    vector<MeshCacheSubmesh> submeshes; // ordenadas por material (na ordem do arquivo quando em streaming)
+    vector<MeshCacheLod> lods;          // do mais detalhado ao mais simples; sempre ao menos o nível 0
+    vector<Meshlet> meshlets;           // agrupados por submalha, na ordem das submalhas
+    vector<string> materialNames;
+    string mtlLib;
+
+    bool fromCache = false;
+    MeshCacheStats stats;
+
+    size_t vertexBytes() const { return (size_t)vertexCount * vertexStride; }
+    size_t indexBytes() const { return (size_t)indexCount * indexSize; }
+
+    // Quantidade de meshlets da submalha (0 quando o cache não tem meshlets)
+    uint32_t meshletCount(size_t submesh) const
+    {
+        const uint32_t end = submesh + 1 < submeshes.size() ? submeshes[submesh + 1].firstMeshlet : (uint32_t)meshlets.size();
+        return end - submeshes[submesh].firstMeshlet;
+    }
+
+    MappedFile file;      // mapeamento do .vbm quando lido do disco
+    vector<char> storage; // imagem em memória quando o cache não pôde ser lido
+};
+
+struct MeshCacheOptions
+{
+    MeshVertexFormat vertexFormat = MESH_VERTEX_FLOAT32; // cache em outro formato é regenerado
+    MeshOptimizeOptions optimize;                        // idem para outras etapas de otimização
+    ObjStreamOptions stream;                             // usado acima de MESH_STREAM_THRESHOLD
+    MeshLodOptions lod;                                  // níveis de detalhe (não gerados em streaming)
+    bool meshlets = true;                                // meshlets para descarte na CPU (não gerados em streaming)
+};
+
+// Grava um .vbm a partir dos blocos entregues por streamObj, sem manter a malha inteira
+// em memória: vértices e índices vão para arquivos temporários e são concatenados em finish().
+// Os índices são sempre de 4 bytes (o total de vértices só é conhecido no final).
+class MeshCacheWriter : public ObjStreamSink
+{
+public:
+    ~MeshCacheWriter();
+
+    bool open(const string& cachePath);
+    bool consume(const MeshVertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, int materialId) override;
+    bool finish(const ObjStreamInfo& info, uint64_t sourceSize, int64_t sourceTime, const MeshCacheOptions& options);
+
+private:
+    string path;
+    std::ofstream vertexFile;
+    std::ofstream indexFile;
+    vector<uint32_t> indexScratch;
+    vector<MeshCacheSubmesh> submeshes;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+// Acima deste tamanho o .obj é lido em streaming (streamObj) em vez de carregado inteiro
+const uint64_t MESH_STREAM_THRESHOLD = 256ull << 20;
+
+// Caminho do cache correspondente ao .obj
+string meshCachePath(const string& objPath);
+
+// Carrega o .obj usando o cache binário quando ele existe e corresponde ao arquivo de origem;
+// caso contrário lê o .obj, solda e otimiza (MeshOptimizer) os vértices, gera os níveis de
+// detalhe pedidos em options.lod (MeshSimplifier) e grava o cache para a próxima execução.
+// Arquivos maiores que MESH_STREAM_THRESHOLD são convertidos em streaming, com o pico
+// de memória limitado por options.stream.memoryBudget.
+bool loadCachedMesh(const string& objPath, CachedMesh& mesh, const MeshCacheOptions& options = MeshCacheOptions());
+
+// Uma linha em cout por etapa de mesh.stats (leitura, otimização, níveis de detalhe e cache)
+void printMeshCacheStats(const string& objPath, const CachedMesh& mesh);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "ObjLoader.h"
+
+using namespace std;
+
+// Otimização da ordem de desenho de malhas indexadas, feita uma vez ao gerar o cache (.vbm):
+//   1. ordem dos triângulos para o cache de vértices pós-transformação (algoritmo de Forsyth);
+//   2. ordenação opcional de grupos de triângulos para reduzir overdraw (estilo Tipsify);
+//   3. ordem dos vértices pela primeira utilização, para leitura sequencial do VBO.
+
+struct MeshOptimizeOptions
+{
+    bool enabled = true;
+    float overdrawThreshold = 1.05f; // piora máxima aceita no ACMR ao ordenar por overdraw; 0 = desliga
+};
+
+// Resultado da simulação de um cache FIFO de vértices
+struct VertexCacheStats
+{
+    size_t transformed = 0; // vértices que precisaram ser transformados (faltas no cache)
+    float acmr = 0.0f;      // vértices transformados por triângulo (ótimo ~0.5, pior 3)
+    float atvr = 0.0f;      // vértices transformados por vértice da malha (ótimo 1)
+};
+
+// Simula o cache FIFO da GPU sobre a lista de triângulos
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = 16);
+
+// Reordena os triângulos para aproveitar o cache de vértices (Forsyth, "Linear-Speed Vertex Cache Optimisation").
+// Quando os índices usam poucos dos vertexCount vértices, eles são renumerados antes (ver compactIndices).
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+// Divide a sequência já otimizada para o cache em grupos e desenha primeiro os que ficam
+// para fora da malha (mais prováveis de cobrir os outros). positions aponta para o x do
+// primeiro vértice, com positionStride floats entre vértices consecutivos.
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold);
+
+// Numeração local dos vértices usados por uma lista de índices: local[i] indexa vertices,
+// que guarda os índices originais em ordem crescente. Devolve vertices.size().
+size_t compactIndices(const uint32_t* indices, size_t indexCount, vector<uint32_t>& local, vector<uint32_t>& vertices);
+
+// Nova ordem dos vértices pela primeira utilização: remap[antigo] = novo (0xFFFFFFFF = não usado).
+// Os índices são reescritos; devolve a quantidade de vértices usados.
+size_t optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, vector<uint32_t>& remap);
+
+// optimizeVertexFetch sobre todos os índices de mesh, movendo os atributos junto; os vértices
+// não usados são descartados. Tem que vir depois da última etapa que reordena triângulos.
+void reorderVertices(IndexedMesh& mesh);
+
+// Cache simulado antes e depois de optimizeIndexedMesh (tudo zero quando desligada)
+struct MeshOptimizeStats
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+    size_t cacheSize = 0;
+    double ms = 0.0;
+};
+
+// Aplica as três etapas em cada submalha e reordena os vértices de mesh
+MeshOptimizeStats optimizeIndexedMesh(IndexedMesh& mesh, const MeshOptimizeOptions& options);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "ObjLoader.h"
+
+using namespace std;
+
+// Simplificação por colapso de arestas com métrica de erro quádrico (Garland & Heckbert).
+//
+// Os vértices só são movidos para a posição de um vizinho, então todos os níveis de
+// detalhe usam o mesmo buffer de vértices; cada LOD é apenas outra lista de índices.
+// Vértices de costura (mesma posição, uv ou normal diferentes) só colapsam ao longo da
+// costura e junto com o vértice irmão, e bordas abertas só ao longo da borda; assim as
+// costuras de uv e as arestas vivas (normais separadas) são mantidas.
+
+struct MeshLodOptions
+{
+    vector<float> ratios;    // fração de triângulos de cada LOD em relação ao original (ex.: 0.5, 0.25); vazio = sem LODs
+    float maxError = 0.05f;  // erro máximo, relativo ao tamanho da malha
+};
+
+// Simplifica a lista de triângulos até targetIndexCount índices ou até o erro passar de
+// maxError (mesma unidade das posições). Devolve a quantidade de índices escritos em out
+// (que deve ter espaço para indexCount) e o erro alcançado em resultError.
+// Se algum índice não for menor que vertexCount, a lista é copiada sem simplificação.
+size_t simplifyMesh(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount,
+                    size_t targetIndexCount, float maxError, uint32_t* out, float* resultError);
+
+// Triângulos de cada nível e tempo de generateLods
+struct MeshLodStats
+{
+    vector<size_t> triangles; // por nível de mesh.lods (vazio sem LODs)
+    double ms = 0.0;
+};
+
+// Acrescenta a mesh.indices/submeshes um nível por razão em options.ratios, com as mesmas
+// submalhas (materiais) do nível 0, e preenche mesh.lods. Níveis que quase não reduzem em
+// relação ao anterior são descartados. O erro de cada nível é medido: a maior distância de um
+// vértice do nível 0 até os triângulos do nível (o erro quádrico de simplifyMesh só guia os colapsos).
+MeshLodStats generateLods(IndexedMesh& mesh, const MeshLodOptions& options);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "ObjLoader.h"
+
+using namespace std;
+
+// Meshlets: grupos pequenos de triângulos contíguos no buffer de índices, cada um com esfera
+// envolvente e cone de normais. A cada quadro, os grupos fora do frustum ou inteiramente de
+// costas para a câmera são descartados na CPU e o resto é desenhado com glMultiDrawElements.
+
+const size_t MESHLET_MAX_VERTICES = 64;
+const size_t MESHLET_MAX_TRIANGLES = 124;
+
+struct Meshlet
+{
+    uint32_t indexOffset; // primeiro índice, no buffer inteiro
+    uint32_t indexCount;
+    float center[3];      // esfera envolvente, no espaço do objeto
+    float radius;
+    float coneApex[3];    // cone que contém as normais de todos os triângulos
+    float coneCutoff;     // seno do semiângulo do cone; > 1 = sem cone (nunca descartado por estar de costas)
+    float coneAxis[3];
+    uint32_t reserved[3];
+};
+static_assert(sizeof(Meshlet) == 64, "Meshlet deve ter 64 bytes");
+
+// Divide cada submalha em meshlets, reordenando os triângulos dentro da submalha para que cada
+// meshlet seja uma faixa contígua de índices (crescida por vizinhança e com normais parecidas).
+// firstMeshlet[s] recebe o primeiro meshlet da submalha s.
+void buildMeshlets(IndexedMesh& mesh, vector<Meshlet>& meshlets, vector<uint32_t>& firstMeshlet);
+
+// Planos do frustum (ax + by + cz + d >= 0 dentro), normalizados
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+// Extrai os planos de projection * view (Gribb & Hartmann)
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+// Esfera (em coordenadas de mundo) ao menos em parte dentro do frustum
+bool sphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius);
+
+// Triângulos descartados no quadro, somados por cullMeshlets
+struct MeshletCullStats
+{
+    size_t meshlets = 0;
+    size_t visibleMeshlets = 0;
+    size_t triangles = 0;      // triângulos dos meshlets testados
+    size_t frustumCulled = 0;  // em meshlets fora do frustum
+    size_t backfaceCulled = 0; // em meshlets inteiramente de costas para a câmera
+    size_t drawCalls = 0;      // faixas enviadas (meshlets visíveis consecutivos viram uma só)
+
+    void reset() { *this = MeshletCullStats(); }
+};
+
+// Acrescenta a offsets/counts (em índices) as faixas visíveis de meshlets[0 .. count) com a matriz
+// model; cameraPos em coordenadas de mundo. Meshlets visíveis vizinhos no buffer são unidos.
+// O teste de cone descarta meshlets só com faces de costas (anti-horárias vistas de fora),
+// o que só é correto com glEnable(GL_CULL_FACE) e glFrontFace(GL_CCW).
+void cullMeshlets(const Meshlet* meshlets, size_t count, const glm::mat4& model, const Frustum& frustum, const glm::vec3& cameraPos,
+                  vector<uint32_t>& offsets, vector<uint32_t>& counts, MeshletCullStats& stats);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Geração de mipmaps RGBA8 na CPU, sem depender do glGenerateMipmap do driver.
+//
+// Cada nível é a média 2x2 do anterior feita em espaço linear: as cores (sRGB) são convertidas
+// por tabela para linear, somadas e recodificadas para sRGB; o alfa é sempre linear. Há versões
+// escalar, SSE2 e AVX2 do mesmo cálculo, na mesma ordem de operações, que dão o mesmo resultado.
+
+enum MipSimdPath
+{
+    MIP_SCALAR,
+    MIP_SSE2,
+    MIP_AVX2
+};
+
+// Melhor caminho disponível na CPU atual
+MipSimdPath mipSimdPath();
+
+const char* mipSimdPathName(MipSimdPath path);
+
+// Nível seguinte (largura e altura divididas por 2, no mínimo 1; dimensões ímpares perdem a
+// última coluna/linha, como no glGenerateMipmap). srgb = false faz a média direto nos valores.
+void downsampleRgba(const uint8_t* rgba, uint32_t width, uint32_t height, vector<uint8_t>& out, bool srgb = true);
+void downsampleRgba(const uint8_t* rgba, uint32_t width, uint32_t height, vector<uint8_t>& out, bool srgb, MipSimdPath path);
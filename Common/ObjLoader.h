@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+
+using namespace std;
+
+// Índices de um canto de face, já convertidos para base 0 (-1 = ausente)
+struct ObjIndex
+{
+    int v;
+    int vt;
+    int vn;
+};
+
+// Triângulos a partir de firstTriangle usam materialId (índice em materialNames; -1 = sem usemtl)
+struct ObjMaterialRange
+{
+    size_t firstTriangle;
+    int materialId;
+};
+
+// Conteúdo bruto de um .obj, antes da expansão para os buffers de desenho
+struct ObjModel
+{
+    vector<glm::vec3> positions;
+    vector<glm::vec2> texcoords;
+    vector<glm::vec3> normals;
+    vector<ObjIndex> corners; // 3 por triângulo (polígonos já triangulados)
+    string mtlLib;
+
+    vector<string> materialNames;            // na ordem do primeiro usemtl de cada nome
+    vector<ObjMaterialRange> materialRanges; // ordenadas por firstTriangle, a primeira começa em 0
+
+    void clear();
+    void addMaterialRange(size_t firstTriangle, int materialId);
+    size_t triangleCount() const { return corners.size() / 3; }
+};
+
+// Triângulos, threads usadas e tempo de uma loadObj
+struct ObjLoadStats
+{
+    size_t triangles = 0;
+    size_t threads = 0;
+    double ms = 0.0;
+};
+
+// Lê o arquivo .obj via mmap e std::from_chars, sem alocação por linha.
+// Faces aceitam qualquer número de cantos (v, v/vt, v//vn, v/vt/vn, índices negativos)
+// e são trianguladas em leque (convexas) ou por corte de orelhas (côncavas).
+// numThreads = 0 usa std::thread::hardware_concurrency(); arquivos pequenos usam menos threads.
+// O resultado é idêntico (bit a bit) ao da leitura com uma única thread.
+// Nada é impresso; stats, quando dado, recebe as contagens e o tempo.
+bool loadObj(const string& path, ObjModel& model, int numThreads = 0, ObjLoadStats* stats = nullptr);
+
+// Malha indexada: um vértice por combinação única (v, vt, vn) e um índice por canto
+struct IndexedMesh
+{
+    vector<float> positions; // 3 floats por vértice
+    vector<float> texcoords; // 2 floats por vértice (V já invertido para o OpenGL)
+    vector<float> normals;   // 3 floats por vértice
+    vector<uint32_t> indices;
+
+    // Faixa de índices com um único material; as submalhas ficam ordenadas por material
+    struct Submesh
+    {
+        uint32_t indexOffset;
+        uint32_t indexCount;
+        int materialId; // índice em materialNames; -1 = sem material
+    };
+    vector<Submesh> submeshes;
+    vector<string> materialNames;
+
+    // Nível de detalhe: faixa de submalhas, todas sobre os mesmos vértices (ver generateLods).
+    // Vazio = um único nível com todas as submalhas.
+    struct Lod
+    {
+        uint32_t firstSubmesh;
+        uint32_t submeshCount;
+        float error; // maior distância de um vértice do nível 0 à superfície deste nível, nas unidades das posições
+    };
+    vector<Lod> lods;
+
+    void clear();
+    size_t vertexCount() const { return positions.size() / 3; }
+    size_t indexCount() const { return indices.size(); }
+};
+
+// Solda os cantos repetidos: cada tripla (v, vt, vn) vira um único vértice.
+// Os triângulos são agrupados por material, gerando uma submalha por material.
+void buildIndexedMesh(const ObjModel& model, IndexedMesh& mesh);
@@ -0,0 +1,92 @@
+#pragma once
+
+// Leitura de linhas de .obj compartilhada pelo carregador em memória
+// (ObjLoader.cpp) e pelo carregador em streaming (ObjStream.cpp).
+
+#include <vector>
+
+#include "ObjLoader.h"
+#include "TextParse.h"
+
+using namespace TextParse;
+
+// Converte o índice do arquivo para base 0. Positivos são absolutos (base 1),
+// negativos são relativos ao último atributo lido (-1 = o último); 0 = ausente.
+inline int toZeroBased(int index, size_t count)
+{
+    if (index > 0) return index - 1;
+    if (index < 0) return (int)count + index;
+    return -1;
+}
+
+// Quantidade de cada atributo já lida no ponto atual do arquivo (para índices negativos)
+struct AttributeCounts
+{
+    size_t positions;
+    size_t texcoords;
+    size_t normals;
+};
+
+// Lê um canto "v", "v/vt", "v//vn" ou "v/vt/vn"
+inline const char* parseCorner(const char* p, const char* end, const AttributeCounts& counts, ObjIndex& corner)
+{
+    int v = 0, vt = 0, vn = 0;
+    p = parseInt(p, end, v);
+    if (p < end && *p == '/')
+    {
+        ++p;
+        if (p < end && *p != '/') p = parseInt(p, end, vt);
+        if (p < end && *p == '/')
+        {
+            ++p;
+            p = parseInt(p, end, vn);
+        }
+    }
+    corner.v = toZeroBased(v, counts.positions);
+    corner.vt = toZeroBased(vt, counts.texcoords);
+    corner.vn = toZeroBased(vn, counts.normals);
+    return skipToken(p, end);
+}
+
+// Hash e igualdade de cantos, para soldar vértices com (v, vt, vn) iguais
+inline uint64_t hashCorner(const ObjIndex& corner)
+{
+    uint64_t h = (uint32_t)corner.v * 0x9E3779B97F4A7C15ull;
+    h ^= ((uint32_t)corner.vt + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+    h ^= ((uint32_t)corner.vn + 0x165667B19E3779F9ull) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+inline bool sameCorner(const ObjIndex& a, const ObjIndex& b)
+{
+    return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+}
+
+enum class ObjLine { Position, Texcoord, Normal, Face, MtlLib, UseMtl, Other };
+
+// Classifica a linha que começa em p e devolve o ponteiro após a palavra-chave
+inline ObjLine classifyLine(const char* p, const char* end, const char*& body)
+{
+    const char c0 = *p;
+    const char c1 = (p + 1 < end) ? p[1] : '\0';
+
+    if (c0 == 'v' && isBlank(c1)) { body = p + 1; return ObjLine::Position; }
+    if (c0 == 'v' && c1 == 't') { body = p + 2; return ObjLine::Texcoord; }
+    if (c0 == 'v' && c1 == 'n') { body = p + 2; return ObjLine::Normal; }
+    if (c0 == 'f' && isBlank(c1)) { body = p + 1; return ObjLine::Face; }
+    if (c0 == 'm' && matchKeyword(p, end, "mtllib", 6)) { body = p + 6; return ObjLine::MtlLib; }
+    if (c0 == 'u' && matchKeyword(p, end, "usemtl", 6)) { body = p + 6; return ObjLine::UseMtl; }
+    body = p;
+    return ObjLine::Other;
+}
+
+// Memória reaproveitada entre polígonos para não alocar por face
+struct TriangulationScratch
+{
+    vector<glm::vec2> projected;
+    vector<int> remaining;
+};
+
+// Triangula um polígono: leque quando é convexo, corte de orelhas quando é côncavo.
+// Os triângulos são acrescentados a out (3 cantos cada).
+void triangulatePolygon(const ObjIndex* polygon, size_t size, const glm::vec3* positions, size_t nPositions, TriangulationScratch& scratch, vector<ObjIndex>& out);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "MeshOptimizer.h"
+
+using namespace std;
+
+// Leitura de .obj em streaming, para modelos que não cabem na memória.
+//
+// O arquivo é lido em janelas de tamanho fixo, em duas passadas:
+//   1. os atributos (v, vt, vn) são copiados em binário para arquivos temporários;
+//   2. as faces são lidas de novo, trianguladas e soldadas em blocos de vértices/índices
+//      entregues a um ObjStreamSink assim que ficam prontos.
+// Os atributos da 1ª passada são acessados por mmap somente leitura: são páginas
+// limpas que o sistema pode descartar, então o pico de memória própria fica
+// limitado pela janela de texto e pelo bloco em montagem.
+
+struct MeshVertex;
+
+// Destino dos blocos prontos (arquivo .vbm, buffer da GPU, ...)
+class ObjStreamSink
+{
+public:
+    virtual ~ObjStreamSink() {}
+
+    // Índices locais ao bloco (0 .. vertexCount-1). materialId: índice em
+    // ObjStreamInfo::materialNames, ou -1 antes do primeiro usemtl.
+    virtual bool consume(const MeshVertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, int materialId) = 0;
+};
+
+struct ObjStreamOptions
+{
+    size_t memoryBudget = 256u << 20; // janela de texto + bloco em montagem
+    MeshOptimizeOptions optimize;     // aplicado a cada bloco antes de ir para o sink
+};
+
+// Dados do arquivo conhecidos só ao final da leitura
+struct ObjStreamInfo
+{
+    string mtlLib;
+    vector<string> materialNames; // na ordem do primeiro usemtl de cada nome
+    uint64_t sourceHash = 0;      // FNV-1a 64 do .obj (mesmo valor de hashBytes)
+    uint64_t triangleCount = 0;
+    uint64_t chunkCount = 0;      // blocos entregues ao sink
+    double ms = 0.0;
+};
+
+// Lê o .obj em janelas e envia os blocos ao sink, na ordem do arquivo.
+// Os vértices são soldados dentro de cada bloco; um usemtl sempre começa um bloco novo.
+bool streamObj(const string& path, ObjStreamSink& sink, const ObjStreamOptions& options, ObjStreamInfo& info);
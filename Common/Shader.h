@@ -6,6 +6,8 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <unordered_map>
 
 //GLAD
 #include <glad/glad.h>
@@ -15,14 +17,27 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp> // Necessário para glm::value_ptr
 
+#include "ShaderCache.h"
+
 using namespace std;
 
+// Handle de um uniform, resolvido uma vez com Shader::uniform<T>("nome"). Guarda só o índice
+// de um slot: set() custa uma indexação, sem glGetUniformLocation. Os slots são globais (um por
+// nome), então o mesmo handle serve para todos os programas, inclusive variantes do mesmo shader.
+// O slot 0 é reservado (localização -1), então um handle não inicializado não faz nada.
+template <typename T>
+struct Uniform
+{
+    int slot = 0;
+};
+
 class Shader
 {
 public:
     GLuint ID;
     // Constructor generates the shader on the fly
-    Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
+    // defines: linhas "#define ..." inseridas depois do #version nos dois estágios (variantes)
+    Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const std::string& defines = "")
     {
         // 1. Retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
@@ -52,96 +67,186 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
         }
-        const GLchar* vShaderCode = vertexCode.c_str();
-        const GLchar * fShaderCode = fragmentCode.c_str();
-        // 2. Compile shaders
-        GLuint vertex, fragment;
-        GLint success;
-        GLchar infoLog[512];
-        // Vertex Shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        // Print compile errors if any
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-        // Fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        // Print compile errors if any
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if (!success)
+        // 2. Compile and link, or reuse the program binary cached by a previous run
+        this->ID = buildProgram(vertexCode, fragmentCode, defines, std::string(vertexPath) + " + " + fragmentPath);
+        if (this->ID) reflectUniforms();
+    }
+    // Programa submetido a um ShaderBatch: status e erros só são consultados aqui, no primeiro uso
+    Shader(ShaderBatch& batch, int program)
+    {
+        this->ID = batch.get(program);
+        if (this->ID) reflectUniforms();
+    }
+    // Uses the current shader
+    void Use()
+    {
+        glUseProgram(this->ID);
+    }
+
+    // Lê todos os uniforms ativos do programa (glGetActiveUniform) para a tabela de localizações
+    // e atualiza os slots dos handles já criados. Chamado depois de cada link.
+    void reflectUniforms()
+    {
+        locations.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> buffer(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; ++i)
         {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(this->ID, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+            GLint location = glGetUniformLocation(this->ID, name.c_str());
+            if (location < 0) continue; // membros de uniform blocks não têm localização
+            locations[name] = location;
+
+            // Arrays aparecem como "nome[0]": registra também "nome" e cada elemento
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                const std::string base = name.substr(0, name.size() - 3);
+                locations[base] = location;
+                for (GLint k = 1; k < size; ++k)
+                {
+                    const std::string element = base + "[" + std::to_string(k) + "]";
+                    locations[element] = glGetUniformLocation(this->ID, element.c_str());
+                }
+            }
         }
-        // Shader Program
-        this->ID = glCreateProgram();
-        glAttachShader(this->ID, vertex);
-        glAttachShader(this->ID, fragment);
-        glLinkProgram(this->ID);
-        // Print linking errors if any
-        glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
-        if (!success)
+
+        slotLocations.assign(1, -1);
+        resolveSlots();
+    }
+
+    // Localização pela tabela refletida; -1 (ignorado pelo glUniform*) se o uniform não está ativo
+    GLint getLocation(const std::string& name) const
+    {
+        auto it = locations.find(name);
+        return it != locations.end() ? it->second : -1;
+    }
+
+    // Handle tipado para uso por quadro; pedir o mesmo nome de novo devolve o mesmo slot
+    template <typename T>
+    static Uniform<T> uniform(const std::string& name)
+    {
+        std::vector<std::string>& names = slotNames();
+        Uniform<T> handle;
+        for (size_t slot = 1; slot < names.size(); ++slot)
         {
-            glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+            if (names[slot] == name)
+            {
+                handle.slot = (int)slot;
+                return handle;
+            }
         }
-        // Delete the shaders as they're linked into our program now and no longer necessery
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        handle.slot = (int)names.size();
+        names.push_back(name);
+        return handle;
+    }
 
+    void set(Uniform<bool> handle, bool value) const
+    {
+        glUniform1i(slotLocation(handle.slot), (int)value);
     }
-    // Uses the current shader
-    void Use()
+    void set(Uniform<int> handle, int value) const
     {
-        glUseProgram(this->ID);
+        glUniform1i(slotLocation(handle.slot), value);
+    }
+    void set(Uniform<float> handle, float value) const
+    {
+        glUniform1f(slotLocation(handle.slot), value);
+    }
+    void set(Uniform<glm::vec2> handle, const glm::vec2& value) const
+    {
+        glUniform2fv(slotLocation(handle.slot), 1, glm::value_ptr(value));
+    }
+    void set(Uniform<glm::vec3> handle, const glm::vec3& value) const
+    {
+        glUniform3fv(slotLocation(handle.slot), 1, glm::value_ptr(value));
+    }
+    void set(Uniform<glm::vec4> handle, const glm::vec4& value) const
+    {
+        glUniform4fv(slotLocation(handle.slot), 1, glm::value_ptr(value));
+    }
+    void set(Uniform<glm::mat4> handle, const glm::mat4& value) const
+    {
+        glUniformMatrix4fv(slotLocation(handle.slot), 1, GL_FALSE, glm::value_ptr(value));
     }
 
+    // Setters por nome: caminho lento, para configuração (setOnCreate, materiais). Não consultam
+    // o driver, mas cada chamada calcula o hash do nome e busca em locations; no laço de
+    // desenho use handles Uniform<T> (tests/UniformBench compara os dois caminhos).
     void setBool(const std::string& name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(this->ID, name.c_str()), (int)value);
+        glUniform1i(getLocation(name), (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string& name, int value) const
     {
-        glUniform1i(glGetUniformLocation(this->ID, name.c_str()), value);
+        glUniform1i(getLocation(name), value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string& name, float value) const
     {
-        glUniform1f(glGetUniformLocation(this->ID, name.c_str()), value);
+        glUniform1f(getLocation(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec2(const std::string& name, float v1, float v2) const
+    {
+        glUniform2f(getLocation(name), v1, v2);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string& name, float v1, float v2, float v3) const
     {
-        glUniform3f(glGetUniformLocation(this->ID, name.c_str()), v1, v2, v3);
+        glUniform3f(getLocation(name), v1, v2, v3);
     }
     // ------------------------------------------------------------------------
     // Novo método para setVec3 que aceita glm::vec3
     void setVec3(const std::string& name, const glm::vec3 &value) const
     {
-        glUniform3fv(glGetUniformLocation(this->ID, name.c_str()), 1, glm::value_ptr(value));
+        glUniform3fv(getLocation(name), 1, glm::value_ptr(value));
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string& name, float v1, float v2, float v3, float v4) const
     {
-        glUniform4f(glGetUniformLocation(this->ID, name.c_str()), v1, v2, v3,v4);
+        glUniform4f(getLocation(name), v1, v2, v3,v4);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string& name, float *v) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, v);
+        glUniformMatrix4fv(getLocation(name), 1, GL_FALSE, v);
     }
     // ------------------------------------------------------------------------
     // Novo método para setMat4 que aceita glm::mat4
     void setMat4(const std::string& name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+        glUniformMatrix4fv(getLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+private:
+    // Nome de cada slot, comum a todos os shaders (slot 0 reservado)
+    static std::vector<std::string>& slotNames()
+    {
+        static std::vector<std::string> names = { "" };
+        return names;
+    }
+
+    // Handles criados depois deste programa são resolvidos no primeiro set()
+    GLint slotLocation(int slot) const
+    {
+        if ((size_t)slot >= slotLocations.size()) resolveSlots();
+        return slotLocations[slot];
+    }
+
+    void resolveSlots() const
+    {
+        const std::vector<std::string>& names = slotNames();
+        for (size_t slot = slotLocations.size(); slot < names.size(); ++slot)
+            slotLocations.push_back(getLocation(names[slot]));
     }
+
+    std::unordered_map<std::string, GLint> locations; // uniforms ativos -> localização
+    mutable std::vector<GLint> slotLocations = { -1 }; // localização de cada slot neste programa
 };
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+using namespace std;
+
+// Criação de programas de shader com cache dos binários linkados.
+//
+// buildProgram() calcula um hash das fontes, dos defines e do driver (GL_VENDOR, GL_RENDERER,
+// GL_VERSION). Se existir <diretório>/<hash>.bin, o programa é recriado com glProgramBinary, sem
+// compilar; se o driver recusar o binário (atualização, outro formato), compila do zero e grava
+// um binário novo. Sem suporte a binários (GL_ARB_get_program_binary ausente ou nenhum formato),
+// compila sempre, como antes.
+//
+// ShaderBatch compila vários programas de uma vez: submit() só dispara compilação e link, sem
+// consultar GL_COMPILE_STATUS/GL_LINK_STATUS (consultas que fazem o driver terminar o trabalho
+// ali mesmo). Com GL_KHR_parallel_shader_compile (ou a versão ARB) o driver compila em threads
+// próprias e isReady() consulta GL_COMPLETION_STATUS_KHR sem bloquear. O status só é checado em
+// get(), quando o programa é usado pela primeira vez.
+//
+// As funções de binário de programa (OpenGL 4.1) e de compilação paralela não estão na glad
+// gerada para 4.0 e são buscadas com glfwGetProcAddress na primeira chamada; é preciso um
+// contexto atual. Depois dessa primeira chamada, outra thread com um contexto compartilhado
+// também pode compilar (ShaderWatcher).
+//
+// Layout do .bin (little-endian): ShaderBinaryHeader e os binaryLength bytes do driver.
+
+const uint32_t SHADER_CACHE_VERSION = 1;
+
+struct ShaderBinaryHeader
+{
+    char magic[4]; // "VSB1"
+    uint32_t version;
+    uint64_t key;          // hash de fontes + defines + driver
+    uint32_t binaryFormat; // formato devolvido por glGetProgramBinary
+    uint32_t binaryLength;
+};
+static_assert(sizeof(ShaderBinaryHeader) == 24, "ShaderBinaryHeader deve ter 24 bytes");
+
+struct ShaderCacheStats
+{
+    size_t hits = 0;     // programas recriados do binário
+    size_t misses = 0;   // compilados (sem binário no cache ou sem suporte)
+    size_t rejected = 0; // binários recusados pelo driver e recompilados
+    double loadMs = 0.0;    // tempo desta thread em programas vindos do cache
+    double compileMs = 0.0; // tempo desta thread em programas compilados (submit + espera no get)
+};
+
+// Pasta dos binários (padrão "shadercache", relativa à pasta de execução; criada se não existir)
+void setShaderCacheDirectory(const string& directory);
+
+// Desliga/religa o cache (desligado, buildProgram só compila e linka)
+void setShaderCacheEnabled(bool enabled);
+
+// Insere defines (linhas "#define ...") logo depois da linha #version da fonte
+string injectDefines(const string& source, const string& defines);
+
+// Programa linkado a partir das fontes GLSL, com os defines inseridos nos dois estágios.
+// Erros de compilação e link são impressos como no Shader; devolve 0 se falharem.
+// label só aparece nas mensagens. Equivale a um ShaderBatch com um programa só.
+GLuint buildProgram(const string& vertexSource, const string& fragmentSource, const string& defines = "", const string& label = "");
+
+// Verdadeiro se o driver compila em paralelo (GL_KHR/ARB_parallel_shader_compile)
+bool parallelShaderCompileAvailable();
+
+// Lote de programas compilados em paralelo pelo driver, com as checagens adiadas até o uso.
+// Cada programa submetido deve ser pego com get() (na thread do OpenGL).
+class ShaderBatch
+{
+public:
+    ShaderBatch() {}
+    ~ShaderBatch() {}
+
+    // Devolve o índice do programa no lote
+    int submit(const string& vertexSource, const string& fragmentSource, const string& defines = "", const string& label = "");
+    int submitFiles(const string& vertexPath, const string& fragmentPath, const string& defines = "");
+
+    // Sem bloquear: o driver já terminou (sempre verdadeiro sem compilação paralela)
+    bool isReady(int index) const;
+
+    // Checa status, imprime erros e grava o binário no cache; bloqueia se o driver ainda não
+    // terminou. 0 se a compilação ou o link falharam.
+    GLuint get(int index);
+
+    size_t size() const { return jobs.size(); }
+
+private:
+    struct Job
+    {
+        string label;
+        string vertexSource;   // fontes com os defines, guardadas para recompilar se o binário
+        string fragmentSource; // do cache for recusado
+        uint64_t key = 0;
+        string path;           // vazio = sem cache
+        GLuint program = 0;
+        GLuint vertex = 0;
+        GLuint fragment = 0;
+        bool fromBinary = false;
+        bool finished = false;
+        double ms = 0.0;       // tempo gasto nesta thread
+    };
+
+    static void startCompile(Job& job);
+    static void finish(Job& job);
+
+    vector<Job> jobs;
+};
+
+ShaderCacheStats getShaderCacheStats();
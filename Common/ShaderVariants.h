@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Shader.h"
+#include "Material.h"
+#include "UniformBlocks.h"
+#include "ShaderWatcher.h"
+
+using namespace std;
+
+// Variantes de um par de shaders, uma por combinação de features.
+//
+// Cada feature vira um #define inserido depois do #version (injectDefines) e o shader usa #if em
+// vez de ifs em uniforms: cada material roda só o código que usa, sem desvios. As variantes são
+// compiladas na primeira vez que são pedidas e guardadas aqui; o binário de cada uma vai para o
+// cache de ShaderCache.h com a própria chave (os defines entram no hash).
+
+// De onde vem a cor difusa (TEXTURE_SOURCE)
+enum TextureSource : uint32_t
+{
+    TEXTURE_SOURCE_2D = 0,     // tex_buffer
+    TEXTURE_SOURCE_ARRAY = 1,  // camada texLayer de tex_array (TextureManager::requestArray)
+    TEXTURE_SOURCE_VIRTUAL = 2 // textura virtual de VirtualTexture::bind
+};
+
+struct ShaderFeatures
+{
+    int numPointLights = MAX_POINT_LIGHTS; // NUM_POINT_LIGHTS: luzes acesas, no começo de Lights
+    bool hasDiffuseMap = true;             // HAS_DIFFUSE_MAP
+    bool hasSpecular = true;               // HAS_SPECULAR
+    bool quantizedNormals = false;         // QUANTIZED_NORMALS: vértices MESH_VERTEX_QUANTIZED
+    bool instanced = false;                // INSTANCED: model por instância (InstanceBuffer.h)
+    TextureSource textureSource = TEXTURE_SOURCE_2D; // TEXTURE_SOURCE (só com hasDiffuseMap)
+
+    // Linhas "#define ..." de todas as features
+    string defines() const;
+
+    // Identifica a combinação (mesma chave = mesmos defines)
+    uint32_t key() const;
+};
+
+// O termo especular só vale a pena com illum >= 2 e Ks não nulo
+bool materialHasSpecular(const Material& material);
+
+class ShaderVariants
+{
+public:
+    ShaderVariants(const string& vertexPath, const string& fragmentPath);
+    ~ShaderVariants() {}
+
+    // Chamado uma vez para cada variante nova, com ela em uso (samplers, uniforms que não mudam).
+    // Os blocos de UniformBlocks.h já são ligados aqui.
+    void setOnCreate(function<void(Shader&)> callback) { onCreate = callback; }
+
+    // Variantes criadas daqui em diante são recompiladas pelo watcher quando os arquivos mudam
+    // (o onCreate roda de novo no programa recarregado)
+    void setWatcher(ShaderWatcher* watcher) { this->watcher = watcher; }
+
+    // Submete num ShaderBatch as variantes que ainda não existem (p.ex. as dos materiais da
+    // cena), para que o driver as compile em paralelo em vez de uma a uma durante o desenho.
+    // Não espera nada: status, erros e onCreate de cada uma ficam para o primeiro get().
+    void prepare(const vector<ShaderFeatures>& features);
+
+    // Variante dessas features; compilada na primeira chamada, ou pega do lote de prepare().
+    // Pode trocar o programa em uso.
+    Shader& get(const ShaderFeatures& features);
+
+    // Variantes prontas e submetidas por prepare()
+    size_t size() const { return variants.size() + pending.size(); }
+
+private:
+    // O lote de prepare() é liberado quando o último programa dele é pego
+    struct PendingVariant
+    {
+        shared_ptr<ShaderBatch> batch;
+        int program = 0; // índice no lote
+    };
+
+    Shader& add(const ShaderFeatures& features, unique_ptr<Shader> shader);
+
+    string vertexPath;
+    string fragmentPath;
+    function<void(Shader&)> onCreate;
+    ShaderWatcher* watcher = nullptr;
+    unordered_map<uint32_t, unique_ptr<Shader>> variants;
+    unordered_map<uint32_t, PendingVariant> pending; // submetidas, ainda não pegas do lote
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include <glad/glad.h>
+
+#include "Shader.h"
+
+struct GLFWwindow;
+
+using namespace std;
+
+// Recarga de shaders com o programa rodando.
+//
+// Uma thread observa com inotify (só Linux) as pastas dos arquivos registrados. Quando um deles é
+// salvo, os programas que o usam são recompilados nessa thread, num contexto OpenGL invisível
+// compartilhado com o da janela; malhas e texturas não são recarregadas. update(), chamado pela
+// thread principal entre dois quadros, troca o ID de cada Shader pelo programa novo, relê os
+// uniforms (os handles Uniform<T> continuam valendo), religa os blocos de UniformBlocks.h e chama
+// o onReload do programa para reenviar os uniforms que não mudam (samplers etc.).
+// Se a compilação falhar, o erro é impresso e o programa antigo continua em uso.
+
+class ShaderWatcher
+{
+public:
+    ShaderWatcher() {}
+    ~ShaderWatcher() { stop(); }
+
+    // Cria o contexto compartilhado e começa a observar. Chamar na thread principal, com o
+    // contexto de window atual. Falso fora do Linux ou se não deu para criar o contexto.
+    bool start(GLFWwindow* window);
+
+    // Para a thread e destrói o contexto; chamar antes de glfwTerminate
+    void stop();
+
+    // Recompila shader quando vertexPath ou fragmentPath mudar, com os mesmos defines.
+    // O Shader precisa continuar no mesmo endereço enquanto o watcher existir.
+    void add(Shader& shader, const string& vertexPath, const string& fragmentPath, const string& defines = "", function<void(Shader&)> onReload = nullptr);
+
+    // Troca os programas recompilados desde a última chamada e devolve quantos trocou.
+    // O programa em uso muda: quem desenha deve chamar glUseProgram de novo.
+    int update();
+
+    bool isRunning() const { return worker.joinable(); }
+
+private:
+    struct Entry
+    {
+        Shader* shader;
+        string vertexPath;   // caminhos absolutos
+        string fragmentPath;
+        string defines;
+        function<void(Shader&)> onReload;
+    };
+    struct Result
+    {
+        size_t entry;
+        GLuint program;
+    };
+
+    void watch();
+    void rebuild(const vector<string>& changed);
+    void addWatch(const string& path);
+
+    GLFWwindow* context = nullptr;
+    int inotifyFd = -1;
+    vector<pair<int, string>> watches; // descritor do inotify -> pasta
+    vector<Entry> entries;             // escritos só pela thread principal, com lock
+    vector<Result> ready;              // programas prontos esperando update()
+    mutex lock;
+    atomic<bool> stopping{ false };
+    thread worker;
+};
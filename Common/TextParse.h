@@ -0,0 +1,84 @@
+#pragma once
+
+// Funções de leitura de texto usadas pelos carregadores de .obj e .mtl.
+// Trabalham sobre o buffer mapeado [p, end), sem criar std::string por linha.
+
+#include <string>
+#include <cstring>
+#include <charconv>
+
+namespace TextParse
+{
+    inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    inline const char* skipBlanks(const char* p, const char* end)
+    {
+        while (p < end && isBlank(*p)) ++p;
+        return p;
+    }
+
+    inline const char* skipToken(const char* p, const char* end)
+    {
+        while (p < end && !isBlank(*p) && *p != '\n') ++p;
+        return p;
+    }
+
+    inline const char* nextLine(const char* p, const char* end)
+    {
+        const char* newline = (const char*)memchr(p, '\n', end - p);
+        return newline ? newline + 1 : end;
+    }
+
+    // Verdadeiro se a linha em p começa com a palavra-chave seguida de espaço ou fim de linha
+    inline bool matchKeyword(const char* p, const char* end, const char* keyword, size_t length)
+    {
+        if ((size_t)(end - p) < length || memcmp(p, keyword, length) != 0) return false;
+        return p + length == end || isBlank(p[length]) || p[length] == '\n';
+    }
+
+    // Lê um float; em caso de erro retorna 0 e avança até o fim do token
+    inline const char* parseFloat(const char* p, const char* end, float& value)
+    {
+        p = skipBlanks(p, end);
+        if (p < end && *p == '+') ++p; // from_chars não aceita '+'
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+        {
+            value = 0.0f;
+            return skipToken(p, end);
+        }
+        return result.ptr;
+    }
+
+    inline const char* parseInt(const char* p, const char* end, int& value)
+    {
+        if (p < end && *p == '+') ++p;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+        {
+            value = 0;
+            return p;
+        }
+        return result.ptr;
+    }
+
+    // Resto da linha sem espaços nas bordas, como intervalo [first, last)
+    inline void restOfLine(const char* p, const char* end, const char*& first, const char*& last)
+    {
+        p = skipBlanks(p, end);
+        const char* lineEnd = p;
+        while (lineEnd < end && *lineEnd != '\n') ++lineEnd;
+        while (lineEnd > p && isBlank(lineEnd[-1])) --lineEnd;
+        first = p;
+        last = lineEnd;
+    }
+
+    // Mesmo que acima, copiado para uma string (nomes de arquivo podem conter espaços)
+    inline std::string restOfLine(const char* p, const char* end)
+    {
+        const char* first;
+        const char* last;
+        restOfLine(p, end, first, last);
+        return std::string(first, last);
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "MappedFile.h"
+#include "MipBuilder.h"
+
+using namespace std;
+
+// Compressão de texturas em blocos 4x4 (BC1 / BC3, as S3TC DXT1 e DXT5) feita na CPU, com a
+// cadeia de mipmaps pronta (MipBuilder, média em espaço linear), guardada num arquivo ao lado
+// da imagem (.vbt). Sem compressão, o .vbt guarda os mesmos mipmaps em RGBA8.
+//
+// Layout do .vbt (little-endian):
+//   TextureCacheHeader, com a tabela de níveis (do maior para 1x1)
+//   blocos de cada nível, na ordem da tabela, alinhados em 16 bytes
+//
+// Como no cache de malhas, o arquivo é válido enquanto tamanho e data (ou hash) da imagem
+// de origem conferem; na carga ele é mapeado e os níveis vão direto para glCompressedTexImage2D.
+
+const uint32_t TEXTURE_CACHE_VERSION = 2;
+const uint32_t TEXTURE_MAX_LEVELS = 16;
+
+enum TextureBlockFormat : uint32_t
+{
+    TEXTURE_RGBA8 = 0, // sem compressão, 4 bytes por pixel
+    TEXTURE_BC1 = 1, // RGB 5:6:5, 8 bytes por bloco (alfa ignorado)
+    TEXTURE_BC3 = 3  // BC1 + alfa interpolado de 8 bits, 16 bytes por bloco
+};
+
+struct TextureCacheLevel
+{
+    uint64_t offset; // a partir do início do arquivo
+    uint32_t size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+};
+static_assert(sizeof(TextureCacheLevel) == 24, "TextureCacheLevel deve ter 24 bytes");
+
+struct TextureCacheHeader
+{
+    char magic[4]; // "VBT1"
+    uint32_t version;
+    uint64_t sourceHash; // FNV-1a 64 do arquivo de imagem
+    uint64_t sourceSize;
+    int64_t sourceTime;
+
+    uint32_t format;     // TextureBlockFormat
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    TextureCacheLevel levels[TEXTURE_MAX_LEVELS];
+};
+static_assert(sizeof(TextureCacheHeader) == 48 + 24 * TEXTURE_MAX_LEVELS, "TextureCacheHeader com tamanho inesperado");
+
+// Textura comprimida pronta para envio. data aponta para o arquivo mapeado ou para storage.
+struct CompressedTexture
+{
+    uint32_t format = TEXTURE_BC1;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    vector<TextureCacheLevel> levels; // offsets relativos a data
+    const unsigned char* data = nullptr;
+    size_t dataSize = 0;
+    bool fromCache = false;
+
+    MappedFile file;
+    vector<unsigned char> storage;
+};
+
+// Bytes por bloco 4x4 do formato (BC1/BC3)
+inline size_t textureBlockBytes(uint32_t format) { return format == TEXTURE_BC1 ? 8 : 16; }
+
+// Comprime um bloco de 4x4 pixels RGBA (64 bytes, linha a linha)
+void compressBlockBC1(const uint8_t rgba[64], uint8_t out[8]);
+void compressBlockBC3(const uint8_t rgba[64], uint8_t out[16]);
+
+// Descomprime um bloco para 4x4 pixels RGBA
+void decompressBlockBC1(const uint8_t block[8], uint8_t rgba[64]);
+void decompressBlockBC3(const uint8_t block[16], uint8_t rgba[64]);
+
+// Comprime uma imagem RGBA (as bordas de tamanhos não múltiplos de 4 repetem o último pixel)
+void compressImage(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t format, vector<uint8_t>& out);
+
+// PSNR (dB) da imagem comprimida em relação à original, nos canais RGB (e A no BC3)
+double compressionPsnr(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t format, const uint8_t* blocks);
+
+// Caminho do .vbt correspondente à imagem
+string textureCachePath(const string& imagePath);
+
+// Usa o .vbt quando ele corresponde à imagem (e ao pedido de compressão); senão decodifica com
+// stb_image, monta os mipmaps, comprime (BC1 se todos os pixels são opacos, BC3 se não, ou
+// RGBA8 com compress = false) e grava o .vbt.
+bool loadCompressedTexture(const string& imagePath, CompressedTexture& texture, bool compress = true);
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include "TextureCompressor.h"
+
+using namespace std;
+
+// Carregamento de texturas em segundo plano.
+//
+// request() devolve na hora um nome de textura com um pixel 1x1 provisório; a decodificação
+// (stbi_load) roda num conjunto de threads, e update(), chamado uma vez por quadro na thread
+// do OpenGL, envia as imagens prontas por um anel de PBOs e troca o conteúdo da textura.
+// O nome da textura não muda, então materiais e objetos podem guardá-lo desde o início.
+//
+// As threads usam o .vbt da imagem (mipmaps prontos, gerado na primeira vez): em BC1/BC3 com
+// compressão ligada e S3TC disponível no driver, enviados com glCompressedTexImage2D, ou em RGBA8.
+// update() envia nível por nível, sem glGenerateMipmap; só se o .vbt falhar a imagem decodificada
+// pelo stb_image é enviada e os mipmaps gerados pelo driver.
+//
+// As texturas ficam num registro indexado pelo caminho canônico: pedir de novo a mesma imagem
+// devolve o mesmo nome de textura e só aumenta a contagem de referências. O hash do conteúdo é
+// calculado nas threads, junto com a decodificação; quando update() recebe uma imagem com o mesmo
+// conteúdo de uma textura já registrada (cópia do arquivo com outro nome), o caminho novo passa a
+// apontar para a textura existente e os pedidos seguintes a dividem. release() devolve a
+// referência e as texturas sem referências são apagadas em update(). O registro só é usado na
+// thread do OpenGL.
+//
+// requestArray() empacota várias imagens de mesmo tamanho como camadas de um GL_TEXTURE_2D_ARRAY,
+// para que objetos com texturas diferentes sejam desenhados sem trocar a textura ligada. As camadas
+// têm o seu próprio registro (caminho e hash), e um arquivo pedido pelas duas funções enquanto
+// ainda está na fila é decodificado uma vez só e enviado aos dois destinos.
+
+struct TextureLoadStats
+{
+    size_t requested = 0;
+    size_t shared = 0;      // pedidos atendidos por uma textura já registrada
+    size_t evicted = 0;
+    size_t decoded = 0;
+    size_t failed = 0;
+    size_t compressed = 0;  // texturas enviadas em BC1/BC3
+    size_t uploadedBytes = 0;
+    double decodeMs = 0.0;  // soma do tempo de decodificação nas threads
+    double uploadMs = 0.0;  // tempo gasto em update() copiando para os PBOs
+    double elapsedMs = 0.0; // do primeiro request() até a última textura enviada
+};
+
+// Camada de uma imagem num GL_TEXTURE_2D_ARRAY criado por requestArray()
+struct TextureLayer
+{
+    GLuint array = 0;
+    int layer = -1; // -1 = imagem que não pôde ser lida
+};
+
+class TextureManager
+{
+public:
+    TextureManager() {}
+    ~TextureManager();
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    // Cria o pixel provisório e o anel de PBOs (precisa do contexto OpenGL) e inicia as threads.
+    // numThreads = 0 usa std::thread::hardware_concurrency(). compress só vale se o driver tem S3TC.
+    void initialize(int numThreads = 0, int pboCount = 3, bool compress = true);
+
+    // Para as threads e apaga os PBOs e todas as texturas registradas
+    void shutdown();
+
+    // Textura com o pixel provisório até a imagem do arquivo ficar pronta; cada chamada
+    // acrescenta uma referência, inclusive quando a textura já estava registrada
+    GLuint request(const string& path);
+
+    // Agrupa as imagens por tamanho e cria um GL_TEXTURE_2D_ARRAY por grupo (BC3 com compressão,
+    // RGBA8 sem), com as camadas brancas até update() enviar cada imagem. Caminhos repetidos, ou já
+    // empacotados numa chamada anterior, dividem a camada. Cada array devolvido (criado ou reaproveitado)
+    // recebe uma referência, devolvida com release(array).
+    vector<TextureLayer> requestArray(const vector<string>& paths);
+
+    // Devolve uma referência obtida com request() ou requestArray()
+    void release(GLuint texture);
+
+    // Apaga as texturas sem referências que já terminaram de carregar (update() já chama)
+    void evictUnused();
+
+    // Texturas distintas registradas
+    size_t textureCount() const { return entries.size(); }
+
+    // Envia até maxBytes de imagens decodificadas (pelo menos uma por chamada); chamar a cada quadro
+    void update(size_t maxBytes = 16u << 20);
+
+    // Verdadeiro quando não há imagens na fila nem decodificadas esperando envio
+    bool idle() const;
+
+    const TextureLoadStats& getStats() const { return stats; }
+
+private:
+    struct Job
+    {
+        string path; // caminho canônico; os destinos ficam em waiting
+    };
+
+    // Destino de uma imagem decodificada
+    struct Target
+    {
+        GLuint texture;
+        int layer; // camada do array em texture, ou -1 para GL_TEXTURE_2D
+    };
+
+    struct Decoded
+    {
+        string path;
+        uint64_t hash;         // hashFile do arquivo (0 se não foi possível ler)
+        unsigned char* pixels; // liberado com stbi_image_free
+        int width;
+        int height;
+        int channels;
+        unique_ptr<CompressedTexture> cached; // em vez de pixels, quando há .vbt
+
+        size_t byteSize() const;
+    };
+
+    struct Entry
+    {
+        string path;   // caminho canônico
+        uint64_t hash; // FNV-1a do arquivo (0 se não foi possível ler)
+        int refs;
+        bool loaded;   // enviada ou com falha; só então pode ser apagada
+    };
+
+    struct ArrayInfo
+    {
+        uint32_t format; // TEXTURE_BC3 ou TEXTURE_RGBA8
+        int width;
+        int height;
+        int levels;
+        int layers;
+    };
+
+    void load(const string& canonical, Target target);
+    void enqueue(Job job);
+    void workerLoop();
+    void registerHash(const Decoded& image, const Target& target);
+    void upload(const Decoded& image, GLuint texture);
+    void uploadLevels(const Decoded& image, GLuint texture);
+    bool uploadLayer(const Decoded& image, const Target& target);
+    bool idleLocked() const; // idle() com mutex já travado
+
+    vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    deque<Job> jobs;
+    deque<Decoded> ready;
+    size_t inFlight = 0; // jobs retirados da fila e ainda em decodificação
+    bool stopping = false;
+    bool compress = false;
+
+    vector<GLuint> pbos;
+    size_t nextPbo = 0;
+
+    unordered_map<GLuint, Entry> entries;
+    unordered_map<string, GLuint> byPath;   // caminhos canônicos (de qualquer nome que já apontou para a textura)
+    unordered_map<uint64_t, GLuint> byHash;
+    unordered_map<GLuint, ArrayInfo> arrays;
+    unordered_map<string, TextureLayer> layerByPath; // como byPath e byHash, para as camadas de arrays
+    unordered_map<uint64_t, TextureLayer> layerByHash;
+    unordered_map<string, vector<Target>> waiting;  // caminho canônico na fila ou em decodificação -> destinos
+
+    TextureLoadStats stats;
+    std::chrono::steady_clock::time_point firstRequest;
+    bool reported = false;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Material.h"
+
+using namespace std;
+
+// Uniform buffer objects compartilhados por todos os programas.
+//
+// Cada bloco tem um binding fixo (UniformBlockBinding) e um buffer ligado a ele uma vez só; os
+// programas só precisam de bindUniformBlocks() depois do link (GLSL 330 não tem layout(binding)).
+// Trocar de programa não exige reenviar câmera, luzes ou materiais.
+//
+// Os structs abaixo espelham os blocos layout(std140) dos shaders: vec3 vira glm::vec4 (no std140
+// um vec3 ocupa 16 bytes), bool vira int32_t e o tamanho é múltiplo de 16. Os static_assert
+// garantem os offsets do std140; ao mudar um bloco, mudar o shader e o struct juntos.
+
+enum UniformBlockBinding
+{
+    UBO_BINDING_CAMERA = 0,   // por quadro
+    UBO_BINDING_LIGHTS = 1,   // por cena
+    UBO_BINDING_MATERIAL = 2  // por material
+};
+
+// layout(std140) uniform Camera
+struct CameraBlock
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 viewPos; // xyz
+};
+static_assert(offsetof(CameraBlock, view) == 0, "std140: Camera.view");
+static_assert(offsetof(CameraBlock, projection) == 64, "std140: Camera.projection");
+static_assert(offsetof(CameraBlock, viewPos) == 128, "std140: Camera.viewPos");
+static_assert(sizeof(CameraBlock) == 144, "std140: tamanho de Camera");
+
+// struct PointLight do shader (membro de Lights)
+struct PointLightBlock
+{
+    glm::vec4 position; // xyz
+    glm::vec4 ambient;  // rgb
+    glm::vec4 diffuse;  // rgb
+    glm::vec4 specular; // rgb
+    float constant = 1.0f;
+    float linear = 0.0f;
+    float quadratic = 0.0f;
+    float padding = 0.0f;
+};
+static_assert(offsetof(PointLightBlock, position) == 0, "std140: PointLight.position");
+static_assert(offsetof(PointLightBlock, specular) == 48, "std140: PointLight.specular");
+static_assert(offsetof(PointLightBlock, constant) == 64, "std140: PointLight.constant");
+static_assert(offsetof(PointLightBlock, linear) == 68, "std140: PointLight.linear");
+static_assert(offsetof(PointLightBlock, quadratic) == 72, "std140: PointLight.quadratic");
+static_assert(sizeof(PointLightBlock) == 80, "std140: struct deve ter tamanho múltiplo de 16");
+
+// Tamanho do array de luzes do bloco Lights (MAX_POINT_LIGHTS em sprite.fs)
+const int MAX_POINT_LIGHTS = 3;
+
+// layout(std140) uniform Lights. Não há flag de luz ligada: as luzes acesas ficam no começo do
+// array e o shader é compilado com NUM_POINT_LIGHTS = quantas são (ShaderVariants.h)
+struct LightsBlock
+{
+    PointLightBlock lights[MAX_POINT_LIGHTS];
+};
+static_assert(sizeof(LightsBlock) == 80 * MAX_POINT_LIGHTS, "std140: tamanho de Lights");
+
+// layout(std140) uniform Material
+struct MaterialBlock
+{
+    glm::vec4 Ka; // rgb
+    glm::vec4 Kd; // rgb
+    glm::vec4 Ks; // rgb
+    float Ns;
+    float padding[3];
+};
+static_assert(offsetof(MaterialBlock, Kd) == 16, "std140: Material.Kd");
+static_assert(offsetof(MaterialBlock, Ks) == 32, "std140: Material.Ks");
+static_assert(offsetof(MaterialBlock, Ns) == 48, "std140: Material.Ns");
+static_assert(sizeof(MaterialBlock) == 64, "std140: tamanho de Material");
+
+MaterialBlock makeMaterialBlock(const Material& material);
+
+// Liga os blocos Camera, Lights e Material do programa (os que ele usar) aos bindings fixos
+void bindUniformBlocks(GLuint program);
+
+// Buffer de um bloco, ligado ao binding na criação
+class UniformBuffer
+{
+public:
+    UniformBuffer() {}
+    ~UniformBuffer() {}
+
+    void create(UniformBlockBinding binding, size_t size);
+    void destroy();
+
+    void update(const void* data, size_t size);
+
+    template <typename T>
+    void update(const T& block)
+    {
+        update(&block, sizeof(T));
+    }
+
+    GLuint getID() const { return buffer; }
+
+private:
+    GLuint buffer = 0;
+    size_t size = 0;
+};
+
+// Todos os materiais num buffer só, cada um num intervalo alinhado a
+// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT; trocar de material é um glBindBufferRange, sem enviar dados
+class MaterialBuffer
+{
+public:
+    MaterialBuffer() {}
+    ~MaterialBuffer() {}
+
+    void upload(const vector<Material>& materials);
+    void destroy();
+
+    // Liga o intervalo do material index ao binding UBO_BINDING_MATERIAL
+    void bind(size_t index) const;
+
+private:
+    GLuint buffer = 0;
+    size_t stride = 0;
+    size_t count = 0;
+};
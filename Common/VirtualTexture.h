@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#include "MappedFile.h"
+#include "Shader.h"
+#include "VirtualTextureFile.h"
+
+using namespace std;
+
+// Textura virtual para imagens grandes demais para decodificar inteiras a cada execução.
+//
+// O tiler (buildVirtualTexture) corta a imagem e seus mipmaps em páginas de 128x128 com borda
+// de 4 pixels e grava tudo num .vtx ao lado da imagem. Em execução o arquivo é mapeado e só as
+// páginas usadas ficam na GPU, numa textura cache de tamanho fixo (slots x slots páginas). Uma
+// tabela de indireção (uma textura com as grades de páginas de todos os níveis, uma embaixo da
+// outra) diz para cada página onde ela está no cache, ou qual página mais grossa usar no lugar.
+//
+// Quais páginas são necessárias vem de um passe de feedback: a cena é desenhada numa resolução
+// menor com vt_feedback.fs, que escreve (página x, página y, nível, id) por pixel; o resultado é
+// lido com glReadPixels e as páginas que faltam são enviadas aos poucos em update().
+//
+// O formato do arquivo e o tiler estão em VirtualTextureFile.h.
+
+struct VirtualTextureStats
+{
+    size_t pagesRequested = 0; // páginas distintas vistas no último feedback
+    size_t pagesMissing = 0;   // dessas, as que não estavam no cache
+    size_t pagesUploaded = 0;  // total enviado ao cache
+    size_t pagesEvicted = 0;
+    size_t residentPages = 0;
+};
+
+class VirtualTexture
+{
+public:
+    VirtualTexture() {}
+    ~VirtualTexture();
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    // Usa o .vtx da imagem (gerado se não existir ou estiver desatualizado) e cria o cache com
+    // cacheSlots x cacheSlots páginas. id (1..255) separa texturas virtuais no mesmo feedback.
+    bool open(const string& imagePath, int cacheSlots = 16, int id = 1);
+    void close();
+
+    // Liga cache e indireção nas unidades dadas e preenche os uniforms vt_* do shader (uma
+    // variante de sprite com ShaderFeatures::textureSource = TEXTURE_SOURCE_VIRTUAL, ou o programa de vt_feedback.fs)
+    void bind(const Shader& shader, int cacheUnit, int indirectionUnit) const;
+
+    // Passe de feedback num framebuffer próprio de width x height (tipicamente 1/4 ou 1/8 da
+    // janela). Entre begin e end, desenhar a cena com vt_feedback.fs, chamando bind() nesse shader
+    // depois de beginFeedback(). O resultado é lido sem bloquear e vale para o quadro seguinte.
+    // O programa de feedback usa sprite.vs, então também precisa de bindUniformBlocks().
+    void beginFeedback(int width, int height);
+    void endFeedback();
+
+    // Envia até maxPages páginas pedidas no último feedback (as mais grossas primeiro) e atualiza
+    // a indireção. Devolve quantas foram enviadas.
+    int update(int maxPages = 16);
+
+    const VirtualTextureHeader& getHeader() const { return header; }
+    const VirtualTextureStats& getStats() const { return stats; }
+
+private:
+    static constexpr uint32_t NO_PAGE = 0xFFFFFFFFu;
+
+    struct Slot
+    {
+        uint32_t page = NO_PAGE;
+        uint32_t lastUsed = 0; // quadro do último feedback que pediu a página
+    };
+
+    void processFeedback(const uint8_t* pixels, size_t count);
+    void requestPage(uint32_t level, uint32_t x, uint32_t y);
+    void uploadPage(uint32_t page, uint32_t slot);
+    void rebuildIndirection();
+    uint32_t pageIndex(uint32_t level, uint32_t x, uint32_t y) const;
+
+    MappedFile file;
+    VirtualTextureHeader header = {};
+    int id = 1;
+    int cacheSlots = 0;
+
+    GLuint cacheTexture = 0;
+    GLuint indirectionTexture = 0;
+    vector<uint32_t> levelRow; // linha da indireção onde começa cada nível
+    uint32_t indirectionHeight = 0;
+    vector<uint8_t> indirection; // RGBA por página: slot x, slot y, nível da página usada, 255
+
+    vector<Slot> slots;
+    vector<uint32_t> pageSlot;     // slot de cada página, ou NO_PAGE
+    vector<uint32_t> requestStamp; // quadro em que a página foi pedida pela última vez
+    vector<uint32_t> pending;      // pedidas e fora do cache
+    uint32_t frame = 0;
+
+    GLuint feedbackFbo = 0;
+    GLuint feedbackColor = 0;
+    GLuint feedbackDepth = 0;
+    int feedbackWidth = 0;
+    int feedbackHeight = 0;
+    vector<GLuint> feedbackPbos; // leitura do feedback com um quadro de atraso
+    size_t feedbackReads = 0;
+    float feedbackBias = 0.0f;   // log2(janela / feedback), subtraído do nível no shader
+    GLint savedFbo = 0;
+    GLint savedViewport[4] = { 0, 0, 0, 0 };
+    GLfloat savedClearColor[4] = { 0, 0, 0, 0 };
+
+    VirtualTextureStats stats;
+};
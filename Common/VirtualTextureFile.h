@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Arquivo .vtx da textura virtual (VirtualTexture.h) e o tiler que o gera. Não usa OpenGL.
+//
+// Layout do .vtx (little-endian): VirtualTextureHeader e as páginas, RGBA8, nível a nível e linha
+// a linha, cada uma com (VT_PAGE_SIZE + 2 * VT_PAGE_BORDER)^2 pixels.
+
+const uint32_t VT_FILE_VERSION = 1;
+const uint32_t VT_PAGE_SIZE = 128;
+const uint32_t VT_PAGE_BORDER = 4; // para o filtro bilinear não ler a página vizinha no cache
+const uint32_t VT_STORED_PAGE_SIZE = VT_PAGE_SIZE + 2 * VT_PAGE_BORDER;
+const uint32_t VT_MAX_LEVELS = 16;
+
+struct VirtualTextureLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t pagesX;
+    uint32_t pagesY;
+    uint32_t firstPage; // índice global da primeira página do nível
+    uint32_t reserved;
+};
+static_assert(sizeof(VirtualTextureLevel) == 24, "VirtualTextureLevel deve ter 24 bytes");
+
+struct VirtualTextureHeader
+{
+    char magic[4]; // "VTX1"
+    uint32_t version;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+
+    uint32_t pageSize;
+    uint32_t border;
+    uint32_t levelCount; // até o nível que cabe numa página só
+    uint32_t pageCount;
+    VirtualTextureLevel levels[VT_MAX_LEVELS];
+};
+static_assert(sizeof(VirtualTextureHeader) == 48 + 24 * VT_MAX_LEVELS, "VirtualTextureHeader com tamanho inesperado");
+
+// Caminho do .vtx correspondente à imagem
+string virtualTexturePath(const string& imagePath);
+
+// Bytes de uma página no arquivo e posição da página (índice global) a partir do início do arquivo
+const size_t VT_PAGE_BYTES = (size_t)VT_STORED_PAGE_SIZE * VT_STORED_PAGE_SIZE * 4;
+inline size_t virtualTexturePageOffset(uint32_t page) { return sizeof(VirtualTextureHeader) + (size_t)page * VT_PAGE_BYTES; }
+
+// Cabeçalho desta versão, com níveis coerentes e todas as páginas dentro de fileSize
+bool validVirtualTextureHeader(const VirtualTextureHeader& header, size_t fileSize);
+
+// Tiler: decodifica a imagem, monta os mipmaps (MipBuilder) e grava as páginas em outPath.
+// O nível 0 é cortado direto do buffer do stb_image, liberado assim que o nível 1 fica pronto;
+// daí em diante só o nível atual e o seguinte ficam na memória.
+bool buildVirtualTexture(const string& imagePath, const string& outPath);
@@ -18,6 +18,8 @@ Camera::Camera() :
 void Camera::initialize(Shader* shader, int width, int height)
 {
     this->shader = shader;
+    if (shader) bindUniformBlocks(shader->ID);
+    cameraBuffer.create(UBO_BINDING_CAMERA, sizeof(CameraBlock));
     this->windowWidth = width;
     this->windowHeight = height;
     lastX = width / 2.0f;
@@ -26,13 +28,11 @@ void Camera::initialize(Shader* shader, int width, int height)
 
 void Camera::update()
 {
-    glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-    shader->setMat4("view", view);
-
-    shader->setVec3("viewPos", cameraPos);
-
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
-    shader->setMat4("projection", projection);
+    CameraBlock block;
+    block.view = getViewMatrix();
+    block.projection = getProjectionMatrix();
+    block.viewPos = glm::vec4(cameraPos, 1.0f);
+    cameraBuffer.update(block);
 }
 
 void Camera::setCameraPos(int key)
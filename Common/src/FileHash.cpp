@@ -0,0 +1,42 @@
+#include "FileHash.h"
+#include "MappedFile.h"
+
+#include <filesystem>
+#include <fstream>
+
+bool sourceInfo(const string& path, uint64_t& size, int64_t& time)
+{
+    std::error_code ec;
+    size = (uint64_t)std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    time = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+bool refreshSourceTime(const string& cachePath, size_t offset, int64_t time)
+{
+    std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) return false;
+    file.seekp((std::streamoff)offset);
+    file.write((const char*)&time, sizeof(time));
+    return file.good();
+}
+
+uint64_t hashFile(const string& path)
+{
+    MappedFile file;
+    if (!file.open(path)) return 0;
+    return hashBytes(file.begin(), file.getSize());
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
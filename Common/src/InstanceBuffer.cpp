@@ -0,0 +1,83 @@
+#include "InstanceBuffer.h"
+
+#include <algorithm>
+
+void InstanceBuffer::create(GLuint vao)
+{
+    destroy();
+    glGenBuffers(1, &buffer);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    pointAttributes(0);
+    for (GLuint location = INSTANCE_ATTRIB_MODEL; location <= INSTANCE_ATTRIB_DATA; ++location)
+    {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::pointAttributes(GLsizei first) const
+{
+    const GLsizei stride = sizeof(InstanceData);
+    const size_t base = (size_t)first * sizeof(InstanceData);
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        glVertexAttribPointer(INSTANCE_ATTRIB_MODEL + column, 4, GL_FLOAT, GL_FALSE, stride,
+                              (GLvoid*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+    }
+    glVertexAttribPointer(INSTANCE_ATTRIB_DATA, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(InstanceData, data)));
+}
+
+void InstanceBuffer::destroy()
+{
+    if (buffer) glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    capacity = 0;
+    uploadedCount = 0;
+}
+
+void InstanceBuffer::upload()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    // Cresce em potências de dois para não realocar a cada instância a mais
+    if (instances.size() > capacity) capacity = std::max<size_t>(64, capacity);
+    while (capacity < instances.size()) capacity *= 2;
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    if (!instances.empty()) glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploadedCount = (GLsizei)instances.size();
+}
+
+void InstanceBuffer::drawArrays(GLenum mode, GLint first, GLsizei vertexCount) const
+{
+    drawArrays(mode, first, vertexCount, uploadedCount);
+}
+
+void InstanceBuffer::drawArrays(GLenum mode, GLint first, GLsizei vertexCount, GLsizei count) const
+{
+    if (count > 0) glDrawArraysInstanced(mode, first, vertexCount, std::min(count, uploadedCount));
+}
+
+void InstanceBuffer::drawElements(GLenum mode, GLsizei indexCount, GLenum type, size_t byteOffset) const
+{
+    if (uploadedCount > 0) glDrawElementsInstanced(mode, indexCount, type, (const void*)byteOffset, uploadedCount);
+}
+
+void InstanceBuffer::drawElements(GLenum mode, GLsizei indexCount, GLenum type, size_t byteOffset, GLsizei first, GLsizei count) const
+{
+    count = std::min(count, uploadedCount - first);
+    if (first < 0 || count <= 0) return;
+    if (first == 0)
+    {
+        glDrawElementsInstanced(mode, indexCount, type, (const void*)byteOffset, count);
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    pointAttributes(first);
+    glDrawElementsInstanced(mode, indexCount, type, (const void*)byteOffset, count);
+    pointAttributes(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,127 @@
+#include "Material.h"
+#include "MappedFile.h"
+#include "TextParse.h"
+
+#include <iostream>
+#include <unordered_map>
+
+using namespace TextParse;
+
+namespace
+{
+    inline const char* parseVec3(const char* p, const char* end, glm::vec3& value)
+    {
+        p = parseFloat(p, end, value.x);
+        p = parseFloat(p, end, value.y);
+        return parseFloat(p, end, value.z);
+    }
+
+    // Verdadeiro se o token em p é todo um número (e não a próxima opção ou o arquivo)
+    inline bool isNumberToken(const char* p, const char* end)
+    {
+        if (p < end && *p == '+') ++p;
+        float value;
+        auto result = std::from_chars(p, end, value);
+        return result.ec == std::errc() && (result.ptr == end || isBlank(*result.ptr) || *result.ptr == '\n');
+    }
+
+    // Argumento de mapa de textura: "[-opção valores...] arquivo"; o arquivo é resolvido em
+    // relação a directory (caminhos absolutos ficam como estão)
+    string parseMap(const char* p, const char* end, const string& directory, float* bumpMultiplier = nullptr)
+    {
+        p = skipBlanks(p, end);
+        while (p < end && *p == '-')
+        {
+            const char* option = p;
+            p = skipToken(p, end);
+            const size_t length = p - option;
+
+            // -o, -s e -t aceitam de 1 a 3 números; as demais opções têm quantidade fixa
+            int values = 1;
+            if ((length == 2 && (option[1] == 'o' || option[1] == 's' || option[1] == 't'))) values = 3;
+            else if (length == 3 && memcmp(option, "-mm", 3) == 0) values = 2;
+
+            for (int i = 0; i < values; ++i)
+            {
+                p = skipBlanks(p, end);
+                if (p >= end || *p == '\n') break;
+                if (i > 0 && !isNumberToken(p, end)) break;
+                if (bumpMultiplier && length == 3 && memcmp(option, "-bm", 3) == 0) parseFloat(p, end, *bumpMultiplier);
+                p = skipToken(p, end);
+            }
+            p = skipBlanks(p, end);
+        }
+
+        const char* first;
+        const char* last;
+        restOfLine(p, end, first, last);
+        if (first == last) return string();
+        const bool absolute = *first == '/' || *first == '\\' || (last - first > 1 && first[1] == ':');
+        return absolute ? string(first, last) : directory + string(first, last);
+    }
+}
+
+bool loadMtl(const string& path, vector<Material>& materials)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cerr << "Erro ao abrir arquivo MTL: " << path << std::endl;
+        return false;
+    }
+
+    const string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    const char* p = file.begin();
+    const char* end = file.end();
+    Material* current = nullptr;
+    while (p < end)
+    {
+        p = skipBlanks(p, end);
+        if (p >= end) break;
+
+        if (matchKeyword(p, end, "newmtl", 6))
+        {
+            materials.emplace_back();
+            current = &materials.back();
+            current->name = restOfLine(p + 6, end);
+        }
+        else if (current != nullptr)
+        {
+            if (matchKeyword(p, end, "Ka", 2)) parseVec3(p + 2, end, current->Ka);
+            else if (matchKeyword(p, end, "Kd", 2)) parseVec3(p + 2, end, current->Kd);
+            else if (matchKeyword(p, end, "Ks", 2)) parseVec3(p + 2, end, current->Ks);
+            else if (matchKeyword(p, end, "Ns", 2)) parseFloat(p + 2, end, current->Ns);
+            else if (matchKeyword(p, end, "d", 1)) parseFloat(p + 1, end, current->d);
+            else if (matchKeyword(p, end, "Tr", 2))
+            {
+                float transparency = 0.0f;
+                parseFloat(p + 2, end, transparency);
+                current->d = 1.0f - transparency;
+            }
+            else if (matchKeyword(p, end, "illum", 5)) parseInt(skipBlanks(p + 5, end), end, current->illum);
+            else if (matchKeyword(p, end, "map_Kd", 6)) current->map_Kd = parseMap(p + 6, end, directory);
+            else if (matchKeyword(p, end, "map_Ks", 6)) current->map_Ks = parseMap(p + 6, end, directory);
+            else if (matchKeyword(p, end, "map_d", 5)) current->map_d = parseMap(p + 5, end, directory);
+            else if (matchKeyword(p, end, "map_Bump", 8)) current->map_Bump = parseMap(p + 8, end, directory, &current->bumpMultiplier);
+            else if (matchKeyword(p, end, "map_bump", 8)) current->map_Bump = parseMap(p + 8, end, directory, &current->bumpMultiplier);
+            else if (matchKeyword(p, end, "bump", 4)) current->map_Bump = parseMap(p + 4, end, directory, &current->bumpMultiplier);
+        }
+        p = nextLine(p, end);
+    }
+    return true;
+}
+
+vector<int> resolveMaterials(const vector<Material>& materials, size_t firstMaterial, const vector<string>& materialNames, int defaultId)
+{
+    // Com nomes repetidos no .mtl vale o primeiro bloco
+    std::unordered_map<string, int> ids;
+    for (size_t i = firstMaterial; i < materials.size(); ++i) ids.emplace(materials[i].name, (int)i);
+
+    vector<int> result(materialNames.size(), defaultId);
+    for (size_t i = 0; i < materialNames.size(); ++i)
+    {
+        auto it = ids.find(materialNames[i]);
+        if (it != ids.end()) result[i] = it->second;
+    }
+    return result;
+}
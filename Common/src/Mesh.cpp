@@ -44,4 +44,28 @@ void Mesh::draw(GLuint textureID)
     glBindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, nVertices);
     glBindVertexArray(0);
-}
\ No newline at end of file
+}
+
+void Mesh::setupVertexAttributes(const CachedMesh& mesh)
+{
+    const GLsizei stride = mesh.vertexStride;
+    if (mesh.vertexFormat == MESH_VERTEX_QUANTIZED)
+    {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(MeshVertexQuantized, position));
+        glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertexQuantized, texcoord));
+        glVertexAttribPointer(3, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(MeshVertexQuantized, normal));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glDisableVertexAttribArray(2);
+        glEnableVertexAttribArray(3);
+        return;
+    }
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, position));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, texcoord));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glDisableVertexAttribArray(3);
+}
@@ -0,0 +1,585 @@
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    const char MESH_CACHE_MAGIC[4] = { 'V', 'B', 'M', '1' };
+
+    inline uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // float -> half float (IEEE 754 binary16), arredondando para o par mais próximo
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        const uint32_t sign = (bits >> 16) & 0x8000u;
+        const uint32_t floatExponent = (bits >> 23) & 0xFFu;
+        uint32_t mantissa = bits & 0x7FFFFFu;
+
+        if (floatExponent == 0xFF) return (uint16_t)(sign | 0x7C00u | (mantissa ? 0x200u : 0u)); // inf / NaN
+        const int exponent = (int)floatExponent - 127 + 15;
+        if (exponent >= 31) return (uint16_t)(sign | 0x7C00u); // fora do intervalo: infinito
+        if (exponent <= 0)
+        {
+            // Subnormal em half
+            if (exponent < -10) return (uint16_t)sign;
+            mantissa |= 0x800000u;
+            const uint32_t shift = (uint32_t)(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            const uint32_t rest = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1))) ++half;
+            return (uint16_t)(sign | half);
+        }
+        uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+        const uint32_t rest = mantissa & 0x1FFFu;
+        if (rest > 0x1000u || (rest == 0x1000u && (half & 1))) ++half; // o vai-um pode passar para o expoente
+        return (uint16_t)half;
+    }
+
+    inline int16_t toSnorm16(float value)
+    {
+        return (int16_t)std::lround(std::max(-1.0f, std::min(1.0f, value)) * 32767.0f);
+    }
+
+    inline uint16_t toUnorm16(float value)
+    {
+        return (uint16_t)std::lround(std::max(0.0f, std::min(1.0f, value)) * 65535.0f);
+    }
+
+    // Normal -> octaedro desdobrado no quadrado [-1, 1]^2
+    void encodeOctahedral(const float normal[3], int16_t out[2])
+    {
+        const float sum = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+        if (sum == 0.0f)
+        {
+            out[0] = out[1] = 0; // normal ausente
+            return;
+        }
+        float x = normal[0] / sum;
+        float y = normal[1] / sum;
+        if (normal[2] < 0.0f)
+        {
+            const float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+        out[0] = toSnorm16(x);
+        out[1] = toSnorm16(y);
+    }
+
+    void quantizeVertex(const MeshVertex& vertex, const MeshCacheHeader& header, MeshVertexQuantized& out)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float extent = header.positionScale[axis];
+            const float t = extent > 0.0f ? (vertex.position[axis] - header.positionOffset[axis]) / extent : 0.0f;
+            out.position[axis] = toUnorm16(t);
+        }
+        out.position[3] = 0;
+        out.texcoord[0] = floatToHalf(vertex.texcoord[0]);
+        out.texcoord[1] = floatToHalf(vertex.texcoord[1]);
+        encodeOctahedral(vertex.normal, out.normal);
+    }
+
+    // Conversão em streaming não gera meshlets
+    uint32_t meshCacheFlags(const MeshCacheOptions& options, bool streamed = false)
+    {
+        uint32_t flags = options.meshlets && !streamed ? MESH_FLAG_MESHLETS : 0u;
+        if (!options.optimize.enabled) return flags;
+        return flags | MESH_FLAG_VERTEX_CACHE | (options.optimize.overdrawThreshold > 0.0f ? MESH_FLAG_OVERDRAW : 0u);
+    }
+
+    // Identifica os parâmetros dos LODs: outro conjunto de razões ou de erro regenera o cache
+    uint32_t meshLodKey(const MeshLodOptions& options)
+    {
+        if (options.ratios.empty()) return 0;
+        uint64_t hash = hashBytes(options.ratios.data(), options.ratios.size() * sizeof(float));
+        hash = hashBytes(&options.maxError, sizeof(options.maxError), hash);
+        return (uint32_t)(hash ^ (hash >> 32)) | 1u;
+    }
+
+    // Confere o cabeçalho e preenche os ponteiros de mesh a partir da imagem do arquivo
+    bool bindImage(const char* data, size_t size, CachedMesh& mesh)
+    {
+        if (size < sizeof(MeshCacheHeader)) return false;
+
+        MeshCacheHeader header;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, MESH_CACHE_MAGIC, 4) != 0 || header.version != MESH_CACHE_VERSION) return false;
+
+        const uint64_t vertexBytes = (uint64_t)header.vertexCount * header.vertexStride;
+        const uint64_t indexBytes = (uint64_t)header.indexCount * header.indexSize;
+        const uint64_t submeshBytes = (uint64_t)header.submeshCount * sizeof(MeshCacheSubmesh);
+        const uint64_t lodBytes = (uint64_t)header.lodCount * sizeof(MeshCacheLod);
+        const uint64_t meshletBytes = (uint64_t)header.meshletCount * sizeof(Meshlet);
+        if (header.vertexOffset + vertexBytes > size || header.indexOffset + indexBytes > size ||
+            header.submeshOffset + submeshBytes + lodBytes + meshletBytes > size || header.stringsOffset + header.stringsSize > size)
+        {
+            return false;
+        }
+
+        mesh.vertexFormat = header.vertexFormat;
+        mesh.vertexStride = header.vertexStride;
+        mesh.vertexCount = header.vertexCount;
+        mesh.vertices = data + header.vertexOffset;
+        if (header.vertexFormat == MESH_VERTEX_QUANTIZED)
+        {
+            mesh.positionOffset = glm::vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+            mesh.positionScale = glm::vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+        }
+        else
+        {
+            mesh.positionOffset = glm::vec3(0.0f);
+            mesh.positionScale = glm::vec3(1.0f);
+        }
+
+        mesh.indexSize = header.indexSize;
+        mesh.indexCount = header.indexCount;
+        mesh.indices = data + header.indexOffset;
+
+        mesh.submeshes.resize(header.submeshCount);
+        if (submeshBytes > 0) memcpy(mesh.submeshes.data(), data + header.submeshOffset, submeshBytes);
+
+        mesh.lods.resize(header.lodCount);
+        if (lodBytes > 0) memcpy(mesh.lods.data(), data + header.submeshOffset + submeshBytes, lodBytes);
+        if (mesh.lods.empty()) mesh.lods.push_back({ 0, header.submeshCount, 0.0f, 0 });
+
+        mesh.meshlets.resize(header.meshletCount);
+        if (meshletBytes > 0) memcpy(mesh.meshlets.data(), data + header.submeshOffset + submeshBytes + lodBytes, meshletBytes);
+
+        // Strings: mtllib e depois um nome por material
+        mesh.mtlLib.clear();
+        mesh.materialNames.clear();
+        const char* str = data + header.stringsOffset;
+        const char* strEnd = str + header.stringsSize;
+        bool first = true;
+        while (str < strEnd)
+        {
+            size_t length = strnlen(str, strEnd - str);
+            if (first) mesh.mtlLib.assign(str, length);
+            else mesh.materialNames.emplace_back(str, length);
+            first = false;
+            str += length + 1;
+        }
+        return true;
+    }
+
+    // Strings: mtllib e depois um nome por material, cada um terminado em '\0'
+    string packStrings(const string& mtlLib, const vector<string>& materialNames)
+    {
+        string strings = mtlLib;
+        strings.push_back('\0');
+        for (const string& name : materialNames)
+        {
+            strings += name;
+            strings.push_back('\0');
+        }
+        return strings;
+    }
+
+    // Cabeçalho com os deslocamentos de cada bloco já calculados
+    MeshCacheHeader makeHeader(uint64_t sourceHash, uint64_t sourceSize, int64_t sourceTime, MeshVertexFormat vertexFormat,
+                               const glm::vec3& boundsMin, const glm::vec3& boundsMax, uint32_t vertexCount,
+                               uint32_t indexSize, uint32_t indexCount, uint32_t submeshCount, uint32_t lodCount, uint32_t meshletCount, uint32_t stringsSize)
+    {
+        MeshCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+        header.version = MESH_CACHE_VERSION;
+        header.sourceHash = sourceHash;
+        header.sourceSize = sourceSize;
+        header.sourceTime = sourceTime;
+        header.vertexFormat = vertexFormat;
+        header.vertexStride = vertexFormat == MESH_VERTEX_QUANTIZED ? sizeof(MeshVertexQuantized) : sizeof(MeshVertex);
+        header.vertexCount = vertexCount;
+        header.indexSize = indexSize;
+        header.indexCount = indexCount;
+        header.submeshCount = submeshCount;
+        header.lodCount = lodCount;
+        header.meshletCount = meshletCount;
+        header.stringsSize = stringsSize;
+
+        header.vertexOffset = alignUp(sizeof(MeshCacheHeader), 16);
+        header.indexOffset = alignUp(header.vertexOffset + (uint64_t)vertexCount * header.vertexStride, 16);
+        header.submeshOffset = alignUp(header.indexOffset + (uint64_t)indexCount * indexSize, 16);
+        header.stringsOffset = header.submeshOffset + submeshCount * sizeof(MeshCacheSubmesh) + lodCount * sizeof(MeshCacheLod) +
+                               (uint64_t)meshletCount * sizeof(Meshlet);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            header.positionOffset[axis] = boundsMin[axis];
+            header.positionScale[axis] = boundsMax[axis] - boundsMin[axis];
+        }
+        return header;
+    }
+
+    // Monta a imagem completa do .vbm em memória
+    void buildImage(const IndexedMesh& indexed, const string& mtlLib, uint64_t sourceHash, uint64_t sourceSize, int64_t sourceTime,
+                    const vector<Meshlet>& meshlets, const vector<uint32_t>& firstMeshlet, const MeshCacheOptions& options,
+                    vector<char>& image)
+    {
+        const MeshVertexFormat vertexFormat = options.vertexFormat;
+        const uint32_t vertexCount = (uint32_t)indexed.vertexCount();
+        const uint32_t indexCount = (uint32_t)indexed.indexCount();
+        const uint32_t indexSize = vertexCount <= 0xFFFF ? 2 : 4;
+
+        glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            glm::vec3 position(indexed.positions[i * 3], indexed.positions[i * 3 + 1], indexed.positions[i * 3 + 2]);
+            boundsMin = i == 0 ? position : glm::min(boundsMin, position);
+            boundsMax = i == 0 ? position : glm::max(boundsMax, position);
+        }
+
+        const string strings = packStrings(mtlLib, indexed.materialNames);
+        MeshCacheHeader header = makeHeader(sourceHash, sourceSize, sourceTime, vertexFormat, boundsMin, boundsMax,
+                                            vertexCount, indexSize, indexCount, (uint32_t)indexed.submeshes.size(),
+                                            (uint32_t)indexed.lods.size(), (uint32_t)meshlets.size(), (uint32_t)strings.size());
+        header.flags = meshCacheFlags(options);
+        header.lodKey = meshLodKey(options.lod);
+
+        image.assign(header.stringsOffset + header.stringsSize, 0);
+        memcpy(image.data(), &header, sizeof(header));
+
+        char* vertexData = image.data() + header.vertexOffset;
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            MeshVertex vertex;
+            memcpy(vertex.position, &indexed.positions[i * 3], 3 * sizeof(float));
+            memcpy(vertex.texcoord, &indexed.texcoords[i * 2], 2 * sizeof(float));
+            memcpy(vertex.normal, &indexed.normals[i * 3], 3 * sizeof(float));
+
+            if (vertexFormat == MESH_VERTEX_QUANTIZED) quantizeVertex(vertex, header, ((MeshVertexQuantized*)vertexData)[i]);
+            else ((MeshVertex*)vertexData)[i] = vertex;
+        }
+
+        char* indices = image.data() + header.indexOffset;
+        if (indexSize == 2)
+        {
+            uint16_t* shortIndices = (uint16_t*)indices;
+            for (uint32_t i = 0; i < indexCount; ++i) shortIndices[i] = (uint16_t)indexed.indices[i];
+        }
+        else
+        {
+            memcpy(indices, indexed.indices.data(), (size_t)indexCount * sizeof(uint32_t));
+        }
+
+        MeshCacheSubmesh* submeshes = (MeshCacheSubmesh*)(image.data() + header.submeshOffset);
+        for (size_t i = 0; i < indexed.submeshes.size(); ++i)
+        {
+            const IndexedMesh::Submesh& submesh = indexed.submeshes[i];
+            submeshes[i].indexOffset = submesh.indexOffset;
+            submeshes[i].indexCount = submesh.indexCount;
+            submeshes[i].materialId = submesh.materialId < 0 ? MESH_NO_MATERIAL : (uint32_t)submesh.materialId;
+            submeshes[i].firstMeshlet = meshlets.empty() ? 0 : firstMeshlet[i];
+        }
+
+        MeshCacheLod* lods = (MeshCacheLod*)(submeshes + indexed.submeshes.size());
+        for (size_t i = 0; i < indexed.lods.size(); ++i)
+        {
+            lods[i].firstSubmesh = indexed.lods[i].firstSubmesh;
+            lods[i].submeshCount = indexed.lods[i].submeshCount;
+            lods[i].error = indexed.lods[i].error;
+            lods[i].reserved = 0;
+        }
+        memcpy(lods + indexed.lods.size(), meshlets.data(), meshlets.size() * sizeof(Meshlet));
+
+        memcpy(image.data() + header.stringsOffset, strings.data(), strings.size());
+    }
+
+    // Substitui o cache pelo arquivo temporário já completo
+    bool commitFile(const string& tmpPath, const string& path)
+    {
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // Grava num arquivo temporário e renomeia, para nunca deixar um cache pela metade
+    bool writeImage(const string& path, const vector<char>& image)
+    {
+        string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            out.write(image.data(), image.size());
+            if (!out.good()) return false;
+        }
+        return commitFile(tmpPath, path);
+    }
+
+    // Copia um arquivo inteiro para o fim de out, em blocos de 1 MB
+    bool appendFile(const string& path, std::ofstream& out)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        vector<char> buffer(1u << 20);
+        while (in)
+        {
+            in.read(buffer.data(), buffer.size());
+            out.write(buffer.data(), in.gcount());
+        }
+        return out.good();
+    }
+
+    // Lê os vértices float do arquivo temporário em blocos e grava no formato do cabeçalho
+    bool appendVertices(const string& path, const MeshCacheHeader& header, std::ofstream& out)
+    {
+        if (header.vertexFormat == MESH_VERTEX_FLOAT32) return appendFile(path, out);
+
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        vector<MeshVertex> block(1u << 15);
+        vector<MeshVertexQuantized> quantized(block.size());
+        while (in)
+        {
+            in.read((char*)block.data(), block.size() * sizeof(MeshVertex));
+            const size_t count = (size_t)in.gcount() / sizeof(MeshVertex);
+            for (size_t i = 0; i < count; ++i) quantizeVertex(block[i], header, quantized[i]);
+            out.write((const char*)quantized.data(), count * sizeof(MeshVertexQuantized));
+        }
+        return out.good();
+    }
+
+    // Completa com zeros até o deslocamento do próximo bloco
+    void padTo(std::ofstream& out, uint64_t offset)
+    {
+        static const char zeros[16] = {};
+        uint64_t position = (uint64_t)out.tellp();
+        if (offset > position) out.write(zeros, offset - position);
+    }
+}
+
+MeshCacheWriter::~MeshCacheWriter()
+{
+    vertexFile.close();
+    indexFile.close();
+    std::error_code ec;
+    std::filesystem::remove(path + ".vtx.tmp", ec);
+    std::filesystem::remove(path + ".idx.tmp", ec);
+}
+
+bool MeshCacheWriter::open(const string& cachePath)
+{
+    path = cachePath;
+    vertexFile.open(path + ".vtx.tmp", std::ios::binary | std::ios::trunc);
+    indexFile.open(path + ".idx.tmp", std::ios::binary | std::ios::trunc);
+    submeshes.clear();
+    vertexCount = 0;
+    indexCount = 0;
+    return vertexFile.is_open() && indexFile.is_open();
+}
+
+bool MeshCacheWriter::consume(const MeshVertex* vertices, uint32_t blockVertices, const uint32_t* indices, uint32_t blockIndices, int materialId)
+{
+    if ((uint64_t)vertexCount + blockVertices > 0xFFFFFFFFull || (uint64_t)indexCount + blockIndices > 0xFFFFFFFFull)
+    {
+        std::cerr << "Mesh too large for cache: " << path << std::endl;
+        return false;
+    }
+
+    // Índices do bloco passam a ser globais
+    indexScratch.resize(blockIndices);
+    for (uint32_t i = 0; i < blockIndices; ++i) indexScratch[i] = indices[i] + vertexCount;
+
+    for (uint32_t i = 0; i < blockVertices; ++i)
+    {
+        const glm::vec3 position(vertices[i].position[0], vertices[i].position[1], vertices[i].position[2]);
+        boundsMin = (vertexCount == 0 && i == 0) ? position : glm::min(boundsMin, position);
+        boundsMax = (vertexCount == 0 && i == 0) ? position : glm::max(boundsMax, position);
+    }
+    vertexFile.write((const char*)vertices, (size_t)blockVertices * sizeof(MeshVertex));
+    indexFile.write((const char*)indexScratch.data(), (size_t)blockIndices * sizeof(uint32_t));
+
+    // Blocos seguidos com o mesmo material formam uma só submalha
+    const uint32_t material = materialId < 0 ? MESH_NO_MATERIAL : (uint32_t)materialId;
+    if (!submeshes.empty() && submeshes.back().materialId == material)
+    {
+        submeshes.back().indexCount += blockIndices;
+    }
+    else
+    {
+        submeshes.push_back({ indexCount, blockIndices, material, 0 });
+    }
+
+    vertexCount += blockVertices;
+    indexCount += blockIndices;
+    return vertexFile.good() && indexFile.good();
+}
+
+bool MeshCacheWriter::finish(const ObjStreamInfo& info, uint64_t sourceSize, int64_t sourceTime, const MeshCacheOptions& options)
+{
+    vertexFile.close();
+    indexFile.close();
+
+    const string strings = packStrings(info.mtlLib, info.materialNames);
+    MeshCacheHeader header = makeHeader(info.sourceHash, sourceSize, sourceTime, options.vertexFormat, boundsMin, boundsMax,
+                                        vertexCount, 4, indexCount, (uint32_t)submeshes.size(), 0, 0, (uint32_t)strings.size());
+    header.flags = meshCacheFlags(options, true);
+
+    const string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write((const char*)&header, sizeof(header));
+        padTo(out, header.vertexOffset);
+        if (!appendVertices(path + ".vtx.tmp", header, out)) return false;
+        padTo(out, header.indexOffset);
+        if (!appendFile(path + ".idx.tmp", out)) return false;
+        padTo(out, header.submeshOffset);
+        out.write((const char*)submeshes.data(), submeshes.size() * sizeof(MeshCacheSubmesh));
+        out.write(strings.data(), strings.size());
+        if (!out.good()) return false;
+    }
+    return commitFile(tmpPath, path);
+}
+
+string meshCachePath(const string& objPath)
+{
+    return objPath + ".vbm";
+}
+
+bool loadCachedMesh(const string& objPath, CachedMesh& mesh, const MeshCacheOptions& options)
+{
+    auto start = std::chrono::steady_clock::now();
+    const string cachePath = meshCachePath(objPath);
+
+    mesh.file.close();
+    mesh.storage.clear();
+    mesh.fromCache = false;
+    mesh.stats = MeshCacheStats();
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!sourceInfo(objPath, sourceSize, sourceTime))
+    {
+        std::cerr << "Failed to open OBJ file: " << objPath << std::endl;
+        return false;
+    }
+
+    // Cache existente: válido se está no formato e com as otimizações pedidas e se tamanho e data conferem,
+    // ou se o hash do conteúdo confere
+    if (mesh.file.open(cachePath) && bindImage(mesh.file.begin(), mesh.file.getSize(), mesh))
+    {
+        MeshCacheHeader header;
+        memcpy(&header, mesh.file.begin(), sizeof(header));
+        bool valid = header.vertexFormat == options.vertexFormat && header.flags == meshCacheFlags(options, sourceSize > MESH_STREAM_THRESHOLD) &&
+                     (header.lodKey == meshLodKey(options.lod) || sourceSize > MESH_STREAM_THRESHOLD) &&
+                     header.sourceSize == sourceSize &&
+                     (header.sourceTime == sourceTime || header.sourceHash == hashFile(objPath));
+        if (valid && header.sourceTime != sourceTime)
+        {
+            // Aceito pelo hash: grava a data nova e mapeia de novo
+            mesh.file.close();
+            refreshSourceTime(cachePath, offsetof(MeshCacheHeader, sourceTime), sourceTime);
+            valid = mesh.file.open(cachePath) && bindImage(mesh.file.begin(), mesh.file.getSize(), mesh);
+        }
+        if (valid)
+        {
+            mesh.fromCache = true;
+            mesh.stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return true;
+        }
+    }
+    mesh.file.close();
+
+    // Modelo grande: converte em streaming direto para o .vbm e depois mapeia o arquivo
+    if (sourceSize > MESH_STREAM_THRESHOLD)
+    {
+        MeshCacheWriter writer;
+        ObjStreamInfo info;
+        ObjStreamOptions streamOptions = options.stream;
+        streamOptions.optimize = options.optimize;
+        if (!writer.open(cachePath) || !streamObj(objPath, writer, streamOptions, info) ||
+            !writer.finish(info, sourceSize, sourceTime, options))
+        {
+            std::cerr << "Could not write mesh cache: " << cachePath << std::endl;
+            return false;
+        }
+        if (!mesh.file.open(cachePath) || !bindImage(mesh.file.begin(), mesh.file.getSize(), mesh))
+        {
+            std::cerr << "Could not read mesh cache: " << cachePath << std::endl;
+            return false;
+        }
+
+        mesh.stats.streamed = true;
+        mesh.stats.streamChunks = info.chunkCount;
+        mesh.stats.streamMs = info.ms;
+        mesh.stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    ObjModel model;
+    if (!loadObj(objPath, model, 0, &mesh.stats.obj)) return false;
+
+    IndexedMesh indexed;
+    buildIndexedMesh(model, indexed);
+    mesh.stats.optimize = optimizeIndexedMesh(indexed, options.optimize);
+    mesh.stats.lods = generateLods(indexed, options.lod);
+
+    vector<Meshlet> meshlets;
+    vector<uint32_t> firstMeshlet;
+    if (options.meshlets) buildMeshlets(indexed, meshlets, firstMeshlet);
+
+    buildImage(indexed, model.mtlLib, hashFile(objPath), sourceSize, sourceTime, meshlets, firstMeshlet, options, mesh.storage);
+    bindImage(mesh.storage.data(), mesh.storage.size(), mesh);
+
+    if (!writeImage(cachePath, mesh.storage))
+    {
+        std::cerr << "Could not write mesh cache: " << cachePath << std::endl;
+    }
+
+    mesh.stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void printMeshCacheStats(const string& objPath, const CachedMesh& mesh)
+{
+    const MeshCacheStats& stats = mesh.stats;
+    if (stats.streamed)
+    {
+        std::cout << "OBJ file streamed: " << objPath << " (" << mesh.indexCount / 3 << " triangles, "
+                  << stats.streamChunks << " chunk(s), " << stats.streamMs << " ms)" << std::endl;
+    }
+    else if (!mesh.fromCache)
+    {
+        std::cout << "OBJ file loaded: " << objPath << " (" << stats.obj.triangles << " triangles, " << stats.obj.threads << " thread(s), " << stats.obj.ms << " ms)" << std::endl;
+    }
+    if (stats.optimize.cacheSize > 0)
+    {
+        const MeshOptimizeStats& optimize = stats.optimize;
+        std::cout << "Mesh optimized: ACMR " << optimize.before.acmr << " -> " << optimize.after.acmr << ", ATVR " << optimize.before.atvr
+                  << " -> " << optimize.after.atvr << " (cache " << optimize.cacheSize << ", " << optimize.ms << " ms)" << std::endl;
+    }
+    if (!stats.lods.triangles.empty())
+    {
+        std::cout << "Mesh LODs:";
+        for (size_t triangles : stats.lods.triangles) std::cout << " " << triangles;
+        std::cout << " triangles (" << stats.lods.ms << " ms)" << std::endl;
+    }
+    std::cout << (mesh.fromCache ? "Mesh cache hit: " : stats.streamed ? "Mesh cache built (streamed): " : "Mesh cache built: ")
+              << meshCachePath(objPath) << " (" << mesh.vertexCount << " vertices, " << mesh.indexCount << " indices, "
+              << stats.ms << " ms)" << std::endl;
+}
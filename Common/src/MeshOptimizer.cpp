@@ -0,0 +1,458 @@
+#include "MeshOptimizer.h"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+    // Parâmetros do algoritmo de Forsyth
+    const int FORSYTH_CACHE_SIZE = 32;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+    const uint32_t VALENCE_TABLE_SIZE = 64;
+
+    // Tamanho do cache FIFO usado para medir e para agrupar triângulos por overdraw
+    const size_t SIMULATED_CACHE_SIZE = 16;
+
+    struct ScoreTables
+    {
+        float cache[FORSYTH_CACHE_SIZE];
+        float valence[VALENCE_TABLE_SIZE];
+
+        ScoreTables()
+        {
+            for (int i = 0; i < FORSYTH_CACHE_SIZE; ++i)
+            {
+                // Os três vértices do último triângulo recebem o mesmo valor, para não favorecer uma direção
+                cache[i] = i < 3 ? LAST_TRIANGLE_SCORE
+                                 : std::pow(1.0f - float(i - 3) / float(FORSYTH_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+            }
+            valence[0] = 0.0f;
+            for (uint32_t i = 1; i < VALENCE_TABLE_SIZE; ++i)
+            {
+                valence[i] = VALENCE_BOOST_SCALE * std::pow((float)i, -VALENCE_BOOST_POWER);
+            }
+        }
+    };
+
+    float vertexScore(const ScoreTables& tables, int cachePosition, uint32_t remaining)
+    {
+        if (remaining == 0) return -1.0f; // sem triângulos pendentes
+        float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+        score += remaining < VALENCE_TABLE_SIZE ? tables.valence[remaining]
+                                                : VALENCE_BOOST_SCALE * std::pow((float)remaining, -VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    glm::vec3 positionAt(const float* positions, size_t stride, uint32_t vertex)
+    {
+        const float* p = positions + (size_t)vertex * stride;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    // Início de cada grupo de triângulos. Limites fixos onde o cache recomeça do zero (3 faltas);
+    // com softSplits, os grupos também são cortados assim que o ACMR acumulado desde o início
+    // do grupo (já contando o cache frio) fica abaixo de threshold x o ACMR do grupo fixo.
+    vector<size_t> findClusters(const uint32_t* indices, size_t triangleCount, size_t vertexCount, float threshold, bool softSplits)
+    {
+        vector<size_t> hard;
+        {
+            vector<size_t> stamp(vertexCount, 0);
+            size_t time = SIMULATED_CACHE_SIZE + 1;
+            for (size_t t = 0; t < triangleCount; ++t)
+            {
+                int misses = 0;
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t v = indices[t * 3 + k];
+                    if (time - stamp[v] > SIMULATED_CACHE_SIZE)
+                    {
+                        stamp[v] = time++;
+                        ++misses;
+                    }
+                }
+                if (t == 0 || misses == 3) hard.push_back(t);
+            }
+        }
+        if (!softSplits) return hard;
+
+        vector<size_t> clusters;
+        vector<size_t> stamp(vertexCount, 0);
+        size_t time = SIMULATED_CACHE_SIZE + 1;
+        for (size_t c = 0; c < hard.size(); ++c)
+        {
+            const size_t begin = hard[c];
+            const size_t end = c + 1 < hard.size() ? hard[c + 1] : triangleCount;
+
+            // ACMR do grupo inteiro, com o cache frio no início
+            time += SIMULATED_CACHE_SIZE + 1;
+            size_t clusterMisses = 0;
+            for (size_t i = begin * 3; i < end * 3; ++i)
+            {
+                if (time - stamp[indices[i]] > SIMULATED_CACHE_SIZE)
+                {
+                    stamp[indices[i]] = time++;
+                    ++clusterMisses;
+                }
+            }
+            const float limit = threshold * float(clusterMisses) / float(end - begin);
+
+            size_t start = begin;
+            size_t misses = 0;
+            time += SIMULATED_CACHE_SIZE + 1;
+            clusters.push_back(begin);
+            for (size_t t = begin; t < end; ++t)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t v = indices[t * 3 + k];
+                    if (time - stamp[v] > SIMULATED_CACHE_SIZE)
+                    {
+                        stamp[v] = time++;
+                        ++misses;
+                    }
+                }
+                if (t + 1 < end && float(misses) / float(t + 1 - start) <= limit)
+                {
+                    start = t + 1;
+                    misses = 0;
+                    time += SIMULATED_CACHE_SIZE + 1; // o próximo grupo começa com o cache frio
+                    clusters.push_back(start);
+                }
+            }
+        }
+        return clusters;
+    }
+
+    // Ordena os grupos: primeiro os que estão mais "para fora" da malha na direção da própria normal
+    void sortClusters(const uint32_t* indices, size_t triangleCount, const vector<size_t>& clusters,
+                      const float* positions, size_t stride, uint32_t* out)
+    {
+        struct Cluster
+        {
+            size_t begin, end;
+            glm::vec3 centroid;
+            glm::vec3 normal;
+            float area;
+            float key;
+        };
+        vector<Cluster> data(clusters.size());
+
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            Cluster& cluster = data[c];
+            cluster.begin = clusters[c];
+            cluster.end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+            cluster.centroid = glm::vec3(0.0f);
+            cluster.normal = glm::vec3(0.0f);
+            cluster.area = 0.0f;
+            for (size_t t = cluster.begin; t < cluster.end; ++t)
+            {
+                glm::vec3 a = positionAt(positions, stride, indices[t * 3]);
+                glm::vec3 b = positionAt(positions, stride, indices[t * 3 + 1]);
+                glm::vec3 d = positionAt(positions, stride, indices[t * 3 + 2]);
+                glm::vec3 n = glm::cross(b - a, d - a);
+                float area = glm::length(n);
+                cluster.centroid += (a + b + d) * (area / 3.0f);
+                cluster.normal += n;
+                cluster.area += area;
+            }
+            meshCentroid += cluster.centroid;
+            meshArea += cluster.area;
+            if (cluster.area > 0.0f) cluster.centroid /= cluster.area;
+        }
+        if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+        for (Cluster& cluster : data)
+        {
+            float length = glm::length(cluster.normal);
+            cluster.key = length > 0.0f ? glm::dot(cluster.centroid - meshCentroid, cluster.normal / length) : 0.0f;
+        }
+        std::stable_sort(data.begin(), data.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+        for (const Cluster& cluster : data)
+        {
+            const size_t count = (cluster.end - cluster.begin) * 3;
+            std::copy(indices + cluster.begin * 3, indices + cluster.begin * 3 + count, out);
+            out += count;
+        }
+    }
+}
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+{
+    VertexCacheStats stats;
+    if (indexCount < 3 || vertexCount == 0) return stats;
+
+    // Um vértice está no cache se entrou há menos de cacheSize faltas
+    vector<size_t> stamp(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t v = indices[i];
+        if (time - stamp[v] > cacheSize)
+        {
+            stamp[v] = time++;
+            ++stats.transformed;
+        }
+    }
+    stats.acmr = float(stats.transformed) / float(indexCount / 3);
+    stats.atvr = float(stats.transformed) / float(vertexCount);
+    return stats;
+}
+
+size_t compactIndices(const uint32_t* indices, size_t indexCount, vector<uint32_t>& local, vector<uint32_t>& vertices)
+{
+    vertices.assign(indices, indices + indexCount);
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    local.resize(indexCount);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        local[i] = (uint32_t)(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+    }
+    return vertices.size();
+}
+
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    static const ScoreTables tables;
+
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) return;
+
+    // Poucos vértices usados de um buffer grande (submalha, LOD): trabalha com numeração local
+    if (vertexCount > indexCount)
+    {
+        vector<uint32_t> local, vertices;
+        compactIndices(indices, triangleCount * 3, local, vertices);
+        optimizeVertexCache(local.data(), local.size(), vertices.size());
+        for (size_t i = 0; i < local.size(); ++i) indices[i] = vertices[local[i]];
+        return;
+    }
+
+    // Adjacência vértice -> triângulos; os triângulos ainda não emitidos ficam no começo de cada lista
+    vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) ++remaining[indices[i]];
+
+    vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + remaining[v];
+
+    vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    vector<int> cachePosition(vertexCount, -1);
+    vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScores[v] = vertexScore(tables, -1, remaining[v]);
+
+    vector<float> triangleScores(triangleCount);
+    vector<char> emitted(triangleCount, 0);
+    size_t best = 0;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t* tri = indices + t * 3;
+        triangleScores[t] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+        if (triangleScores[t] > triangleScores[best]) best = t;
+    }
+
+    vector<uint32_t> output(triangleCount * 3);
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+    int cacheCount = 0;
+    size_t inputCursor = 0; // recomeço quando nenhum triângulo do cache tem pendências
+
+    for (size_t out = 0; out < triangleCount; ++out)
+    {
+        if (best == SIZE_MAX)
+        {
+            while (emitted[inputCursor]) ++inputCursor;
+            best = inputCursor;
+        }
+
+        const uint32_t* tri = indices + best * 3;
+        std::copy(tri, tri + 3, output.data() + out * 3);
+        emitted[best] = 1;
+
+        // Tira o triângulo das listas dos seus vértices
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = tri[k];
+            uint32_t* list = adjacency.data() + offsets[v];
+            const uint32_t count = remaining[v];
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                if (list[j] == best)
+                {
+                    std::swap(list[j], list[count - 1]);
+                    break;
+                }
+            }
+            --remaining[v];
+        }
+
+        // Os vértices do triângulo vão para a frente do cache, o resto é empurrado
+        int newCount = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            if (std::find(newCache, newCache + newCount, tri[k]) == newCache + newCount) newCache[newCount++] = tri[k];
+        }
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2]) newCache[newCount++] = cache[i];
+        }
+
+        for (int i = 0; i < newCount; ++i)
+        {
+            const uint32_t v = newCache[i];
+            cachePosition[v] = i < FORSYTH_CACHE_SIZE ? i : -1;
+            vertexScores[v] = vertexScore(tables, cachePosition[v], remaining[v]);
+        }
+
+        // Só os triângulos que tocam o cache mudam de valor; o melhor deles é o próximo
+        best = SIZE_MAX;
+        float bestScore = -1.0f;
+        for (int i = 0; i < newCount; ++i)
+        {
+            const uint32_t v = newCache[i];
+            const uint32_t* list = adjacency.data() + offsets[v];
+            for (uint32_t j = 0; j < remaining[v]; ++j)
+            {
+                const uint32_t t = list[j];
+                const uint32_t* other = indices + (size_t)t * 3;
+                const float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+                triangleScores[t] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+
+        cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+        std::copy(newCache, newCache + cacheCount, cache);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (threshold <= 0.0f || triangleCount < 2) return;
+
+    const VertexCacheStats before = analyzeVertexCache(indices, triangleCount * 3, vertexCount, SIMULATED_CACHE_SIZE);
+    vector<uint32_t> sorted(triangleCount * 3);
+
+    // Primeiro com os cortes extras; se o cache piorar além do limite, só com os cortes fixos
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        vector<size_t> clusters = findClusters(indices, triangleCount, vertexCount, threshold, attempt == 0);
+        if (clusters.size() < 2) return;
+
+        sortClusters(indices, triangleCount, clusters, positions, positionStride, sorted.data());
+        const VertexCacheStats after = analyzeVertexCache(sorted.data(), sorted.size(), vertexCount, SIMULATED_CACHE_SIZE);
+        if (after.acmr <= before.acmr * threshold)
+        {
+            std::copy(sorted.begin(), sorted.end(), indices);
+            return;
+        }
+    }
+}
+
+size_t optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, vector<uint32_t>& remap)
+{
+    remap.assign(vertexCount, NO_VERTEX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t& slot = remap[indices[i]];
+        if (slot == NO_VERTEX) slot = next++;
+        indices[i] = slot;
+    }
+    return next;
+}
+
+void reorderVertices(IndexedMesh& mesh)
+{
+    const size_t vertexCount = mesh.vertexCount();
+    vector<uint32_t> remap;
+    const size_t used = optimizeVertexFetch(mesh.indices.data(), mesh.indices.size(), vertexCount, remap);
+    vector<float> positions(used * 3), texcoords(used * 2), normals(used * 3);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const uint32_t target = remap[v];
+        if (target == NO_VERTEX) continue;
+        std::copy_n(&mesh.positions[v * 3], 3, &positions[(size_t)target * 3]);
+        std::copy_n(&mesh.texcoords[v * 2], 2, &texcoords[(size_t)target * 2]);
+        std::copy_n(&mesh.normals[v * 3], 3, &normals[(size_t)target * 3]);
+    }
+    mesh.positions.swap(positions);
+    mesh.texcoords.swap(texcoords);
+    mesh.normals.swap(normals);
+}
+
+MeshOptimizeStats optimizeIndexedMesh(IndexedMesh& mesh, const MeshOptimizeOptions& options)
+{
+    MeshOptimizeStats stats;
+    if (!options.enabled || mesh.indices.empty()) return stats;
+    auto start = std::chrono::steady_clock::now();
+
+    const size_t vertexCount = mesh.vertexCount();
+    const VertexCacheStats before = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+
+    // Cada submalha é otimizada com numeração local, para que o custo dependa só do tamanho dela
+    vector<uint32_t> localId(vertexCount, NO_VERTEX);
+    vector<uint32_t> globalId;
+    vector<uint32_t> local;
+    vector<float> localPositions;
+    for (const IndexedMesh::Submesh& submesh : mesh.submeshes)
+    {
+        uint32_t* indices = mesh.indices.data() + submesh.indexOffset;
+        const size_t count = submesh.indexCount;
+
+        globalId.clear();
+        local.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t& id = localId[indices[i]];
+            if (id == NO_VERTEX)
+            {
+                id = (uint32_t)globalId.size();
+                globalId.push_back(indices[i]);
+            }
+            local[i] = id;
+        }
+        localPositions.resize(globalId.size() * 3);
+        for (size_t v = 0; v < globalId.size(); ++v)
+        {
+            std::copy_n(&mesh.positions[(size_t)globalId[v] * 3], 3, &localPositions[v * 3]);
+        }
+
+        optimizeVertexCache(local.data(), count, globalId.size());
+        optimizeOverdraw(local.data(), count, localPositions.data(), 3, globalId.size(), options.overdrawThreshold);
+
+        for (size_t i = 0; i < count; ++i) indices[i] = globalId[local[i]];
+        for (uint32_t v : globalId) localId[v] = NO_VERTEX;
+    }
+
+    // Vértices na ordem em que são usados
+    reorderVertices(mesh);
+
+    stats.before = before;
+    stats.after = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+    stats.cacheSize = SIMULATED_CACHE_SIZE;
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
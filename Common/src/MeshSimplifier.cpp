@@ -0,0 +1,581 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
+#include <limits>
+#include <cstdint>
+
+namespace
+{
+    const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+    // Peso dos planos que prendem bordas e costuras, em relação aos planos dos triângulos
+    const double EDGE_PLANE_WEIGHT = 10.0;
+
+    enum VertexKind : unsigned char
+    {
+        KIND_MANIFOLD, // interior: pode colapsar em qualquer vizinho
+        KIND_BORDER,   // em borda aberta: só ao longo da borda
+        KIND_SEAM,     // costura com exatamente um irmão: só ao longo da costura, junto com o irmão
+        KIND_LOCKED    // cantos, costuras em T, etc.: nunca se move
+    };
+
+    // Erro quádrico: Q(p) = pᵀAp + 2b·p + c, normalizado pela soma dos pesos
+    struct Quadric
+    {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0;
+        double c = 0;
+        double weight = 0;
+
+        void addPlane(double nx, double ny, double nz, double d, double w)
+        {
+            a00 += w * nx * nx; a01 += w * nx * ny; a02 += w * nx * nz;
+            a11 += w * ny * ny; a12 += w * ny * nz; a22 += w * nz * nz;
+            b0 += w * nx * d; b1 += w * ny * d; b2 += w * nz * d;
+            c += w * d * d;
+            weight += w;
+        }
+
+        void add(const Quadric& q)
+        {
+            a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2;
+            c += q.c;
+            weight += q.weight;
+        }
+
+        // Distância ao quadrado (média ponderada) de p aos planos acumulados
+        double evaluate(const glm::vec3& p) const
+        {
+            if (weight <= 0.0) return 0.0;
+            const double x = p.x, y = p.y, z = p.z;
+            double e = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                     + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return std::max(e, 0.0) / weight;
+        }
+    };
+
+    inline uint64_t edgeKey(uint32_t a, uint32_t b) { return ((uint64_t)a << 32) | b; }
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+    };
+
+    struct Simplifier
+    {
+        vector<glm::vec3> positions;  // por vértice local
+        vector<uint32_t> group;       // representante dos vértices com a mesma posição
+        vector<uint32_t> sibling;     // próximo vértice do mesmo grupo (lista circular)
+        vector<VertexKind> kind;
+        vector<Quadric> quadrics;     // por representante de grupo
+
+        std::unordered_set<uint64_t> edges;      // arestas orientadas entre vértices
+        std::unordered_set<uint64_t> groupEdges; // arestas orientadas entre grupos
+
+        // Triângulos em volta de cada vértice, refeitos a cada passada
+        vector<uint32_t> adjacencyOffsets;
+        vector<uint32_t> adjacency;
+
+        bool isSeamEdge(uint32_t a, uint32_t b) const
+        {
+            return edges.count(edgeKey(a, b)) != edges.count(edgeKey(b, a));
+        }
+
+        bool isBorderEdge(uint32_t a, uint32_t b) const
+        {
+            const uint32_t ga = group[a], gb = group[b];
+            return groupEdges.count(edgeKey(ga, gb)) != groupEdges.count(edgeKey(gb, ga));
+        }
+
+        void buildGroups(size_t vertexCount)
+        {
+            // Ordena pela posição (bit a bit) e junta os iguais
+            vector<uint32_t> order(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i) order[i] = (uint32_t)i;
+            auto bitsOf = [this](uint32_t v) {
+                uint32_t bits[3];
+                memcpy(bits, &positions[v], sizeof(bits));
+                return std::make_tuple(bits[0], bits[1], bits[2]);
+            };
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return bitsOf(a) < bitsOf(b); });
+
+            group.assign(vertexCount, 0);
+            sibling.assign(vertexCount, 0);
+            for (size_t i = 0; i < vertexCount;)
+            {
+                size_t j = i + 1;
+                while (j < vertexCount && bitsOf(order[j]) == bitsOf(order[i])) ++j;
+                for (size_t k = i; k < j; ++k)
+                {
+                    group[order[k]] = order[i];
+                    sibling[order[k]] = order[k + 1 < j ? k + 1 : i];
+                }
+                i = j;
+            }
+        }
+
+        void classify(const vector<uint32_t>& indices)
+        {
+            const size_t vertexCount = positions.size();
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+                    edges.insert(edgeKey(a, b));
+                    groupEdges.insert(edgeKey(group[a], group[b]));
+                }
+            }
+
+            vector<int> openEdges(vertexCount, 0), borderEdges(vertexCount, 0), groupSize(vertexCount, 0);
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+                    if (!edges.count(edgeKey(b, a))) { ++openEdges[a]; ++openEdges[b]; }
+                    if (!groupEdges.count(edgeKey(group[b], group[a]))) { ++borderEdges[a]; ++borderEdges[b]; }
+                }
+            }
+            for (size_t v = 0; v < vertexCount; ++v) ++groupSize[group[v]];
+
+            kind.assign(vertexCount, KIND_LOCKED);
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                const int size = groupSize[group[v]];
+                if (size == 1)
+                {
+                    if (openEdges[v] == 0) kind[v] = KIND_MANIFOLD;
+                    else if (openEdges[v] == 2 && borderEdges[v] == 2) kind[v] = KIND_BORDER;
+                }
+                else if (size == 2)
+                {
+                    const uint32_t other = sibling[v];
+                    if (openEdges[v] == 2 && borderEdges[v] == 0 && openEdges[other] == 2 && borderEdges[other] == 0)
+                    {
+                        kind[v] = KIND_SEAM;
+                    }
+                }
+            }
+        }
+
+        void buildQuadrics(const vector<uint32_t>& indices)
+        {
+            quadrics.assign(positions.size(), Quadric());
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const uint32_t v[3] = { indices[i], indices[i + 1], indices[i + 2] };
+                const glm::vec3 p0 = positions[v[0]], p1 = positions[v[1]], p2 = positions[v[2]];
+                glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float doubleArea = glm::length(normal);
+                if (doubleArea <= 0.0f) continue;
+                normal /= doubleArea;
+
+                const double d = -glm::dot(normal, p0);
+                for (int k = 0; k < 3; ++k) quadrics[group[v[k]]].addPlane(normal.x, normal.y, normal.z, d, doubleArea * 0.5);
+
+                // Bordas e costuras: plano perpendicular ao triângulo passando pela aresta
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32_t a = v[k], b = v[(k + 1) % 3];
+                    if (edges.count(edgeKey(b, a))) continue;
+                    const glm::vec3 edge = positions[b] - positions[a];
+                    glm::vec3 plane = glm::cross(edge, normal);
+                    const float length = glm::length(plane);
+                    if (length <= 0.0f) continue;
+                    plane /= length;
+                    const double planeD = -glm::dot(plane, positions[a]);
+                    const double weight = glm::dot(edge, edge) * EDGE_PLANE_WEIGHT;
+                    quadrics[group[a]].addPlane(plane.x, plane.y, plane.z, planeD, weight);
+                    quadrics[group[b]].addPlane(plane.x, plane.y, plane.z, planeD, weight);
+                }
+            }
+        }
+
+        void buildAdjacency(const vector<uint32_t>& indices)
+        {
+            adjacencyOffsets.assign(positions.size() + 1, 0);
+            for (uint32_t v : indices) ++adjacencyOffsets[v + 1];
+            for (size_t v = 0; v < positions.size(); ++v) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+            adjacency.resize(indices.size());
+            vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+        }
+
+        // Irmão de v ligado por aresta a from (para colapsar os dois lados de uma costura juntos)
+        uint32_t siblingConnectedTo(uint32_t from, uint32_t v, const vector<uint32_t>& indices) const
+        {
+            for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i)
+            {
+                const uint32_t* tri = &indices[(size_t)adjacency[i] * 3];
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (tri[k] != v && tri[k] != from && group[tri[k]] == group[v]) return tri[k];
+                }
+            }
+            return NO_VERTEX;
+        }
+
+        // Verdadeiro se mover from para a posição de to não inverte nenhum triângulo que continua existindo
+        bool keepsOrientation(uint32_t from, uint32_t to, const vector<uint32_t>& indices) const
+        {
+            const glm::vec3 target = positions[to];
+            for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i)
+            {
+                const uint32_t* tri = &indices[(size_t)adjacency[i] * 3];
+                if (group[tri[0]] == group[to] || group[tri[1]] == group[to] || group[tri[2]] == group[to]) continue; // some
+
+                glm::vec3 p[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+                const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                for (int k = 0; k < 3; ++k) if (tri[k] == from) p[k] = target;
+                const glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                if (glm::dot(before, after) <= 1e-4f * glm::length(before) * glm::length(after)) return false;
+            }
+            return true;
+        }
+
+        // Triângulos que somem quando from vai para to
+        size_t removedTriangles(uint32_t from, uint32_t to, const vector<uint32_t>& indices) const
+        {
+            size_t count = 0;
+            for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i)
+            {
+                const uint32_t* tri = &indices[(size_t)adjacency[i] * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to) ++count;
+            }
+            return count;
+        }
+
+        bool canCollapse(uint32_t from, uint32_t to) const
+        {
+            if (group[from] == group[to]) return false;
+            switch (kind[from])
+            {
+                case KIND_MANIFOLD: return true;
+                case KIND_BORDER: return (kind[to] == KIND_BORDER || kind[to] == KIND_LOCKED) && isBorderEdge(from, to);
+                case KIND_SEAM: return (kind[to] == KIND_SEAM || kind[to] == KIND_LOCKED) && isSeamEdge(from, to);
+                default: return false;
+            }
+        }
+    };
+}
+
+namespace
+{
+    // Ponto do triângulo abc mais próximo de p (Ericson, Real-Time Collision Detection, 5.1.5)
+    glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+        const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+        const glm::vec3 bp = p - b;
+        const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3) return b;
+
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+        const glm::vec3 cp = p - c;
+        const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6) return c;
+
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        const float denom = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+    // Maior distância de um vértice usado por sourceIndices até a superfície de lodIndices.
+    // Os triângulos do nível ficam numa grade esparsa com células do tamanho médio de um
+    // triângulo; cada vértice procura em anéis de células até o anel não poder ter nada mais perto.
+    float surfaceDeviation(const float* positions, size_t vertexCount, const uint32_t* sourceIndices, size_t sourceCount, const vector<uint32_t>& lodIndices)
+    {
+        if (lodIndices.empty()) return 0.0f;
+        auto position = [positions](uint32_t v) { return glm::vec3(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]); };
+
+        double extent = 0.0;
+        for (size_t i = 0; i < lodIndices.size(); i += 3)
+        {
+            const glm::vec3 a = position(lodIndices[i]), b = position(lodIndices[i + 1]), c = position(lodIndices[i + 2]);
+            const glm::vec3 size = glm::max(a, glm::max(b, c)) - glm::min(a, glm::min(b, c));
+            extent += std::max(size.x, std::max(size.y, size.z));
+        }
+        const float cell = std::max((float)(extent / (lodIndices.size() / 3)), 1e-6f);
+
+        auto cellOf = [cell](float x) { return (int32_t)std::floor(x / cell); };
+        auto cellKey = [](int32_t x, int32_t y, int32_t z) {
+            return ((uint64_t)(uint32_t)(x & 0x1FFFFF) << 42) | ((uint64_t)(uint32_t)(y & 0x1FFFFF) << 21) | (uint64_t)(uint32_t)(z & 0x1FFFFF);
+        };
+        std::unordered_map<uint64_t, vector<uint32_t>> grid;
+        int32_t gridLow[3] = { INT32_MAX, INT32_MAX, INT32_MAX }, gridHigh[3] = { INT32_MIN, INT32_MIN, INT32_MIN };
+        for (size_t i = 0; i < lodIndices.size(); i += 3)
+        {
+            const glm::vec3 a = position(lodIndices[i]), b = position(lodIndices[i + 1]), c = position(lodIndices[i + 2]);
+            const glm::vec3 low = glm::min(a, glm::min(b, c)), high = glm::max(a, glm::max(b, c));
+            for (int k = 0; k < 3; ++k)
+            {
+                gridLow[k] = std::min(gridLow[k], cellOf(low[k]));
+                gridHigh[k] = std::max(gridHigh[k], cellOf(high[k]));
+            }
+            for (int32_t z = cellOf(low.z); z <= cellOf(high.z); ++z)
+                for (int32_t y = cellOf(low.y); y <= cellOf(high.y); ++y)
+                    for (int32_t x = cellOf(low.x); x <= cellOf(high.x); ++x)
+                        grid[cellKey(x, y, z)].push_back((uint32_t)i);
+        }
+
+        // Vértices que o nível ainda usa estão na superfície
+        vector<char> visited(vertexCount, 0);
+        for (uint32_t v : lodIndices) visited[v] = 1;
+        float worst = 0.0f;
+        for (size_t s = 0; s < sourceCount; ++s)
+        {
+            const uint32_t v = sourceIndices[s];
+            if (visited[v]) continue;
+            visited[v] = 1;
+            const glm::vec3 p = position(v);
+            const int32_t cx = cellOf(p.x), cy = cellOf(p.y), cz = cellOf(p.z);
+            const int32_t center[3] = { cx, cy, cz };
+            int32_t lastRing = 0;
+            for (int k = 0; k < 3; ++k) lastRing = std::max(lastRing, std::max(std::abs(gridLow[k] - center[k]), std::abs(gridHigh[k] - center[k])));
+
+            // Anel r: células a distância de Chebyshev r. Depois do anel r, o que falta está a mais de
+            // r * cell; e um vértice que já tem triângulo a até worst não muda o resultado
+            float best = std::numeric_limits<float>::max();
+            for (int32_t r = 0; r <= lastRing && best > worst && best > (r > 0 ? (r - 1) * cell : 0.0f); ++r)
+            {
+                for (int32_t z = cz - r; z <= cz + r; ++z)
+                    for (int32_t y = cy - r; y <= cy + r; ++y)
+                        for (int32_t x = cx - r; x <= cx + r; ++x)
+                        {
+                            if (std::max(std::abs(x - cx), std::max(std::abs(y - cy), std::abs(z - cz))) != r) continue;
+                            auto found = grid.find(cellKey(x, y, z));
+                            if (found == grid.end()) continue;
+                            for (uint32_t i : found->second)
+                            {
+                                const glm::vec3 q = closestPointOnTriangle(p, position(lodIndices[i]), position(lodIndices[i + 1]), position(lodIndices[i + 2]));
+                                best = std::min(best, glm::length(p - q));
+                            }
+                        }
+            }
+            if (best != std::numeric_limits<float>::max()) worst = std::max(worst, best);
+        }
+        return worst;
+    }
+}
+
+size_t simplifyMesh(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount,
+                    size_t targetIndexCount, float maxError, uint32_t* out, float* resultError)
+{
+    if (resultError) *resultError = 0.0f;
+    indexCount -= indexCount % 3;
+    if (indexCount == 0) return 0;
+
+    // Índice fora das posições: devolve a lista sem simplificar em vez de ler além do array
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            std::copy(indices, indices + indexCount, out);
+            return indexCount;
+        }
+    }
+
+    // Numeração local: o custo depende só dos vértices usados
+    vector<uint32_t> result, vertices;
+    compactIndices(indices, indexCount, result, vertices);
+
+    Simplifier simplifier;
+    simplifier.positions.resize(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        const float* p = positions + (size_t)vertices[v] * positionStride;
+        simplifier.positions[v] = glm::vec3(p[0], p[1], p[2]);
+    }
+    simplifier.buildGroups(vertices.size());
+    simplifier.classify(result);
+    simplifier.buildQuadrics(result);
+
+    const double maxErrorSquared = (double)maxError * maxError;
+    double worstError = 0.0;
+
+    vector<Collapse> candidates;
+    vector<uint32_t> collapseTo(vertices.size(), NO_VERTEX);
+    vector<char> locked(vertices.size(), 0);
+
+    while (result.size() > targetIndexCount)
+    {
+        simplifier.buildAdjacency(result);
+
+        candidates.clear();
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                const uint32_t pair[2][2] = { { a, b }, { b, a } };
+                for (const auto& edge : pair)
+                {
+                    if (!simplifier.canCollapse(edge[0], edge[1])) continue;
+                    Quadric q = simplifier.quadrics[simplifier.group[edge[0]]];
+                    q.add(simplifier.quadrics[simplifier.group[edge[1]]]);
+                    candidates.push_back({ q.evaluate(simplifier.positions[edge[1]]), edge[0], edge[1] });
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        // Colapsos independentes: cada um trava os grupos envolvidos e os vizinhos de from nesta passada
+        const size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+        size_t removed = 0;
+        size_t collapses = 0;
+        std::fill(locked.begin(), locked.end(), 0);
+        for (const Collapse& candidate : candidates)
+        {
+            if (candidate.cost > maxErrorSquared || removed >= trianglesToRemove) break;
+
+            const uint32_t from = candidate.from, to = candidate.to;
+            if (locked[simplifier.group[from]] || locked[simplifier.group[to]]) continue;
+
+            uint32_t siblingFrom = NO_VERTEX, siblingTo = NO_VERTEX;
+            if (simplifier.kind[from] == KIND_SEAM)
+            {
+                siblingFrom = simplifier.sibling[from];
+                siblingTo = simplifier.siblingConnectedTo(siblingFrom, to, result);
+                if (siblingTo == NO_VERTEX || !simplifier.isSeamEdge(siblingFrom, siblingTo)) continue;
+            }
+            if (!simplifier.keepsOrientation(from, to, result)) continue;
+            if (siblingFrom != NO_VERTEX && !simplifier.keepsOrientation(siblingFrom, siblingTo, result)) continue;
+
+            collapseTo[from] = to;
+            removed += simplifier.removedTriangles(from, to, result);
+            if (siblingFrom != NO_VERTEX)
+            {
+                collapseTo[siblingFrom] = siblingTo;
+                removed += simplifier.removedTriangles(siblingFrom, siblingTo, result);
+            }
+            simplifier.quadrics[simplifier.group[to]].add(simplifier.quadrics[simplifier.group[from]]);
+            worstError = std::max(worstError, candidate.cost);
+            ++collapses;
+
+            // Trava from, to e o anel de vizinhos de from (e do irmão)
+            for (uint32_t v : { from, siblingFrom })
+            {
+                if (v == NO_VERTEX) continue;
+                for (uint32_t i = simplifier.adjacencyOffsets[v]; i < simplifier.adjacencyOffsets[v + 1]; ++i)
+                {
+                    const uint32_t* tri = &result[(size_t)simplifier.adjacency[i] * 3];
+                    for (int k = 0; k < 3; ++k) locked[simplifier.group[tri[k]]] = 1;
+                }
+            }
+            locked[simplifier.group[to]] = 1;
+        }
+        if (collapses == 0) break;
+
+        // Aplica os colapsos e descarta triângulos que ficaram sem área (dois cantos na mesma posição)
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            uint32_t tri[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v = result[i + k];
+                tri[k] = collapseTo[v] != NO_VERTEX ? collapseTo[v] : v;
+            }
+            const uint32_t g0 = simplifier.group[tri[0]], g1 = simplifier.group[tri[1]], g2 = simplifier.group[tri[2]];
+            if (g0 == g1 || g1 == g2 || g0 == g2) continue;
+            result[write++] = tri[0];
+            result[write++] = tri[1];
+            result[write++] = tri[2];
+        }
+        result.resize(write);
+        std::fill(collapseTo.begin(), collapseTo.end(), NO_VERTEX);
+    }
+
+    for (size_t i = 0; i < result.size(); ++i) out[i] = vertices[result[i]];
+    if (resultError) *resultError = (float)std::sqrt(worstError);
+    return result.size();
+}
+
+MeshLodStats generateLods(IndexedMesh& mesh, const MeshLodOptions& options)
+{
+    MeshLodStats stats;
+    mesh.lods.clear();
+    if (options.ratios.empty() || mesh.indices.empty()) return stats;
+    auto start = std::chrono::steady_clock::now();
+
+    const size_t vertexCount = mesh.vertexCount();
+    const uint32_t baseSubmeshes = (uint32_t)mesh.submeshes.size();
+    mesh.lods.push_back({ 0, baseSubmeshes, 0.0f });
+
+    // Erro máximo proporcional à diagonal da caixa envolvente
+    glm::vec3 boundsMin(mesh.positions[0], mesh.positions[1], mesh.positions[2]);
+    glm::vec3 boundsMax = boundsMin;
+    for (size_t v = 1; v < vertexCount; ++v)
+    {
+        glm::vec3 p(mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2]);
+        boundsMin = glm::min(boundsMin, p);
+        boundsMax = glm::max(boundsMax, p);
+    }
+    const float maxError = options.maxError * glm::length(boundsMax - boundsMin);
+
+    size_t previousTotal = mesh.indices.size();
+    const size_t baseIndexCount = mesh.indices.size();
+    vector<uint32_t> simplified;
+    for (float ratio : options.ratios)
+    {
+        // Cada nível parte do anterior, com as mesmas submalhas na mesma ordem
+        const IndexedMesh::Lod& previous = mesh.lods.back();
+        IndexedMesh::Lod lod = { (uint32_t)mesh.submeshes.size(), baseSubmeshes, previous.error };
+
+        vector<uint32_t> lodIndices;
+        vector<IndexedMesh::Submesh> lodSubmeshes;
+        for (uint32_t s = 0; s < baseSubmeshes; ++s)
+        {
+            const IndexedMesh::Submesh source = mesh.submeshes[previous.firstSubmesh + s];
+            const size_t target = (size_t)(mesh.submeshes[s].indexCount * ratio) / 3 * 3;
+
+            simplified.resize(source.indexCount);
+            size_t count = simplifyMesh(mesh.indices.data() + source.indexOffset, source.indexCount, mesh.positions.data(), 3,
+                                        vertexCount, target, maxError, simplified.data(), nullptr);
+            optimizeVertexCache(simplified.data(), count, vertexCount);
+
+            lodSubmeshes.push_back({ (uint32_t)(mesh.indices.size() + lodIndices.size()), (uint32_t)count, source.materialId });
+            lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.begin() + count);
+        }
+
+        // Nível que quase não reduz não compensa (limite de erro alcançado)
+        if (lodIndices.size() > previousTotal * 9 / 10) break;
+
+        // O erro quádrico é uma média ponderada e subestima o desvio; o erro do nível é medido
+        // contra o nível 0, e nunca menor que o do anterior (a escolha de nível para no primeiro
+        // que passa do limite de pixels)
+        lod.error = std::max(previous.error, surfaceDeviation(mesh.positions.data(), vertexCount, mesh.indices.data(), baseIndexCount, lodIndices));
+        mesh.indices.insert(mesh.indices.end(), lodIndices.begin(), lodIndices.end());
+        mesh.submeshes.insert(mesh.submeshes.end(), lodSubmeshes.begin(), lodSubmeshes.end());
+        mesh.lods.push_back(lod);
+        previousTotal = lodIndices.size();
+    }
+
+    for (const IndexedMesh::Lod& lod : mesh.lods)
+    {
+        size_t triangles = 0;
+        for (uint32_t s = 0; s < lod.submeshCount; ++s) triangles += mesh.submeshes[lod.firstSubmesh + s].indexCount / 3;
+        stats.triangles.push_back(triangles);
+    }
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,300 @@
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    const uint32_t NO_MESHLET = 0xFFFFFFFFu;
+
+    inline glm::vec3 vertexPosition(const IndexedMesh& mesh, uint32_t v)
+    {
+        return glm::vec3(mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2]);
+    }
+
+    // Esfera envolvente e cone de normais dos triângulos indices[0 .. indexCount)
+    // (cone como no meshoptimizer: o ápice fica atrás de todos os planos dos triângulos)
+    Meshlet makeMeshlet(const IndexedMesh& mesh, uint32_t indexOffset, uint32_t indexCount)
+    {
+        Meshlet meshlet = {};
+        meshlet.indexOffset = indexOffset;
+        meshlet.indexCount = indexCount;
+        const uint32_t* indices = mesh.indices.data() + indexOffset;
+
+        glm::vec3 boundsMin = vertexPosition(mesh, indices[0]);
+        glm::vec3 boundsMax = boundsMin;
+        for (uint32_t i = 1; i < indexCount; ++i)
+        {
+            glm::vec3 p = vertexPosition(mesh, indices[i]);
+            boundsMin = glm::min(boundsMin, p);
+            boundsMax = glm::max(boundsMax, p);
+        }
+        const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        float radius = 0.0f;
+        for (uint32_t i = 0; i < indexCount; ++i) radius = std::max(radius, glm::length(vertexPosition(mesh, indices[i]) - center));
+
+        glm::vec3 normals[MESHLET_MAX_TRIANGLES];
+        glm::vec3 corners[MESHLET_MAX_TRIANGLES];
+        size_t triangles = 0;
+        glm::vec3 axis(0.0f);
+        for (uint32_t i = 0; i < indexCount; i += 3)
+        {
+            const glm::vec3 p0 = vertexPosition(mesh, indices[i]);
+            glm::vec3 normal = glm::cross(vertexPosition(mesh, indices[i + 1]) - p0, vertexPosition(mesh, indices[i + 2]) - p0);
+            const float length = glm::length(normal);
+            if (length <= 0.0f) continue;
+            normals[triangles] = normal / length;
+            corners[triangles] = p0;
+            axis += normals[triangles];
+            ++triangles;
+        }
+
+        // Sem cone quando as normais se abrem demais (ou a área é nula)
+        float coneCutoff = 2.0f;
+        glm::vec3 apex = center;
+        const float axisLength = glm::length(axis);
+        if (axisLength > 0.0f)
+        {
+            axis /= axisLength;
+            float minDot = 1.0f;
+            for (size_t t = 0; t < triangles; ++t) minDot = std::min(minDot, glm::dot(normals[t], axis));
+            if (minDot > 0.1f)
+            {
+                float maxT = 0.0f;
+                for (size_t t = 0; t < triangles; ++t)
+                {
+                    const float distance = glm::dot(center - corners[t], normals[t]);
+                    maxT = std::max(maxT, distance / glm::dot(axis, normals[t]));
+                }
+                apex = center - axis * maxT;
+                coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            meshlet.center[k] = center[k];
+            meshlet.coneApex[k] = apex[k];
+            meshlet.coneAxis[k] = axis[k];
+        }
+        meshlet.radius = radius;
+        meshlet.coneCutoff = coneCutoff;
+        return meshlet;
+    }
+}
+
+void buildMeshlets(IndexedMesh& mesh, vector<Meshlet>& meshlets, vector<uint32_t>& firstMeshlet)
+{
+    meshlets.clear();
+    firstMeshlet.assign(mesh.submeshes.size(), 0);
+
+    vector<uint32_t> local, vertices, adjacencyOffsets, adjacency, candidates, ordered, meshletSizes;
+    vector<glm::vec3> normals;
+    vector<char> used;
+    for (size_t s = 0; s < mesh.submeshes.size(); ++s)
+    {
+        const IndexedMesh::Submesh& submesh = mesh.submeshes[s];
+        firstMeshlet[s] = (uint32_t)meshlets.size();
+        const size_t triangleCount = submesh.indexCount / 3;
+        if (triangleCount == 0) continue;
+        uint32_t* indices = mesh.indices.data() + submesh.indexOffset;
+
+        // Adjacência vértice -> triângulos, com a numeração local da submalha
+        compactIndices(indices, triangleCount * 3, local, vertices);
+        adjacencyOffsets.assign(vertices.size() + 1, 0);
+        for (uint32_t v : local) ++adjacencyOffsets[v + 1];
+        for (size_t v = 0; v < vertices.size(); ++v) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        adjacency.resize(local.size());
+        {
+            vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < local.size(); ++i) adjacency[fill[local[i]]++] = (uint32_t)(i / 3);
+        }
+
+        normals.resize(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            const glm::vec3 p0 = vertexPosition(mesh, indices[t * 3]);
+            glm::vec3 normal = glm::cross(vertexPosition(mesh, indices[t * 3 + 1]) - p0, vertexPosition(mesh, indices[t * 3 + 2]) - p0);
+            const float length = glm::length(normal);
+            normals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+        }
+
+        // Crescimento guloso: cada meshlet começa no primeiro triângulo livre (na ordem do cache)
+        // e recebe o vizinho que traz menos vértices novos e mais se alinha à normal média,
+        // o que deixa os grupos compactos e com cones de normais estreitos
+        vector<uint32_t> seen(vertices.size(), NO_MESHLET);
+        used.assign(triangleCount, 0);
+        ordered.clear();
+        meshletSizes.clear();
+        size_t nextSeed = 0;
+        uint32_t meshletId = 0;
+        while (ordered.size() < triangleCount * 3)
+        {
+            size_t meshletVertices = 0, meshletTriangles = 0;
+            glm::vec3 normalSum(0.0f);
+            candidates.clear();
+
+            while (meshletTriangles < MESHLET_MAX_TRIANGLES)
+            {
+                auto newVertices = [&](uint32_t t) {
+                    const uint32_t* tri = &local[t * 3];
+                    size_t count = 0;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        if (seen[tri[k]] != meshletId && (k == 0 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1])) ++count;
+                    }
+                    return count;
+                };
+
+                const float normalLength = glm::length(normalSum);
+                const glm::vec3 meshletNormal = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+                uint32_t best = NO_MESHLET;
+                float bestScore = 0.0f;
+                bool hasNeighbours = false;
+                for (size_t c = 0; c < candidates.size();)
+                {
+                    const uint32_t t = candidates[c];
+                    if (used[t])
+                    {
+                        candidates[c] = candidates.back();
+                        candidates.pop_back();
+                        continue;
+                    }
+                    const size_t added = newVertices(t);
+                    hasNeighbours = true;
+                    if (meshletVertices + added <= MESHLET_MAX_VERTICES)
+                    {
+                        const float score = (float)added + (1.0f - glm::dot(normals[t], meshletNormal)) * 0.5f;
+                        if (best == NO_MESHLET || score < bestScore)
+                        {
+                            best = t;
+                            bestScore = score;
+                        }
+                    }
+                    ++c;
+                }
+
+                // Sem vizinhos livres (ilha terminada): continua com o próximo triângulo livre
+                if (best == NO_MESHLET)
+                {
+                    if (hasNeighbours) break; // vizinhos existem mas não cabem
+
+                    while (nextSeed < triangleCount && used[nextSeed]) ++nextSeed;
+                    if (nextSeed == triangleCount || meshletVertices + newVertices((uint32_t)nextSeed) > MESHLET_MAX_VERTICES) break;
+                    best = (uint32_t)nextSeed;
+                }
+
+                used[best] = 1;
+                meshletVertices += newVertices(best);
+                ++meshletTriangles;
+                normalSum += normals[best];
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32_t v = local[best * 3 + k];
+                    ordered.push_back(indices[best * 3 + k]);
+                    if (seen[v] == meshletId) continue;
+                    seen[v] = meshletId;
+                    for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a)
+                    {
+                        if (!used[adjacency[a]]) candidates.push_back(adjacency[a]);
+                    }
+                }
+            }
+            meshletSizes.push_back((uint32_t)(meshletTriangles * 3));
+            ++meshletId;
+        }
+
+        // Grava a nova ordem, otimiza cada meshlet para o cache de vértices e calcula os limites
+        std::copy(ordered.begin(), ordered.end(), indices);
+        uint32_t offset = submesh.indexOffset;
+        for (uint32_t size : meshletSizes)
+        {
+            optimizeVertexCache(mesh.indices.data() + offset, size, mesh.vertexCount());
+            meshlets.push_back(makeMeshlet(mesh, offset, size));
+            offset += size;
+        }
+    }
+
+    // A ordem dos vértices vinha da ordem dos triângulos antes dos meshlets; refeita, as leituras
+    // de cada meshlet voltam a cair numa faixa contígua do buffer de vértices
+    reorderVertices(mesh);
+}
+
+Frustum extractFrustum(const glm::mat4& m)
+{
+    // Linhas da matriz (glm guarda por colunas: m[coluna][linha])
+    auto row = [&m](int r) { return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]); };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0); // esquerda
+    frustum.planes[1] = row(3) - row(0); // direita
+    frustum.planes[2] = row(3) + row(1); // baixo
+    frustum.planes[3] = row(3) - row(1); // cima
+    frustum.planes[4] = row(3) + row(2); // perto
+    frustum.planes[5] = row(3) - row(2); // longe
+    for (glm::vec4& plane : frustum.planes)
+    {
+        plane /= glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    }
+    return frustum;
+}
+
+bool sphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius)
+{
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
+void cullMeshlets(const Meshlet* meshlets, size_t count, const glm::mat4& model, const Frustum& frustum, const glm::vec3& cameraPos,
+                  vector<uint32_t>& offsets, vector<uint32_t>& counts, MeshletCullStats& stats)
+{
+    // O cone é testado no espaço do objeto (o teste de costas não muda com transformações afins)
+    const glm::vec3 localCamera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPos, 1.0f));
+    const float maxScale = std::sqrt(std::max(glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                                     std::max(glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+                                              glm::dot(glm::vec3(model[2]), glm::vec3(model[2])))));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Meshlet& meshlet = meshlets[i];
+        const size_t triangles = meshlet.indexCount / 3;
+        ++stats.meshlets;
+        stats.triangles += triangles;
+
+        const glm::vec3 center = glm::vec3(model * glm::vec4(meshlet.center[0], meshlet.center[1], meshlet.center[2], 1.0f));
+        if (!sphereInFrustum(frustum, center, meshlet.radius * maxScale))
+        {
+            stats.frustumCulled += triangles;
+            continue;
+        }
+
+        if (meshlet.coneCutoff <= 1.0f)
+        {
+            const glm::vec3 apex(meshlet.coneApex[0], meshlet.coneApex[1], meshlet.coneApex[2]);
+            const glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+            const glm::vec3 toApex = apex - localCamera;
+            const float distance = glm::length(toApex);
+            if (distance > 0.0f && glm::dot(toApex, axis) >= meshlet.coneCutoff * distance)
+            {
+                stats.backfaceCulled += triangles;
+                continue;
+            }
+        }
+
+        ++stats.visibleMeshlets;
+        if (!counts.empty() && offsets.back() + counts.back() == meshlet.indexOffset)
+        {
+            counts.back() += meshlet.indexCount;
+        }
+        else
+        {
+            offsets.push_back(meshlet.indexOffset);
+            counts.push_back(meshlet.indexCount);
+            ++stats.drawCalls;
+        }
+    }
+}
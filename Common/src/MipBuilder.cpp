@@ -0,0 +1,235 @@
+#include "MipBuilder.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MIP_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MIP_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define MIP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    const int ENCODE_STEPS = 4096; // resolução da tabela linear -> 8 bits
+
+    // decode[0..255] = cor em linear, decode[256..511] = alfa / 255;
+    // encode[i] = byte cujo valor linear mais se aproxima de i / 4095
+    struct MipTables
+    {
+        alignas(32) float decode[512];
+        alignas(32) int32_t encode[ENCODE_STEPS];
+
+        explicit MipTables(bool srgb)
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                const float c = i / 255.0f;
+                decode[i] = srgb ? (c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f)) : c;
+                decode[256 + i] = c;
+            }
+            for (int i = 0; i < ENCODE_STEPS; ++i)
+            {
+                const float l = i / (float)(ENCODE_STEPS - 1);
+                const float c = srgb ? (l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f) : l;
+                encode[i] = std::min(255, (int)std::lround(c * 255.0f));
+            }
+        }
+    };
+
+    const MipTables& mipTables(bool srgb)
+    {
+        static const MipTables srgbTables(true), linearTables(false);
+        return srgb ? srgbTables : linearTables;
+    }
+
+    inline int encodeIndex(float value, float scale)
+    {
+        return std::min((int)std::nearbyint(value * scale), ENCODE_STEPS - 1);
+    }
+
+    // Referência: pixel a pixel, com as mesmas operações (e na mesma ordem) das versões SIMD
+    void downsampleScalar(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out, const MipTables& tables)
+    {
+        const uint32_t outWidth = std::max(1u, width / 2), outHeight = std::max(1u, height / 2);
+        for (uint32_t y = 0; y < outHeight; ++y)
+        {
+            const uint8_t* row0 = rgba + (size_t)std::min(y * 2, height - 1) * width * 4;
+            const uint8_t* row1 = rgba + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+            for (uint32_t x = 0; x < outWidth; ++x)
+            {
+                const uint32_t x0 = std::min(x * 2, width - 1) * 4, x1 = std::min(x * 2 + 1, width - 1) * 4;
+                uint8_t* target = out + ((size_t)y * outWidth + x) * 4;
+                for (int k = 0; k < 4; ++k)
+                {
+                    const float* decode = tables.decode + (k == 3 ? 256 : 0);
+                    const float top = decode[row0[x0 + k]] + decode[row0[x1 + k]];
+                    const float bottom = decode[row1[x0 + k]] + decode[row1[x1 + k]];
+                    const float value = (top + bottom) * 0.25f;
+                    const int index = encodeIndex(value, k == 3 ? 255.0f : (float)(ENCODE_STEPS - 1));
+                    target[k] = (uint8_t)(k == 3 ? index : tables.encode[index]);
+                }
+            }
+        }
+    }
+
+#ifdef MIP_X86
+    // SSE2: uma linha de origem vira floats lineares (tabela) e cada pixel RGBA é um __m128
+    void downsampleSse2(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out, const MipTables& tables)
+    {
+        const uint32_t outWidth = width / 2, outHeight = std::max(1u, height / 2);
+        vector<float> linear0((size_t)outWidth * 8), linear1((size_t)outWidth * 8);
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        const __m128 scale = _mm_set_ps(255.0f, (float)(ENCODE_STEPS - 1), (float)(ENCODE_STEPS - 1), (float)(ENCODE_STEPS - 1));
+        const __m128 maxIndex = _mm_set1_ps((float)(ENCODE_STEPS - 1));
+
+        auto decodeRow = [&](const uint8_t* row, float* linear)
+        {
+            for (uint32_t i = 0; i < outWidth * 2; ++i)
+            {
+                linear[i * 4 + 0] = tables.decode[row[i * 4 + 0]];
+                linear[i * 4 + 1] = tables.decode[row[i * 4 + 1]];
+                linear[i * 4 + 2] = tables.decode[row[i * 4 + 2]];
+                linear[i * 4 + 3] = tables.decode[256 + row[i * 4 + 3]];
+            }
+        };
+
+        alignas(16) int32_t index[4];
+        for (uint32_t y = 0; y < outHeight; ++y)
+        {
+            decodeRow(rgba + (size_t)std::min(y * 2, height - 1) * width * 4, linear0.data());
+            decodeRow(rgba + (size_t)std::min(y * 2 + 1, height - 1) * width * 4, linear1.data());
+            uint8_t* target = out + (size_t)y * outWidth * 4;
+            for (uint32_t x = 0; x < outWidth; ++x)
+            {
+                const float* p0 = linear0.data() + x * 8;
+                const float* p1 = linear1.data() + x * 8;
+                const __m128 top = _mm_add_ps(_mm_loadu_ps(p0), _mm_loadu_ps(p0 + 4));
+                const __m128 bottom = _mm_add_ps(_mm_loadu_ps(p1), _mm_loadu_ps(p1 + 4));
+                const __m128 value = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(top, bottom), quarter), scale);
+                _mm_store_si128((__m128i*)index, _mm_cvtps_epi32(_mm_min_ps(value, maxIndex)));
+                target[x * 4 + 0] = (uint8_t)tables.encode[index[0]];
+                target[x * 4 + 1] = (uint8_t)tables.encode[index[1]];
+                target[x * 4 + 2] = (uint8_t)tables.encode[index[2]];
+                target[x * 4 + 3] = (uint8_t)index[3];
+            }
+        }
+    }
+
+    // 2 pixels (8 bytes) -> 8 floats lineares
+    MIP_TARGET_AVX2 inline __m256 decodeAvx2(const uint8_t* pixels, const MipTables& tables)
+    {
+        const __m256i alphaOffset = _mm256_set_epi32(256, 0, 0, 0, 256, 0, 0, 0);
+        const __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)pixels));
+        return _mm256_i32gather_ps(tables.decode, _mm256_add_epi32(bytes, alphaOffset), 4);
+    }
+
+    // Pares de pixels vizinhos [a b] [c d] -> [a+b c+d]
+    MIP_TARGET_AVX2 inline __m256 sumPairsAvx2(__m256 ab, __m256 cd)
+    {
+        return _mm256_add_ps(_mm256_permute2f128_ps(ab, cd, 0x20), _mm256_permute2f128_ps(ab, cd, 0x31));
+    }
+
+    // Soma de 2x2 de dois pixels -> 8 bytes RGBA
+    MIP_TARGET_AVX2 inline void encodeAvx2(__m256 sum, uint8_t* target, const MipTables& tables)
+    {
+        const float colorScale = (float)(ENCODE_STEPS - 1);
+        const __m256 scale = _mm256_set_ps(255.0f, colorScale, colorScale, colorScale, 255.0f, colorScale, colorScale, colorScale);
+        const __m256 value = _mm256_mul_ps(_mm256_mul_ps(sum, _mm256_set1_ps(0.25f)), scale);
+        const __m256i index = _mm256_cvtps_epi32(_mm256_min_ps(value, _mm256_set1_ps(colorScale)));
+        // Gather na tabela de 16 KB saiu mais lento que as leituras comuns
+        alignas(32) int32_t indices[8];
+        _mm256_store_si256((__m256i*)indices, index);
+        for (int i = 0; i < 8; ++i) target[i] = (uint8_t)((i & 3) == 3 ? indices[i] : tables.encode[indices[i]]);
+    }
+
+    // AVX2: dois pixels de saída por iteração, com gather na tabela de decodificação
+    MIP_TARGET_AVX2 void downsampleAvx2(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out, const MipTables& tables)
+    {
+        const uint32_t outWidth = width / 2, outHeight = std::max(1u, height / 2);
+        for (uint32_t y = 0; y < outHeight; ++y)
+        {
+            const uint8_t* row0 = rgba + (size_t)std::min(y * 2, height - 1) * width * 4;
+            const uint8_t* row1 = rgba + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+            uint8_t* target = out + (size_t)y * outWidth * 4;
+            uint32_t x = 0;
+            for (; x + 2 <= outWidth; x += 2)
+            {
+                const __m256 top = sumPairsAvx2(decodeAvx2(row0 + x * 8, tables), decodeAvx2(row0 + x * 8 + 8, tables));
+                const __m256 bottom = sumPairsAvx2(decodeAvx2(row1 + x * 8, tables), decodeAvx2(row1 + x * 8 + 8, tables));
+                encodeAvx2(_mm256_add_ps(top, bottom), target + x * 4, tables);
+            }
+            for (; x < outWidth; ++x)
+            {
+                // Último pixel de larguras ímpares: o mesmo cálculo, só com metade dos registradores útil
+                const __m256 top = sumPairsAvx2(decodeAvx2(row0 + x * 8, tables), _mm256_setzero_ps());
+                const __m256 bottom = sumPairsAvx2(decodeAvx2(row1 + x * 8, tables), _mm256_setzero_ps());
+                uint8_t pair[8];
+                encodeAvx2(_mm256_add_ps(top, bottom), pair, tables);
+                memcpy(target + x * 4, pair, 4);
+            }
+        }
+    }
+
+    bool cpuHasAvx2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+}
+
+MipSimdPath mipSimdPath()
+{
+#ifdef MIP_X86
+    static const MipSimdPath path = cpuHasAvx2() ? MIP_AVX2 : MIP_SSE2;
+    return path;
+#else
+    return MIP_SCALAR;
+#endif
+}
+
+const char* mipSimdPathName(MipSimdPath path)
+{
+    switch (path)
+    {
+    case MIP_AVX2: return "AVX2";
+    case MIP_SSE2: return "SSE2";
+    default: return "scalar";
+    }
+}
+
+void downsampleRgba(const uint8_t* rgba, uint32_t width, uint32_t height, vector<uint8_t>& out, bool srgb)
+{
+    downsampleRgba(rgba, width, height, out, srgb, mipSimdPath());
+}
+
+void downsampleRgba(const uint8_t* rgba, uint32_t width, uint32_t height, vector<uint8_t>& out, bool srgb, MipSimdPath path)
+{
+    const uint32_t outWidth = std::max(1u, width / 2), outHeight = std::max(1u, height / 2);
+    out.resize((size_t)outWidth * outHeight * 4);
+    const MipTables& tables = mipTables(srgb);
+
+    // Largura 1 repete a coluna; só a versão escalar trata esse caso
+#ifdef MIP_X86
+    if (width >= 2 && path == MIP_AVX2) return downsampleAvx2(rgba, width, height, out.data(), tables);
+    if (width >= 2 && path == MIP_SSE2) return downsampleSse2(rgba, width, height, out.data(), tables);
+#endif
+    downsampleScalar(rgba, width, height, out.data(), tables);
+}
@@ -0,0 +1,553 @@
+#include "ObjLoader.h"
+#include "TextParse.h"
+#include "ObjParse.h"
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+void ObjModel::clear()
+{
+    positions.clear();
+    texcoords.clear();
+    normals.clear();
+    corners.clear();
+    mtlLib.clear();
+    materialNames.clear();
+    materialRanges.clear();
+}
+
+void ObjModel::addMaterialRange(size_t firstTriangle, int materialId)
+{
+    // usemtl sem faces desde o anterior substitui o anterior
+    if (!materialRanges.empty() && materialRanges.back().firstTriangle == firstTriangle)
+    {
+        materialRanges.pop_back();
+    }
+    if (!materialRanges.empty() && materialRanges.back().materialId == materialId)
+    {
+        return;
+    }
+    materialRanges.push_back({ firstTriangle, materialId });
+}
+
+namespace
+{
+    // Área com sinal (x2) do triângulo abc no plano de projeção
+    inline float cross2(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+    {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+
+    inline bool insideTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, float sign)
+    {
+        return cross2(a, b, p) * sign >= 0.0f && cross2(b, c, p) * sign >= 0.0f && cross2(c, a, p) * sign >= 0.0f;
+    }
+}
+
+// Triangula um polígono: leque quando é convexo, corte de orelhas quando é côncavo
+void triangulatePolygon(const ObjIndex* polygon, size_t size, const glm::vec3* positions, size_t nPositions, TriangulationScratch& scratch, vector<ObjIndex>& out)
+{
+    if (size == 3)
+    {
+        out.insert(out.end(), polygon, polygon + 3);
+        return;
+    }
+
+    // Normal pelo método de Newell; projeta no plano do eixo dominante
+    auto positionOf = [&](size_t i) {
+        int v = polygon[i].v;
+        return (v >= 0 && (size_t)v < nPositions) ? positions[v] : glm::vec3(0.0f);
+    };
+    glm::vec3 normal(0.0f);
+    for (size_t i = 0; i < size; ++i)
+    {
+        glm::vec3 a = positionOf(i);
+        glm::vec3 b = positionOf((i + 1) % size);
+        normal.x += (a.y - b.y) * (a.z + b.z);
+        normal.y += (a.z - b.z) * (a.x + b.x);
+        normal.z += (a.x - b.x) * (a.y + b.y);
+    }
+    glm::vec3 absNormal(std::fabs(normal.x), std::fabs(normal.y), std::fabs(normal.z));
+    int axis = (absNormal.x > absNormal.y) ? (absNormal.x > absNormal.z ? 0 : 2) : (absNormal.y > absNormal.z ? 1 : 2);
+    const int u = (axis + 1) % 3;
+    const int w = (axis + 2) % 3;
+
+    scratch.projected.resize(size);
+    float area = 0.0f;
+    for (size_t i = 0; i < size; ++i)
+    {
+        glm::vec3 position = positionOf(i);
+        scratch.projected[i] = glm::vec2(position[u], position[w]);
+    }
+    for (size_t i = 0; i < size; ++i)
+    {
+        const glm::vec2& a = scratch.projected[i];
+        const glm::vec2& b = scratch.projected[(i + 1) % size];
+        area += a.x * b.y - b.x * a.y;
+    }
+    const float sign = area >= 0.0f ? 1.0f : -1.0f;
+
+    // Convexo (ou degenerado): leque a partir do primeiro canto
+    bool convex = true;
+    for (size_t i = 0; i < size && convex; ++i)
+    {
+        const glm::vec2& a = scratch.projected[i];
+        const glm::vec2& b = scratch.projected[(i + 1) % size];
+        const glm::vec2& c = scratch.projected[(i + 2) % size];
+        convex = cross2(a, b, c) * sign >= 0.0f;
+    }
+    if (convex || area == 0.0f)
+    {
+        for (size_t i = 1; i + 1 < size; ++i)
+        {
+            out.push_back(polygon[0]);
+            out.push_back(polygon[i]);
+            out.push_back(polygon[i + 1]);
+        }
+        return;
+    }
+
+    // Côncavo: corte de orelhas O(n^2)
+    vector<int>& remaining = scratch.remaining;
+    remaining.resize(size);
+    for (size_t i = 0; i < size; ++i) remaining[i] = (int)i;
+
+    size_t i = 0;
+    size_t attempts = 0;
+    while (remaining.size() > 3 && attempts < remaining.size())
+    {
+        const size_t n = remaining.size();
+        const int prev = remaining[(i + n - 1) % n];
+        const int curr = remaining[i % n];
+        const int next = remaining[(i + 1) % n];
+        const glm::vec2& a = scratch.projected[prev];
+        const glm::vec2& b = scratch.projected[curr];
+        const glm::vec2& c = scratch.projected[next];
+
+        bool ear = cross2(a, b, c) * sign > 0.0f;
+        for (size_t k = 0; k < n && ear; ++k)
+        {
+            int other = remaining[k];
+            if (other == prev || other == curr || other == next) continue;
+            ear = !insideTriangle(scratch.projected[other], a, b, c, sign);
+        }
+
+        if (ear)
+        {
+            out.push_back(polygon[prev]);
+            out.push_back(polygon[curr]);
+            out.push_back(polygon[next]);
+            remaining.erase(remaining.begin() + (i % n));
+            attempts = 0;
+            if (i >= remaining.size()) i = 0;
+        }
+        else
+        {
+            i = (i + 1) % n;
+            ++attempts;
+        }
+    }
+
+    // O que sobrou (triângulo final, ou polígono auto-intersectante) vai em leque
+    for (size_t k = 1; k + 1 < remaining.size(); ++k)
+    {
+        out.push_back(polygon[remaining[0]]);
+        out.push_back(polygon[remaining[k]]);
+        out.push_back(polygon[remaining[k + 1]]);
+    }
+}
+
+namespace
+{
+    // Trecho do arquivo processado por uma thread. Os atributos são escritos
+    // diretamente no ObjModel a partir das bases (soma de prefixos das contagens
+    // dos trechos anteriores). As faces ficam como polígonos (cantos + tamanho)
+    // até que todas as posições estejam lidas; só então são trianguladas.
+    struct ObjChunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        size_t nPositions = 0;
+        size_t nTexcoords = 0;
+        size_t nNormals = 0;
+        size_t nFaces = 0;
+
+        size_t basePosition = 0;
+        size_t baseTexcoord = 0;
+        size_t baseNormal = 0;
+
+        vector<ObjIndex> polygonCorners;
+        vector<uint32_t> faceSizes;
+        vector<ObjIndex> corners; // triângulos, após triangulateChunk
+        string mtlLib;
+
+        // usemtl: (face do trecho, nome), convertido para (triângulo do trecho, nome) na triangulação
+        vector<pair<size_t, string>> useMtl;
+    };
+
+    void countChunk(ObjChunk& chunk)
+    {
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+        while (p < end)
+        {
+            p = skipBlanks(p, end);
+            if (p >= end) break;
+
+            const char* body;
+            switch (classifyLine(p, end, body))
+            {
+                case ObjLine::Position: ++chunk.nPositions; break;
+                case ObjLine::Texcoord: ++chunk.nTexcoords; break;
+                case ObjLine::Normal: ++chunk.nNormals; break;
+                case ObjLine::Face: ++chunk.nFaces; break;
+                default: break;
+            }
+            p = nextLine(p, end);
+        }
+    }
+
+    void parseChunk(ObjChunk& chunk, ObjModel& model)
+    {
+        glm::vec3* positions = model.positions.data() + chunk.basePosition;
+        glm::vec2* texcoords = model.texcoords.data() + chunk.baseTexcoord;
+        glm::vec3* normals = model.normals.data() + chunk.baseNormal;
+
+        chunk.polygonCorners.reserve(chunk.nFaces * 3);
+        chunk.faceSizes.reserve(chunk.nFaces);
+
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+        while (p < end)
+        {
+            p = skipBlanks(p, end);
+            if (p >= end) break;
+
+            const char* body;
+            switch (classifyLine(p, end, body))
+            {
+                case ObjLine::Position:
+                {
+                    glm::vec3& values = *positions++;
+                    p = parseFloat(body, end, values.x);
+                    p = parseFloat(p, end, values.y);
+                    p = parseFloat(p, end, values.z);
+                    break;
+                }
+                case ObjLine::Texcoord:
+                {
+                    glm::vec2& values = *texcoords++;
+                    p = parseFloat(body, end, values.x);
+                    p = parseFloat(p, end, values.y);
+                    break;
+                }
+                case ObjLine::Normal:
+                {
+                    glm::vec3& values = *normals++;
+                    p = parseFloat(body, end, values.x);
+                    p = parseFloat(p, end, values.y);
+                    p = parseFloat(p, end, values.z);
+                    break;
+                }
+                case ObjLine::Face:
+                {
+                    AttributeCounts counts;
+                    counts.positions = positions - model.positions.data();
+                    counts.texcoords = texcoords - model.texcoords.data();
+                    counts.normals = normals - model.normals.data();
+
+                    const size_t first = chunk.polygonCorners.size();
+                    p = skipBlanks(body, end);
+                    while (p < end && *p != '\n')
+                    {
+                        ObjIndex corner;
+                        p = parseCorner(p, end, counts, corner);
+                        chunk.polygonCorners.push_back(corner);
+                        p = skipBlanks(p, end);
+                    }
+                    const size_t size = chunk.polygonCorners.size() - first;
+                    if (size >= 3)
+                    {
+                        chunk.faceSizes.push_back((uint32_t)size);
+                    }
+                    else
+                    {
+                        chunk.polygonCorners.resize(first); // linha "f" incompleta
+                    }
+                    break;
+                }
+                case ObjLine::MtlLib:
+                    chunk.mtlLib = restOfLine(body, end);
+                    break;
+                case ObjLine::UseMtl:
+                    chunk.useMtl.emplace_back(chunk.faceSizes.size(), restOfLine(body, end));
+                    break;
+                default:
+                    break;
+            }
+            p = nextLine(p, end);
+        }
+    }
+
+    void triangulateChunk(ObjChunk& chunk, const ObjModel& model)
+    {
+        TriangulationScratch scratch;
+        chunk.corners.reserve(chunk.polygonCorners.size() * 3 / 2);
+
+        // Os índices de face de usemtl viram índices de triângulo
+        size_t nextUseMtl = 0;
+        auto markUseMtl = [&chunk, &nextUseMtl](size_t face) {
+            while (nextUseMtl < chunk.useMtl.size() && chunk.useMtl[nextUseMtl].first <= face)
+            {
+                chunk.useMtl[nextUseMtl++].first = chunk.corners.size() / 3;
+            }
+        };
+
+        const ObjIndex* polygon = chunk.polygonCorners.data();
+        for (size_t face = 0; face < chunk.faceSizes.size(); ++face)
+        {
+            markUseMtl(face);
+            const uint32_t size = chunk.faceSizes[face];
+            triangulatePolygon(polygon, size, model.positions.data(), model.positions.size(), scratch, chunk.corners);
+            polygon += size;
+        }
+        markUseMtl(chunk.faceSizes.size());
+        vector<ObjIndex>().swap(chunk.polygonCorners);
+        vector<uint32_t>().swap(chunk.faceSizes);
+    }
+
+    // Executa fn(i) para cada trecho, em paralelo quando há mais de um
+    template <typename Fn>
+    void forEachChunk(size_t count, Fn fn)
+    {
+        if (count == 1)
+        {
+            fn(0);
+            return;
+        }
+        vector<std::thread> workers;
+        workers.reserve(count - 1);
+        for (size_t i = 1; i < count; ++i)
+        {
+            workers.emplace_back(fn, i);
+        }
+        fn(0);
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // Tamanho mínimo de um trecho; abaixo disso criar threads não compensa
+    const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+    // Divide [begin, end) em trechos que terminam sempre após um '\n'
+    vector<ObjChunk> splitChunks(const char* begin, const char* end, int numThreads)
+    {
+        size_t size = end - begin;
+        size_t count = numThreads > 0 ? (size_t)numThreads : std::max(1u, std::thread::hardware_concurrency());
+        count = std::max<size_t>(1, std::min(count, size / MIN_CHUNK_BYTES));
+
+        vector<ObjChunk> chunks;
+        chunks.reserve(count);
+        const char* chunkBegin = begin;
+        for (size_t i = 1; i <= count && chunkBegin < end; ++i)
+        {
+            const char* chunkEnd = (i == count) ? end : nextLine(std::max(chunkBegin, begin + size * i / count), end);
+            ObjChunk chunk;
+            chunk.begin = chunkBegin;
+            chunk.end = chunkEnd;
+            chunks.push_back(std::move(chunk));
+            chunkBegin = chunkEnd;
+        }
+        return chunks;
+    }
+}
+
+bool loadObj(const string& path, ObjModel& model, int numThreads, ObjLoadStats* stats)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    model.clear();
+
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    vector<ObjChunk> chunks = splitChunks(file.begin(), file.end(), numThreads);
+
+    // 1ª passada: conta os atributos de cada trecho
+    forEachChunk(chunks.size(), [&chunks](size_t i) { countChunk(chunks[i]); });
+
+    // Soma de prefixos: cada trecho sabe onde seus atributos começam no índice global
+    size_t nPositions = 0, nTexcoords = 0, nNormals = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.basePosition = nPositions;
+        chunk.baseTexcoord = nTexcoords;
+        chunk.baseNormal = nNormals;
+        nPositions += chunk.nPositions;
+        nTexcoords += chunk.nTexcoords;
+        nNormals += chunk.nNormals;
+    }
+    model.positions.resize(nPositions);
+    model.texcoords.resize(nTexcoords);
+    model.normals.resize(nNormals);
+
+    // 2ª passada: leitura dos valores
+    forEachChunk(chunks.size(), [&chunks, &model](size_t i) { parseChunk(chunks[i], model); });
+
+    // Triangulação, depois que todas as posições foram lidas
+    forEachChunk(chunks.size(), [&chunks, &model](size_t i) { triangulateChunk(chunks[i], model); });
+
+    // Junção na ordem do arquivo. O material corrente passa de um trecho para o
+    // seguinte, e os ids seguem a ordem do primeiro usemtl de cada nome.
+    size_t nCorners = 0;
+    for (const ObjChunk& chunk : chunks) nCorners += chunk.corners.size();
+    model.corners.reserve(nCorners);
+
+    std::unordered_map<string, int> materialIds;
+    model.materialRanges.push_back({ 0, -1 });
+    for (ObjChunk& chunk : chunks)
+    {
+        const size_t baseTriangle = model.corners.size() / 3;
+        for (const auto& use : chunk.useMtl)
+        {
+            auto found = materialIds.emplace(use.second, (int)model.materialNames.size());
+            if (found.second) model.materialNames.push_back(use.second);
+            model.addMaterialRange(baseTriangle + use.first, found.first->second);
+        }
+
+        model.corners.insert(model.corners.end(), chunk.corners.begin(), chunk.corners.end());
+        if (!chunk.mtlLib.empty()) model.mtlLib = chunk.mtlLib;
+        vector<ObjIndex>().swap(chunk.corners);
+    }
+
+    if (stats)
+    {
+        stats->triangles = model.triangleCount();
+        stats->threads = chunks.size();
+        stats->ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+void IndexedMesh::clear()
+{
+    positions.clear();
+    texcoords.clear();
+    normals.clear();
+    indices.clear();
+    submeshes.clear();
+    materialNames.clear();
+    lods.clear();
+}
+
+namespace
+{
+    // Atributos de um canto; índices fora do intervalo viram zero
+    struct CornerAttributes
+    {
+        glm::vec3 position;
+        glm::vec2 texcoord;
+        glm::vec3 normal;
+    };
+
+    inline CornerAttributes fetchCorner(const ObjModel& model, const ObjIndex& corner)
+    {
+        CornerAttributes out;
+        out.position = (corner.v >= 0 && corner.v < (int)model.positions.size()) ? model.positions[corner.v] : glm::vec3(0.0f);
+        out.texcoord = (corner.vt >= 0 && corner.vt < (int)model.texcoords.size()) ? model.texcoords[corner.vt] : glm::vec2(0.0f);
+        out.normal = (corner.vn >= 0 && corner.vn < (int)model.normals.size()) ? model.normals[corner.vn] : glm::vec3(0.0f);
+        out.texcoord.y = 1.0f - out.texcoord.y; // Inverte V para o OpenGL
+        return out;
+    }
+}
+
+void buildIndexedMesh(const ObjModel& model, IndexedMesh& mesh)
+{
+    mesh.clear();
+    mesh.materialNames = model.materialNames;
+    mesh.indices.reserve(model.corners.size());
+
+    // Ordena os triângulos por material (counting sort estável); -1 (sem material) vai primeiro
+    const size_t nTriangles = model.triangleCount();
+    const size_t nBuckets = model.materialNames.size() + 1;
+    vector<uint32_t> bucketStart(nBuckets + 1, 0);
+    for (size_t r = 0; r < model.materialRanges.size(); ++r)
+    {
+        const size_t first = model.materialRanges[r].firstTriangle;
+        const size_t last = (r + 1 < model.materialRanges.size()) ? model.materialRanges[r + 1].firstTriangle : nTriangles;
+        bucketStart[model.materialRanges[r].materialId + 2] += (uint32_t)(last - first);
+    }
+    for (size_t b = 1; b <= nBuckets; ++b) bucketStart[b] += bucketStart[b - 1];
+
+    vector<uint32_t> order(nTriangles);
+    {
+        vector<uint32_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (size_t r = 0; r < model.materialRanges.size(); ++r)
+        {
+            const size_t first = model.materialRanges[r].firstTriangle;
+            const size_t last = (r + 1 < model.materialRanges.size()) ? model.materialRanges[r + 1].firstTriangle : nTriangles;
+            uint32_t& out = cursor[model.materialRanges[r].materialId + 1];
+            for (size_t t = first; t < last; ++t) order[out++] = (uint32_t)t;
+        }
+    }
+
+    for (size_t b = 0; b < nBuckets; ++b)
+    {
+        if (bucketStart[b + 1] == bucketStart[b]) continue;
+        IndexedMesh::Submesh submesh;
+        submesh.indexOffset = bucketStart[b] * 3;
+        submesh.indexCount = (bucketStart[b + 1] - bucketStart[b]) * 3;
+        submesh.materialId = (int)b - 1;
+        mesh.submeshes.push_back(submesh);
+    }
+
+    // Tabela hash de endereçamento aberto (sondagem linear), com no máximo 50% de ocupação
+    size_t capacity = 16;
+    while (capacity < model.corners.size() * 2) capacity <<= 1;
+    const size_t mask = capacity - 1;
+    const uint32_t EMPTY = 0xFFFFFFFFu;
+    vector<uint32_t> table(capacity, EMPTY);
+    vector<ObjIndex> unique;
+    unique.reserve(model.corners.size() / 2);
+
+    for (uint32_t triangle : order)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const ObjIndex& corner = model.corners[triangle * 3 + k];
+            size_t slot = hashCorner(corner) & mask;
+            while (table[slot] != EMPTY && !sameCorner(unique[table[slot]], corner))
+            {
+                slot = (slot + 1) & mask;
+            }
+            if (table[slot] == EMPTY)
+            {
+                table[slot] = (uint32_t)unique.size();
+                unique.push_back(corner);
+            }
+            mesh.indices.push_back(table[slot]);
+        }
+    }
+
+    mesh.positions.reserve(unique.size() * 3);
+    mesh.texcoords.reserve(unique.size() * 2);
+    mesh.normals.reserve(unique.size() * 3);
+    for (const ObjIndex& corner : unique)
+    {
+        CornerAttributes attributes = fetchCorner(model, corner);
+        mesh.positions.insert(mesh.positions.end(), { attributes.position.x, attributes.position.y, attributes.position.z });
+        mesh.texcoords.insert(mesh.texcoords.end(), { attributes.texcoord.x, attributes.texcoord.y });
+        mesh.normals.insert(mesh.normals.end(), { attributes.normal.x, attributes.normal.y, attributes.normal.z });
+    }
+}
@@ -0,0 +1,389 @@
+#include "ObjStream.h"
+#include "ObjParse.h"
+#include "MeshCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+namespace
+{
+    // Lê o arquivo em janelas de tamanho fixo, sempre terminando em fim de linha.
+    // O trecho de linha que sobra no fim de uma janela vai para o início da próxima.
+    class WindowReader
+    {
+    public:
+        ~WindowReader() { if (file) fclose(file); }
+
+        bool open(const string& path, size_t windowSize)
+        {
+            file = fopen(path.c_str(), "rb");
+            buffer.resize(std::max<size_t>(windowSize, 4096));
+            used = 0;
+            consumed = 0;
+            return file != nullptr;
+        }
+
+        // Acumula em *hash o FNV-1a de todos os bytes lidos do arquivo
+        void hashInto(uint64_t* target) { hash = target; }
+
+        // Próxima janela [begin, end) com linhas completas
+        bool next(const char*& begin, const char*& end)
+        {
+            // Descarta o que já foi entregue e traz a sobra para o início
+            memmove(buffer.data(), buffer.data() + consumed, used - consumed);
+            used -= consumed;
+            consumed = 0;
+
+            const size_t carried = used;
+            for (;;)
+            {
+                if (used == buffer.size()) buffer.resize(buffer.size() * 2); // linha maior que a janela
+                const size_t count = fread(buffer.data() + used, 1, buffer.size() - used, file);
+                if (hash) *hash = hashBytes(buffer.data() + used, count, *hash);
+                used += count;
+
+                if (count == 0 || feof(file))
+                {
+                    consumed = used;
+                    break;
+                }
+                size_t last = used;
+                while (last > carried && buffer[last - 1] != '\n') --last;
+                if (last > 0 && buffer[last - 1] == '\n')
+                {
+                    consumed = last;
+                    break;
+                }
+            }
+            begin = buffer.data();
+            end = buffer.data() + consumed;
+            return used > 0;
+        }
+
+    private:
+        FILE* file = nullptr;
+        uint64_t* hash = nullptr;
+        vector<char> buffer;
+        size_t used = 0;     // bytes válidos no buffer
+        size_t consumed = 0; // bytes entregues na última janela
+    };
+
+    // Arquivos temporários com os atributos em binário, ao lado do .obj
+    struct AttributeFiles
+    {
+        string positionsPath;
+        string texcoordsPath;
+        string normalsPath;
+
+        explicit AttributeFiles(const string& objPath)
+            : positionsPath(objPath + ".v.tmp"), texcoordsPath(objPath + ".vt.tmp"), normalsPath(objPath + ".vn.tmp")
+        {
+        }
+
+        ~AttributeFiles()
+        {
+            std::error_code ec;
+            std::filesystem::remove(positionsPath, ec);
+            std::filesystem::remove(texcoordsPath, ec);
+            std::filesystem::remove(normalsPath, ec);
+        }
+    };
+
+    void writeVec3(const char* p, const char* end, std::ofstream& out)
+    {
+        glm::vec3 values;
+        p = parseFloat(p, end, values.x);
+        p = parseFloat(p, end, values.y);
+        parseFloat(p, end, values.z);
+        out.write((const char*)&values, sizeof(values));
+    }
+
+    // 1ª passada: copia v/vt/vn para os arquivos temporários e calcula o hash do .obj
+    bool extractAttributes(const string& path, size_t windowSize, const AttributeFiles& files, ObjStreamInfo& info)
+    {
+        WindowReader reader;
+        if (!reader.open(path, windowSize)) return false;
+
+        std::ofstream positions(files.positionsPath, std::ios::binary | std::ios::trunc);
+        std::ofstream texcoords(files.texcoordsPath, std::ios::binary | std::ios::trunc);
+        std::ofstream normals(files.normalsPath, std::ios::binary | std::ios::trunc);
+        if (!positions.is_open() || !texcoords.is_open() || !normals.is_open()) return false;
+
+        info.sourceHash = hashBytes(nullptr, 0);
+        reader.hashInto(&info.sourceHash);
+
+        const char* p;
+        const char* end;
+        while (reader.next(p, end))
+        {
+            while (p < end)
+            {
+                p = skipBlanks(p, end);
+                if (p >= end) break;
+
+                const char* body;
+                switch (classifyLine(p, end, body))
+                {
+                    case ObjLine::Position:
+                        writeVec3(body, end, positions);
+                        break;
+                    case ObjLine::Texcoord:
+                    {
+                        glm::vec2 values;
+                        const char* q = parseFloat(body, end, values.x);
+                        parseFloat(q, end, values.y);
+                        texcoords.write((const char*)&values, sizeof(values));
+                        break;
+                    }
+                    case ObjLine::Normal:
+                        writeVec3(body, end, normals);
+                        break;
+                    default:
+                        break;
+                }
+                p = nextLine(p, end);
+            }
+        }
+        return positions.good() && texcoords.good() && normals.good();
+    }
+
+    // Bloco em montagem: vértices soldados por tabela hash de tamanho fixo
+    class ChunkBuilder
+    {
+    public:
+        ChunkBuilder(size_t maxVertices, const MeshOptimizeOptions& optimize,
+                     const MappedFile& positions, const MappedFile& texcoords, const MappedFile& normals)
+            : maxVertices(maxVertices), maxIndices(maxVertices * 6), optimize(optimize),
+              positions((const glm::vec3*)positions.begin()), nPositions(positions.getSize() / sizeof(glm::vec3)),
+              texcoords((const glm::vec2*)texcoords.begin()), nTexcoords(texcoords.getSize() / sizeof(glm::vec2)),
+              normals((const glm::vec3*)normals.begin()), nNormals(normals.getSize() / sizeof(glm::vec3))
+        {
+            size_t tableSize = 1;
+            while (tableSize < maxVertices * 2) tableSize <<= 1;
+            table.assign(tableSize, EMPTY);
+            mask = tableSize - 1;
+
+            vertices.reserve(maxVertices);
+            unique.reserve(maxVertices);
+            indices.reserve(maxIndices);
+        }
+
+        const glm::vec3* positionData() const { return positions; }
+        size_t positionCount() const { return nPositions; }
+
+        // Verdadeiro se o bloco ainda comporta mais corners cantos sem ser enviado
+        bool fits(size_t corners) const
+        {
+            return vertices.size() + corners <= maxVertices && indices.size() + corners <= maxIndices;
+        }
+
+        // Verdadeiro se um bloco vazio comporta o polígono: um vértice por canto, e a tabela hash
+        // (2 * maxVertices) nunca enche
+        bool canHold(size_t polygonCorners, size_t triangleCorners) const
+        {
+            return polygonCorners <= maxVertices && triangleCorners <= maxIndices;
+        }
+
+        bool empty() const { return indices.empty(); }
+
+        void addTriangles(const vector<ObjIndex>& corners)
+        {
+            for (const ObjIndex& corner : corners)
+            {
+                size_t slot = hashCorner(corner) & mask;
+                while (table[slot] != EMPTY && !sameCorner(unique[table[slot]], corner))
+                {
+                    slot = (slot + 1) & mask;
+                }
+                if (table[slot] == EMPTY)
+                {
+                    table[slot] = (uint32_t)unique.size();
+                    unique.push_back(corner);
+                    vertices.push_back(makeVertex(corner));
+                }
+                indices.push_back(table[slot]);
+            }
+        }
+
+        bool flush(ObjStreamSink& sink, int materialId)
+        {
+            if (indices.empty()) return true;
+            if (optimize.enabled)
+            {
+                optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+                optimizeOverdraw(indices.data(), indices.size(), vertices[0].position, sizeof(MeshVertex) / sizeof(float),
+                                 vertices.size(), optimize.overdrawThreshold);
+                optimizeVertexFetch(indices.data(), indices.size(), vertices.size(), remap);
+                reordered.resize(vertices.size());
+                for (size_t v = 0; v < vertices.size(); ++v) reordered[remap[v]] = vertices[v];
+                vertices.swap(reordered);
+            }
+            bool ok = sink.consume(vertices.data(), (uint32_t)vertices.size(), indices.data(), (uint32_t)indices.size(), materialId);
+            std::fill(table.begin(), table.end(), EMPTY);
+            vertices.clear();
+            unique.clear();
+            indices.clear();
+            return ok;
+        }
+
+    private:
+        static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+        MeshVertex makeVertex(const ObjIndex& corner) const
+        {
+            glm::vec3 position = (corner.v >= 0 && (size_t)corner.v < nPositions) ? positions[corner.v] : glm::vec3(0.0f);
+            glm::vec2 texcoord = (corner.vt >= 0 && (size_t)corner.vt < nTexcoords) ? texcoords[corner.vt] : glm::vec2(0.0f);
+            glm::vec3 normal = (corner.vn >= 0 && (size_t)corner.vn < nNormals) ? normals[corner.vn] : glm::vec3(0.0f);
+
+            MeshVertex vertex;
+            vertex.position[0] = position.x;
+            vertex.position[1] = position.y;
+            vertex.position[2] = position.z;
+            vertex.texcoord[0] = texcoord.x;
+            vertex.texcoord[1] = 1.0f - texcoord.y; // Inverte V para o OpenGL
+            vertex.normal[0] = normal.x;
+            vertex.normal[1] = normal.y;
+            vertex.normal[2] = normal.z;
+            return vertex;
+        }
+
+        size_t maxVertices;
+        size_t maxIndices;
+        MeshOptimizeOptions optimize;
+        const glm::vec3* positions;
+        size_t nPositions;
+        const glm::vec2* texcoords;
+        size_t nTexcoords;
+        const glm::vec3* normals;
+        size_t nNormals;
+
+        vector<uint32_t> table;
+        size_t mask;
+        vector<ObjIndex> unique;
+        vector<MeshVertex> vertices;
+        vector<uint32_t> indices;
+        vector<uint32_t> remap;
+        vector<MeshVertex> reordered;
+    };
+}
+
+bool streamObj(const string& path, ObjStreamSink& sink, const ObjStreamOptions& options, ObjStreamInfo& info)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    info = ObjStreamInfo();
+
+    // Um quarto do orçamento para a janela de texto, o resto para o bloco.
+    // Cada vértice do bloco custa ~80 bytes (vértice, canto, tabela hash e ~6 índices),
+    // e mais ~100 bytes quando o bloco é otimizado (adjacência, pontuações e cópias).
+    const size_t windowSize = std::max<size_t>(options.memoryBudget / 4, 64u << 10);
+    const size_t bytesPerVertex = options.optimize.enabled ? 180 : 80;
+    const size_t maxVertices = std::min<size_t>(std::max<size_t>(options.memoryBudget * 3 / 4 / bytesPerVertex, 1024), 0x7FFFFFFF);
+
+    AttributeFiles files(path);
+    if (!extractAttributes(path, windowSize, files, info))
+    {
+        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    MappedFile positions, texcoords, normals;
+    WindowReader reader;
+    if (!positions.open(files.positionsPath) || !texcoords.open(files.texcoordsPath) ||
+        !normals.open(files.normalsPath) || !reader.open(path, windowSize))
+    {
+        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    // 2ª passada: faces
+    ChunkBuilder chunk(maxVertices, options.optimize, positions, texcoords, normals);
+    std::unordered_map<string, int> materialIds;
+    int currentMaterial = -1; // último usemtl lido
+    int chunkMaterial = -1;   // material do bloco em montagem
+    size_t chunkCount = 0;
+    AttributeCounts counts = { 0, 0, 0 };
+    vector<ObjIndex> polygon;
+    vector<ObjIndex> triangles;
+    TriangulationScratch scratch;
+
+    const char* p;
+    const char* end;
+    while (reader.next(p, end))
+    {
+        while (p < end)
+        {
+            p = skipBlanks(p, end);
+            if (p >= end) break;
+
+            const char* body;
+            switch (classifyLine(p, end, body))
+            {
+                case ObjLine::Position: ++counts.positions; break;
+                case ObjLine::Texcoord: ++counts.texcoords; break;
+                case ObjLine::Normal: ++counts.normals; break;
+                case ObjLine::Face:
+                {
+                    polygon.clear();
+                    const char* q = skipBlanks(body, end);
+                    while (q < end && *q != '\n')
+                    {
+                        ObjIndex corner;
+                        q = parseCorner(q, end, counts, corner);
+                        polygon.push_back(corner);
+                        q = skipBlanks(q, end);
+                    }
+                    if (polygon.size() < 3) break; // linha "f" incompleta
+
+                    triangles.clear();
+                    triangulatePolygon(polygon.data(), polygon.size(), chunk.positionData(), chunk.positionCount(), scratch, triangles);
+                    if (!chunk.canHold(polygon.size(), triangles.size()))
+                    {
+                        std::cerr << "OBJ face with " << polygon.size() << " corners does not fit in a chunk of "
+                                  << maxVertices << " vertices (memoryBudget too small): " << path << std::endl;
+                        return false;
+                    }
+
+                    // Bloco cheio ou troca de material: envia o que já está pronto
+                    if (!chunk.empty() && (currentMaterial != chunkMaterial || !chunk.fits(triangles.size())))
+                    {
+                        if (!chunk.flush(sink, chunkMaterial)) return false;
+                        ++chunkCount;
+                    }
+                    chunkMaterial = currentMaterial;
+                    chunk.addTriangles(triangles);
+                    info.triangleCount += triangles.size() / 3;
+                    break;
+                }
+                case ObjLine::MtlLib:
+                    info.mtlLib = restOfLine(body, end);
+                    break;
+                case ObjLine::UseMtl:
+                {
+                    auto found = materialIds.emplace(restOfLine(body, end), (int)info.materialNames.size());
+                    if (found.second) info.materialNames.push_back(found.first->first);
+                    currentMaterial = found.first->second;
+                    break;
+                }
+                default:
+                    break;
+            }
+            p = nextLine(p, end);
+        }
+    }
+    if (!chunk.empty())
+    {
+        if (!chunk.flush(sink, chunkMaterial)) return false;
+        ++chunkCount;
+    }
+
+    info.chunkCount = chunkCount;
+    info.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
@@ -0,0 +1,355 @@
+#include "ShaderCache.h"
+#include "FileHash.h"
+
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+
+// Constantes de GL_ARB_get_program_binary (OpenGL 4.1), ausentes na glad 4.0
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+// GL_KHR_parallel_shader_compile (o ARB usa os mesmos valores)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace
+{
+    typedef void (APIENTRY* GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+    typedef void (APIENTRY* ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+    typedef void (APIENTRY* ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+    typedef void (APIENTRY* MaxShaderCompilerThreadsProc)(GLuint count);
+
+    const char SHADER_MAGIC[4] = { 'V', 'S', 'B', '1' };
+
+    string cacheDirectory = "shadercache";
+    bool cacheEnabled = true;
+    ShaderCacheStats stats;
+    std::mutex statsLock; // ShaderWatcher compila numa thread própria
+
+    struct BinaryApi
+    {
+        bool checked = false;
+        bool available = false;
+        GetProgramBinaryProc getProgramBinary = nullptr;
+        ProgramBinaryProc programBinary = nullptr;
+        ProgramParameteriProc programParameteri = nullptr;
+        bool parallel = false;
+        uint64_t driverHash = 0xcbf29ce484222325ull;
+    };
+
+    bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (extension && strcmp(extension, name) == 0) return true;
+        }
+        return false;
+    }
+
+    BinaryApi& binaryApi()
+    {
+        static BinaryApi api;
+        if (api.checked) return api;
+        api.checked = true;
+
+        api.getProgramBinary = (GetProgramBinaryProc)glfwGetProcAddress("glGetProgramBinary");
+        api.programBinary = (ProgramBinaryProc)glfwGetProcAddress("glProgramBinary");
+        api.programParameteri = (ProgramParameteriProc)glfwGetProcAddress("glProgramParameteri");
+        GLint formats = 0;
+        if (api.getProgramBinary && api.programBinary && api.programParameteri)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        api.available = formats > 0;
+
+        // Binários só valem para o mesmo driver
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        {
+            const char* value = (const char*)glGetString(name);
+            if (value) api.driverHash = hashBytes(value, strlen(value), api.driverHash);
+        }
+        if (!api.available) std::cout << "Shader cache: program binaries not supported, compiling every run" << std::endl;
+
+        // Compilação paralela: 0xFFFFFFFF deixa o driver escolher quantas threads usar
+        MaxShaderCompilerThreadsProc maxThreads = nullptr;
+        if (hasExtension("GL_KHR_parallel_shader_compile"))
+            maxThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+        else if (hasExtension("GL_ARB_parallel_shader_compile"))
+            maxThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+        if (maxThreads)
+        {
+            maxThreads(0xFFFFFFFFu);
+            api.parallel = true;
+        }
+        return api;
+    }
+
+    string binaryPath(uint64_t key)
+    {
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+        return (std::filesystem::path(cacheDirectory) / name.str()).string();
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    GLuint submitStage(GLenum type, const string& source)
+    {
+        const GLchar* code = source.c_str();
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    // Log de compilação do estágio, se ele falhou
+    bool reportStage(GLuint shader, const char* stageName, const string& label)
+    {
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (success) return true;
+        GLchar infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED " << label << "\n" << infoLog << std::endl;
+        return false;
+    }
+
+    // Programa criado com o binário do cache (status ainda não consultado), ou 0 sem binário válido
+    GLuint submitBinary(const string& path, uint64_t key)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return 0;
+        ShaderBinaryHeader header;
+        if (!in.read((char*)&header, sizeof(header))) return 0;
+        if (memcmp(header.magic, SHADER_MAGIC, 4) != 0 || header.version != SHADER_CACHE_VERSION || header.key != key) return 0;
+        vector<char> binary(header.binaryLength);
+        if (!in.read(binary.data(), binary.size())) return 0;
+
+        GLuint program = glCreateProgram();
+        binaryApi().programBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+        return program;
+    }
+
+    void saveBinary(const string& path, uint64_t key, GLuint program)
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        vector<char> binary(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        binaryApi().getProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0) return;
+
+        ShaderBinaryHeader header = {};
+        memcpy(header.magic, SHADER_MAGIC, 4);
+        header.version = SHADER_CACHE_VERSION;
+        header.key = key;
+        header.binaryFormat = format;
+        header.binaryLength = (uint32_t)written;
+
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDirectory, ec);
+        const string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return;
+            out.write((const char*)&header, sizeof(header));
+            out.write(binary.data(), written);
+            if (!out.good()) return;
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) std::filesystem::remove(tmpPath, ec);
+    }
+}
+
+void setShaderCacheDirectory(const string& directory)
+{
+    cacheDirectory = directory;
+}
+
+void setShaderCacheEnabled(bool enabled)
+{
+    cacheEnabled = enabled;
+}
+
+string injectDefines(const string& source, const string& defines)
+{
+    if (defines.empty()) return source;
+    string block = defines;
+    if (block.back() != '\n') block += '\n';
+
+    // #version tem que ser a primeira diretiva; sem ela os defines vão para o início
+    const size_t version = source.find("#version");
+    if (version == string::npos) return block + source;
+    const size_t lineEnd = source.find('\n', version);
+    if (lineEnd == string::npos) return source + "\n" + block;
+    return source.substr(0, lineEnd + 1) + block + source.substr(lineEnd + 1);
+}
+
+GLuint buildProgram(const string& vertexSource, const string& fragmentSource, const string& defines, const string& label)
+{
+    ShaderBatch batch;
+    return batch.get(batch.submit(vertexSource, fragmentSource, defines, label));
+}
+
+bool parallelShaderCompileAvailable()
+{
+    return binaryApi().parallel;
+}
+
+int ShaderBatch::submit(const string& vertexSource, const string& fragmentSource, const string& defines, const string& label)
+{
+    auto start = std::chrono::steady_clock::now();
+    Job job;
+    job.label = label;
+    job.vertexSource = injectDefines(vertexSource, defines);
+    job.fragmentSource = injectDefines(fragmentSource, defines);
+
+    if (cacheEnabled && binaryApi().available)
+    {
+        job.key = hashBytes(job.vertexSource.data(), job.vertexSource.size(), binaryApi().driverHash);
+        job.key = hashBytes("\0", 1, job.key); // separa as duas fontes
+        job.key = hashBytes(job.fragmentSource.data(), job.fragmentSource.size(), job.key);
+        job.path = binaryPath(job.key);
+        job.program = submitBinary(job.path, job.key);
+        job.fromBinary = job.program != 0;
+    }
+    if (!job.fromBinary) startCompile(job);
+
+    job.ms = elapsedMs(start);
+    jobs.push_back(std::move(job));
+    return (int)jobs.size() - 1;
+}
+
+int ShaderBatch::submitFiles(const string& vertexPath, const string& fragmentPath, const string& defines)
+{
+    auto read = [](const string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    };
+    return submit(read(vertexPath), read(fragmentPath), defines, vertexPath + " + " + fragmentPath);
+}
+
+void ShaderBatch::startCompile(Job& job)
+{
+    // Nenhuma consulta de status aqui: o driver pode seguir compilando enquanto o próximo
+    // programa é submetido
+    job.vertex = submitStage(GL_VERTEX_SHADER, job.vertexSource);
+    job.fragment = submitStage(GL_FRAGMENT_SHADER, job.fragmentSource);
+    job.program = glCreateProgram();
+    if (!job.path.empty()) binaryApi().programParameteri(job.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(job.program, job.vertex);
+    glAttachShader(job.program, job.fragment);
+    glLinkProgram(job.program);
+}
+
+bool ShaderBatch::isReady(int index) const
+{
+    const Job& job = jobs[index];
+    if (job.finished || !binaryApi().parallel) return true;
+    GLint done = GL_TRUE;
+    glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+void ShaderBatch::finish(Job& job)
+{
+    auto start = std::chrono::steady_clock::now();
+    GLint success = 0;
+    if (job.fromBinary)
+    {
+        glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+        if (success)
+        {
+            job.ms += elapsedMs(start);
+            {
+                std::lock_guard<std::mutex> guard(statsLock);
+                ++stats.hits;
+                stats.loadMs += job.ms;
+            }
+            return;
+        }
+        // Binário recusado (driver atualizado, outro formato): compila do zero
+        glDeleteProgram(job.program);
+        {
+            std::lock_guard<std::mutex> guard(statsLock);
+            ++stats.rejected;
+        }
+        job.fromBinary = false;
+        startCompile(job);
+    }
+
+    glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // Os logs de compilação explicam a maioria das falhas; o de link só vale se os dois compilaram
+        const bool vertexOk = reportStage(job.vertex, "VERTEX", job.label);
+        const bool fragmentOk = reportStage(job.fragment, "FRAGMENT", job.label);
+        if (vertexOk && fragmentOk)
+        {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(job.program, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED " << job.label << "\n" << infoLog << std::endl;
+        }
+        glDeleteProgram(job.program);
+        job.program = 0;
+    }
+    else if (!job.path.empty())
+    {
+        saveBinary(job.path, job.key, job.program);
+    }
+    glDeleteShader(job.vertex);
+    glDeleteShader(job.fragment);
+    job.vertex = job.fragment = 0;
+
+    job.ms += elapsedMs(start);
+    {
+        std::lock_guard<std::mutex> guard(statsLock);
+        ++stats.misses;
+        stats.compileMs += job.ms;
+    }
+}
+
+GLuint ShaderBatch::get(int index)
+{
+    Job& job = jobs[index];
+    if (!job.finished)
+    {
+        finish(job);
+        job.finished = true;
+        job.vertexSource.clear();
+        job.fragmentSource.clear();
+    }
+    return job.program;
+}
+
+ShaderCacheStats getShaderCacheStats()
+{
+    std::lock_guard<std::mutex> guard(statsLock);
+    return stats;
+}
@@ -0,0 +1,81 @@
+#include "ShaderVariants.h"
+
+#include <algorithm>
+
+string ShaderFeatures::defines() const
+{
+    string result;
+    result += "#define NUM_POINT_LIGHTS " + to_string(std::max(0, std::min(numPointLights, MAX_POINT_LIGHTS))) + "\n";
+    result += string("#define HAS_DIFFUSE_MAP ") + (hasDiffuseMap ? "1" : "0") + "\n";
+    result += string("#define HAS_SPECULAR ") + (hasSpecular ? "1" : "0") + "\n";
+    result += string("#define QUANTIZED_NORMALS ") + (quantizedNormals ? "1" : "0") + "\n";
+    result += string("#define INSTANCED ") + (instanced ? "1" : "0") + "\n";
+    result += "#define TEXTURE_SOURCE " + to_string((uint32_t)textureSource) + "\n";
+    return result;
+}
+
+uint32_t ShaderFeatures::key() const
+{
+    uint32_t key = (uint32_t)std::max(0, std::min(numPointLights, MAX_POINT_LIGHTS));
+    if (hasDiffuseMap) key |= 1u << 8;
+    if (hasSpecular) key |= 1u << 9;
+    if (quantizedNormals) key |= 1u << 10;
+    if (instanced) key |= 1u << 11;
+    key |= ((uint32_t)textureSource & 3u) << 12;
+    return key;
+}
+
+bool materialHasSpecular(const Material& material)
+{
+    return material.illum >= 2 && (material.Ks.r > 0.0f || material.Ks.g > 0.0f || material.Ks.b > 0.0f);
+}
+
+ShaderVariants::ShaderVariants(const string& vertexPath, const string& fragmentPath)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath)
+{
+}
+
+void ShaderVariants::prepare(const vector<ShaderFeatures>& features)
+{
+    shared_ptr<ShaderBatch> batch = make_shared<ShaderBatch>();
+    for (const ShaderFeatures& f : features)
+    {
+        const uint32_t key = f.key();
+        if (variants.count(key) || pending.count(key)) continue;
+        PendingVariant& variant = pending[key];
+        variant.batch = batch;
+        variant.program = batch->submitFiles(vertexPath, fragmentPath, f.defines());
+    }
+}
+
+Shader& ShaderVariants::get(const ShaderFeatures& features)
+{
+    const uint32_t key = features.key();
+    auto it = variants.find(key);
+    if (it != variants.end()) return *it->second;
+
+    auto submitted = pending.find(key);
+    if (submitted != pending.end())
+    {
+        // Primeiro uso de uma variante de prepare(): só aqui o status é consultado
+        const PendingVariant variant = submitted->second;
+        pending.erase(submitted);
+        return add(features, unique_ptr<Shader>(new Shader(*variant.batch, variant.program)));
+    }
+    return add(features, unique_ptr<Shader>(new Shader(vertexPath.c_str(), fragmentPath.c_str(), features.defines())));
+}
+
+Shader& ShaderVariants::add(const ShaderFeatures& features, unique_ptr<Shader> shader)
+{
+    Shader& variant = *shader;
+    variants[features.key()] = std::move(shader);
+    if (variant.ID)
+    {
+        bindUniformBlocks(variant.ID);
+        glUseProgram(variant.ID);
+        if (onCreate) onCreate(variant);
+    }
+    // Mesmo uma variante que não compilou é observada: a próxima gravação pode corrigi-la
+    if (watcher) watcher->add(variant, vertexPath, fragmentPath, features.defines(), onCreate);
+    return variant;
+}
@@ -0,0 +1,222 @@
+#include "ShaderWatcher.h"
+#include "ShaderCache.h"
+#include "UniformBlocks.h"
+
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    string absolutePath(const string& path)
+    {
+        std::error_code ec;
+        std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+        return (ec ? std::filesystem::path(path) : absolute).lexically_normal().string();
+    }
+}
+
+bool ShaderWatcher::start(GLFWwindow* window)
+{
+#ifdef __linux__
+    if (isRunning()) return true;
+
+    // Funções de binário e compilação paralela resolvidas aqui, antes da thread usá-las
+    parallelShaderCompileAvailable();
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        std::cout << "ShaderWatcher: inotify_init1 failed, hot reload disabled" << std::endl;
+        return false;
+    }
+
+    // Mesmas dicas de contexto da janela (versão, perfil), só que invisível
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context = glfwCreateWindow(1, 1, "shader reload", nullptr, window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!context)
+    {
+        std::cout << "ShaderWatcher: could not create a shared context, hot reload disabled" << std::endl;
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        for (const Entry& entry : entries)
+        {
+            addWatch(entry.vertexPath);
+            addWatch(entry.fragmentPath);
+        }
+    }
+    stopping = false;
+    worker = thread(&ShaderWatcher::watch, this);
+    return true;
+#else
+    std::cout << "ShaderWatcher: hot reload needs inotify (Linux only)" << std::endl;
+    return false;
+#endif
+}
+
+void ShaderWatcher::stop()
+{
+    if (worker.joinable())
+    {
+        stopping = true;
+        worker.join();
+    }
+#ifdef __linux__
+    if (inotifyFd >= 0) close(inotifyFd);
+#endif
+    inotifyFd = -1;
+    watches.clear();
+    if (context) glfwDestroyWindow(context);
+    context = nullptr;
+
+    // Programas compilados que não chegaram a ser trocados
+    for (const Result& result : ready) glDeleteProgram(result.program);
+    ready.clear();
+}
+
+void ShaderWatcher::add(Shader& shader, const string& vertexPath, const string& fragmentPath, const string& defines, function<void(Shader&)> onReload)
+{
+    Entry entry;
+    entry.shader = &shader;
+    entry.vertexPath = absolutePath(vertexPath);
+    entry.fragmentPath = absolutePath(fragmentPath);
+    entry.defines = defines;
+    entry.onReload = onReload;
+
+    lock_guard<mutex> guard(lock);
+    if (inotifyFd >= 0)
+    {
+        addWatch(entry.vertexPath);
+        addWatch(entry.fragmentPath);
+    }
+    entries.push_back(entry);
+}
+
+void ShaderWatcher::addWatch(const string& path)
+{
+#ifdef __linux__
+    // A pasta, e não o arquivo: editores que salvam num temporário e renomeiam trocam o inode
+    const string directory = std::filesystem::path(path).parent_path().string();
+    for (const auto& watched : watches)
+    {
+        if (watched.second == directory) return;
+    }
+    const int descriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (descriptor < 0)
+    {
+        std::cout << "ShaderWatcher: cannot watch " << directory << std::endl;
+        return;
+    }
+    watches.push_back({ descriptor, directory });
+#endif
+}
+
+int ShaderWatcher::update()
+{
+    vector<Result> swaps;
+    {
+        lock_guard<mutex> guard(lock);
+        if (ready.empty()) return 0;
+        swaps.swap(ready);
+    }
+
+    for (const Result& result : swaps)
+    {
+        Entry& entry = entries[result.entry];
+        glDeleteProgram(entry.shader->ID);
+        entry.shader->ID = result.program;
+        entry.shader->reflectUniforms();
+        bindUniformBlocks(result.program);
+        glUseProgram(result.program);
+        if (entry.onReload) entry.onReload(*entry.shader);
+    }
+    return (int)swaps.size();
+}
+
+void ShaderWatcher::watch()
+{
+#ifdef __linux__
+    glfwMakeContextCurrent(context);
+
+    alignas(inotify_event) char buffer[4096];
+    pollfd descriptor = { inotifyFd, POLLIN, 0 };
+    while (!stopping)
+    {
+        if (poll(&descriptor, 1, 100) <= 0) continue;
+
+        // Uma gravação gera vários eventos (e alguns editores gravam em etapas): junta os que
+        // chegam em sequência e recompila uma vez só
+        vector<string> changed;
+        do
+        {
+            const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const inotify_event* event = (const inotify_event*)(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+                if (event->len == 0) continue;
+
+                lock_guard<mutex> guard(lock);
+                for (const auto& watched : watches)
+                {
+                    if (watched.first != event->wd) continue;
+                    const string path = (std::filesystem::path(watched.second) / event->name).lexically_normal().string();
+                    if (find(changed.begin(), changed.end(), path) == changed.end()) changed.push_back(path);
+                }
+            }
+        } while (!stopping && poll(&descriptor, 1, 50) > 0);
+
+        if (!changed.empty()) rebuild(changed);
+    }
+
+    glfwMakeContextCurrent(nullptr);
+#endif
+}
+
+void ShaderWatcher::rebuild(const vector<string>& changed)
+{
+    vector<pair<size_t, Entry>> targets;
+    {
+        lock_guard<mutex> guard(lock);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const Entry& entry = entries[i];
+            const bool vertexChanged = find(changed.begin(), changed.end(), entry.vertexPath) != changed.end();
+            const bool fragmentChanged = find(changed.begin(), changed.end(), entry.fragmentPath) != changed.end();
+            if (vertexChanged || fragmentChanged) targets.push_back({ i, entry });
+        }
+    }
+    if (targets.empty()) return;
+
+    // Todas as variantes de uma vez, para o driver compilar em paralelo
+    ShaderBatch batch;
+    for (const auto& target : targets)
+        batch.submitFiles(target.second.vertexPath, target.second.fragmentPath, target.second.defines);
+
+    vector<Result> results;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        const GLuint program = batch.get((int)i);
+        if (program) results.push_back({ targets[i].first, program });
+        else std::cout << "ShaderWatcher: keeping the previous program" << std::endl;
+    }
+    // O outro contexto só pode usar os programas depois que este terminar de criá-los
+    glFinish();
+
+    lock_guard<mutex> guard(lock);
+    ready.insert(ready.end(), results.begin(), results.end());
+}
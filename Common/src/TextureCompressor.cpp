@@ -0,0 +1,502 @@
+#include "TextureCompressor.h"
+#include "FileHash.h"
+
+#include "stb_image.h"
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+    const char TEXTURE_CACHE_MAGIC[4] = { 'V', 'B', 'T', '1' };
+
+    // Peso de cada extremo (color0) para os índices 0..3 do modo de 4 cores
+    const float BC1_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    inline uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    inline int clampInt(int value, int low, int high)
+    {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    inline uint16_t packRgb565(const float color[3])
+    {
+        const int r = clampInt((int)std::lround(color[0] * 31.0f / 255.0f), 0, 31);
+        const int g = clampInt((int)std::lround(color[1] * 63.0f / 255.0f), 0, 63);
+        const int b = clampInt((int)std::lround(color[2] * 31.0f / 255.0f), 0, 31);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    inline void unpackRgb565(uint16_t value, int color[3])
+    {
+        const int r = value >> 11, g = (value >> 5) & 63, b = value & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Paleta do modo de 4 cores (color0 > color1; no BC3 o modo é sempre este)
+    void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3])
+    {
+        unpackRgb565(c0, palette[0]);
+        unpackRgb565(c1, palette[1]);
+        for (int k = 0; k < 3; ++k)
+        {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        }
+    }
+
+    // Escolhe o índice mais próximo para cada pixel; devolve o erro quadrático total
+    uint32_t fitIndices(const uint8_t rgba[64], uint16_t c0, uint16_t c1, uint8_t indices[16])
+    {
+        int palette[4][3];
+        bc1Palette(c0, c1, palette);
+        uint32_t total = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            const uint8_t* pixel = rgba + i * 4;
+            uint32_t best = 0xFFFFFFFFu;
+            for (int p = 0; p < 4; ++p)
+            {
+                const int dr = pixel[0] - palette[p][0], dg = pixel[1] - palette[p][1], db = pixel[2] - palette[p][2];
+                const uint32_t error = (uint32_t)(dr * dr + dg * dg + db * db);
+                if (error < best)
+                {
+                    best = error;
+                    indices[i] = (uint8_t)p;
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    // Extremos por mínimos quadrados para os índices atuais
+    bool refineEndpoints(const uint8_t rgba[64], const uint8_t indices[16], float end0[3], float end1[3])
+    {
+        float aa = 0, bb = 0, ab = 0, ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; ++i)
+        {
+            const float a = BC1_WEIGHTS[indices[i]], b = 1.0f - a;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (int k = 0; k < 3; ++k)
+            {
+                ax[k] += a * rgba[i * 4 + k];
+                bx[k] += b * rgba[i * 4 + k];
+            }
+        }
+        const float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f) return false;
+        for (int k = 0; k < 3; ++k)
+        {
+            end0[k] = (ax[k] * bb - bx[k] * ab) / det;
+            end1[k] = (bx[k] * aa - ax[k] * ab) / det;
+        }
+        return true;
+    }
+
+    void writeColorBlock(uint16_t c0, uint16_t c1, const uint8_t indices[16], uint8_t out[8])
+    {
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; ++i) bits |= (uint32_t)indices[i] << (2 * i);
+        out[0] = (uint8_t)(c0 & 0xFF);
+        out[1] = (uint8_t)(c0 >> 8);
+        out[2] = (uint8_t)(c1 & 0xFF);
+        out[3] = (uint8_t)(c1 >> 8);
+        memcpy(out + 4, &bits, 4);
+    }
+
+    // Parte de cor do BC1/BC3: eixo principal das cores, extremos nas projeções mínima e
+    // máxima e duas rodadas de ajuste por mínimos quadrados
+    void compressColor(const uint8_t rgba[64], uint8_t out[8])
+    {
+        float mean[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; ++i)
+            for (int k = 0; k < 3; ++k) mean[k] += rgba[i * 4 + k] / 16.0f;
+
+        float cov[6] = { 0, 0, 0, 0, 0, 0 }; // rr rg rb gg gb bb
+        for (int i = 0; i < 16; ++i)
+        {
+            const float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+
+        // Iteração de potência a partir da diagonal da caixa das cores
+        float axis[3] = { 1, 1, 1 };
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+            const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+            const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+            const float length = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+            if (length <= 0.0f) break;
+            axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+        }
+
+        float minProjection = 1e30f, maxProjection = -1e30f;
+        for (int i = 0; i < 16; ++i)
+        {
+            const float t = (rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2];
+            minProjection = std::min(minProjection, t);
+            maxProjection = std::max(maxProjection, t);
+        }
+        const float axisLength2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        float end0[3], end1[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            end0[k] = mean[k] + axis[k] * maxProjection / std::max(axisLength2, 1e-12f);
+            end1[k] = mean[k] + axis[k] * minProjection / std::max(axisLength2, 1e-12f);
+        }
+
+        uint16_t c0 = packRgb565(end0), c1 = packRgb565(end1);
+        uint8_t indices[16], trial[16];
+        uint32_t error = fitIndices(rgba, c0, c1, indices);
+        for (int iteration = 0; iteration < 2 && error > 0; ++iteration)
+        {
+            if (!refineEndpoints(rgba, indices, end0, end1)) break;
+            const uint16_t t0 = packRgb565(end0), t1 = packRgb565(end1);
+            const uint32_t trialError = fitIndices(rgba, t0, t1, trial);
+            if (trialError >= error) break;
+            c0 = t0;
+            c1 = t1;
+            error = trialError;
+            memcpy(indices, trial, 16);
+        }
+
+        // Modo de 4 cores exige color0 > color1: troca os extremos e os índices correspondentes
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            for (int i = 0; i < 16; ++i) indices[i] ^= 1; // 0<->1, 2<->3
+        }
+        else if (c0 == c1)
+        {
+            memset(indices, 0, 16);
+        }
+        writeColorBlock(c0, c1, indices, out);
+    }
+
+    // Alfa do BC3: extremos no mínimo e no máximo do bloco, 8 valores interpolados
+    void compressAlpha(const uint8_t rgba[64], uint8_t out[8])
+    {
+        int low = 255, high = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            low = std::min(low, (int)rgba[i * 4 + 3]);
+            high = std::max(high, (int)rgba[i * 4 + 3]);
+        }
+        out[0] = (uint8_t)high;
+        out[1] = (uint8_t)low;
+
+        int palette[8] = { high, low };
+        for (int p = 2; p < 8; ++p) palette[p] = ((8 - p) * high + (p - 1) * low) / 7;
+
+        uint64_t bits = 0;
+        if (high != low)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                const int alpha = rgba[i * 4 + 3];
+                int best = 0;
+                for (int p = 1; p < 8; ++p)
+                {
+                    if (std::abs(alpha - palette[p]) < std::abs(alpha - palette[best])) best = p;
+                }
+                bits |= (uint64_t)best << (3 * i);
+            }
+        }
+        for (int b = 0; b < 6; ++b) out[2 + b] = (uint8_t)(bits >> (8 * b));
+    }
+
+    void decompressColor(const uint8_t block[8], uint8_t rgba[64], bool alwaysFourColors)
+    {
+        const uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+        const uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+        uint32_t bits;
+        memcpy(&bits, block + 4, 4);
+
+        int palette[4][3];
+        int alpha[4] = { 255, 255, 255, 255 };
+        bc1Palette(c0, c1, palette);
+        if (c0 <= c1 && !alwaysFourColors)
+        {
+            // Modo de 3 cores + transparente
+            for (int k = 0; k < 3; ++k)
+            {
+                palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+                palette[3][k] = 0;
+            }
+            alpha[3] = 0;
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            const int index = (bits >> (2 * i)) & 3;
+            for (int k = 0; k < 3; ++k) rgba[i * 4 + k] = (uint8_t)palette[index][k];
+            rgba[i * 4 + 3] = (uint8_t)alpha[index];
+        }
+    }
+
+    // Pixel (x, y) com as bordas repetidas
+    inline const uint8_t* clampedPixel(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y)
+    {
+        return rgba + ((size_t)std::min(y, height - 1) * width + std::min(x, width - 1)) * 4;
+    }
+
+    void gatherBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t block[64])
+    {
+        for (uint32_t y = 0; y < 4; ++y)
+            for (uint32_t x = 0; x < 4; ++x) memcpy(block + (y * 4 + x) * 4, clampedPixel(rgba, width, height, blockX * 4 + x, blockY * 4 + y), 4);
+    }
+
+    // Confere o cabeçalho e a tabela de níveis e preenche texture a partir da imagem do arquivo
+    bool bindImage(const unsigned char* data, size_t size, CompressedTexture& texture, TextureCacheHeader& header)
+    {
+        if (size < sizeof(TextureCacheHeader)) return false;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, TEXTURE_CACHE_MAGIC, 4) != 0 || header.version != TEXTURE_CACHE_VERSION) return false;
+        if (header.levelCount == 0 || header.levelCount > TEXTURE_MAX_LEVELS) return false;
+        if (header.format != TEXTURE_RGBA8 && header.format != TEXTURE_BC1 && header.format != TEXTURE_BC3) return false;
+        for (uint32_t level = 0; level < header.levelCount; ++level)
+        {
+            if (header.levels[level].offset + header.levels[level].size > size) return false;
+        }
+
+        texture.format = header.format;
+        texture.width = header.width;
+        texture.height = header.height;
+        texture.levels.assign(header.levels, header.levels + header.levelCount);
+        texture.data = data;
+        texture.dataSize = size;
+        return true;
+    }
+
+    // Nome temporário único: threads diferentes podem estar gerando o mesmo .vbt
+    bool writeFile(const string& path, const vector<unsigned char>& image)
+    {
+        static std::atomic<unsigned> counter{ 0 };
+        const string tmpPath = path + "." + std::to_string(counter++) + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            out.write((const char*)image.data(), image.size());
+            if (!out.good()) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) std::filesystem::remove(tmpPath, ec);
+        return !ec;
+    }
+}
+
+void compressBlockBC1(const uint8_t rgba[64], uint8_t out[8])
+{
+    compressColor(rgba, out);
+}
+
+void compressBlockBC3(const uint8_t rgba[64], uint8_t out[16])
+{
+    compressAlpha(rgba, out);
+    compressColor(rgba, out + 8);
+}
+
+void decompressBlockBC1(const uint8_t block[8], uint8_t rgba[64])
+{
+    decompressColor(block, rgba, false);
+}
+
+void decompressBlockBC3(const uint8_t block[16], uint8_t rgba[64])
+{
+    decompressColor(block + 8, rgba, true);
+
+    int palette[8] = { block[0], block[1] };
+    if (palette[0] > palette[1])
+    {
+        for (int p = 2; p < 8; ++p) palette[p] = ((8 - p) * palette[0] + (p - 1) * palette[1]) / 7;
+    }
+    else
+    {
+        for (int p = 2; p < 6; ++p) palette[p] = ((6 - p) * palette[0] + (p - 1) * palette[1]) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int b = 0; b < 6; ++b) bits |= (uint64_t)block[2 + b] << (8 * b);
+    for (int i = 0; i < 16; ++i) rgba[i * 4 + 3] = (uint8_t)palette[(bits >> (3 * i)) & 7];
+}
+
+void compressImage(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t format, vector<uint8_t>& out)
+{
+    const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const size_t blockBytes = textureBlockBytes(format);
+    out.resize((size_t)blocksX * blocksY * blockBytes);
+
+    uint8_t block[64];
+    for (uint32_t by = 0; by < blocksY; ++by)
+    {
+        for (uint32_t bx = 0; bx < blocksX; ++bx)
+        {
+            gatherBlock(rgba, width, height, bx, by, block);
+            uint8_t* target = out.data() + ((size_t)by * blocksX + bx) * blockBytes;
+            if (format == TEXTURE_BC1) compressBlockBC1(block, target);
+            else compressBlockBC3(block, target);
+        }
+    }
+}
+
+double compressionPsnr(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t format, const uint8_t* blocks)
+{
+    const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const size_t blockBytes = textureBlockBytes(format);
+    const int channels = format == TEXTURE_BC3 ? 4 : 3;
+
+    double squaredError = 0.0;
+    uint8_t decoded[64];
+    for (uint32_t by = 0; by < blocksY; ++by)
+    {
+        for (uint32_t bx = 0; bx < blocksX; ++bx)
+        {
+            const uint8_t* block = blocks + ((size_t)by * blocksX + bx) * blockBytes;
+            if (format == TEXTURE_BC1) decompressBlockBC1(block, decoded);
+            else decompressBlockBC3(block, decoded);
+
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+            {
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                {
+                    const uint8_t* original = rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4;
+                    for (int k = 0; k < channels; ++k)
+                    {
+                        const double difference = (double)original[k] - decoded[(y * 4 + x) * 4 + k];
+                        squaredError += difference * difference;
+                    }
+                }
+            }
+        }
+    }
+    const double mse = squaredError / ((double)width * height * channels);
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+string textureCachePath(const string& imagePath)
+{
+    return imagePath + ".vbt";
+}
+
+bool loadCompressedTexture(const string& imagePath, CompressedTexture& texture, bool compress)
+{
+    auto start = std::chrono::steady_clock::now();
+    const string cachePath = textureCachePath(imagePath);
+
+    texture.file.close();
+    texture.storage.clear();
+    texture.fromCache = false;
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!sourceInfo(imagePath, sourceSize, sourceTime)) return false;
+
+    TextureCacheHeader header;
+    auto matches = [&]()
+    {
+        return texture.file.open(cachePath) &&
+               bindImage((const unsigned char*)texture.file.begin(), texture.file.getSize(), texture, header) &&
+               header.sourceSize == sourceSize && (header.sourceTime == sourceTime || header.sourceHash == hashFile(imagePath)) &&
+               (header.format != TEXTURE_RGBA8) == compress;
+    };
+    bool found = matches();
+    if (found && header.sourceTime != sourceTime)
+    {
+        // Aceito pelo hash: grava a data nova e mapeia de novo
+        texture.file.close();
+        refreshSourceTime(cachePath, offsetof(TextureCacheHeader, sourceTime), sourceTime);
+        found = matches();
+    }
+    if (found)
+    {
+        texture.fromCache = true;
+        return true;
+    }
+    texture.file.close();
+
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+    if (!pixels) return false;
+
+    bool opaque = true;
+    for (size_t i = 0; i < (size_t)width * height && opaque; ++i) opaque = pixels[i * 4 + 3] == 255;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TEXTURE_CACHE_MAGIC, 4);
+    header.version = TEXTURE_CACHE_VERSION;
+    header.sourceHash = hashFile(imagePath);
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+    header.format = !compress ? TEXTURE_RGBA8 : (opaque ? TEXTURE_BC1 : TEXTURE_BC3);
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+
+    // Cadeia de mipmaps até 1x1, cada nível (comprimido ou não) acrescentado depois do cabeçalho
+    texture.storage.assign(alignUp(sizeof(TextureCacheHeader), 16), 0);
+    vector<uint8_t> level(pixels, pixels + (size_t)width * height * 4), next, blocks;
+    stbi_image_free(pixels);
+    uint32_t levelWidth = header.width, levelHeight = header.height;
+    double psnr = 0.0, mipMs = 0.0;
+    while (header.levelCount < TEXTURE_MAX_LEVELS)
+    {
+        if (header.format == TEXTURE_RGBA8)
+        {
+            blocks = level;
+        }
+        else
+        {
+            compressImage(level.data(), levelWidth, levelHeight, header.format, blocks);
+            if (header.levelCount == 0) psnr = compressionPsnr(level.data(), levelWidth, levelHeight, header.format, blocks.data());
+        }
+
+        TextureCacheLevel& entry = header.levels[header.levelCount++];
+        entry.offset = texture.storage.size();
+        entry.size = (uint32_t)blocks.size();
+        entry.width = levelWidth;
+        entry.height = levelHeight;
+        texture.storage.insert(texture.storage.end(), blocks.begin(), blocks.end());
+        texture.storage.resize(alignUp(texture.storage.size(), 16), 0);
+
+        if (levelWidth == 1 && levelHeight == 1) break;
+        auto mipStart = std::chrono::steady_clock::now();
+        downsampleRgba(level.data(), levelWidth, levelHeight, next);
+        mipMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mipStart).count();
+        level.swap(next);
+        levelWidth = std::max(1u, levelWidth / 2);
+        levelHeight = std::max(1u, levelHeight / 2);
+    }
+    memcpy(texture.storage.data(), &header, sizeof(header));
+    bindImage(texture.storage.data(), texture.storage.size(), texture, header);
+
+    if (!writeFile(cachePath, texture.storage))
+    {
+        std::cerr << "Could not write texture cache: " << cachePath << std::endl;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const char* formatNames[] = { "RGBA8", "BC1", "BC2", "BC3" };
+    std::cout << "Texture cache built: " << cachePath << " (" << formatNames[header.format] << ", " << width << "x" << height << ", "
+              << header.levelCount << " levels";
+    if (header.format != TEXTURE_RGBA8) std::cout << ", PSNR " << psnr << " dB";
+    std::cout << ", mipmaps " << mipMs << " ms " << mipSimdPathName(mipSimdPath()) << ", " << ms << " ms)" << std::endl;
+    return true;
+}
@@ -0,0 +1,588 @@
+#include "TextureManager.h"
+#include "FileHash.h"
+
+#include "stb_image.h"
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+
+// S3TC não faz parte do núcleo do OpenGL nem do glad gerado aqui (GL_EXT_texture_compression_s3tc)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace
+{
+    inline double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    string canonicalPath(const string& path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+        return ec ? path : canonical.string();
+    }
+
+    bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (extension && strcmp(extension, name) == 0) return true;
+        }
+        return false;
+    }
+}
+
+size_t TextureManager::Decoded::byteSize() const
+{
+    if (cached) return cached->levels.back().offset + cached->levels.back().size - cached->levels.front().offset;
+    return (size_t)width * height * channels;
+}
+
+TextureManager::~TextureManager()
+{
+    // Sem contexto garantido aqui: só para as threads e libera as imagens pendentes
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+    for (Decoded& image : ready) stbi_image_free(image.pixels);
+    ready.clear();
+}
+
+void TextureManager::initialize(int numThreads, int pboCount, bool compress)
+{
+    this->compress = compress && hasExtension("GL_EXT_texture_compression_s3tc");
+    if (compress && !this->compress) std::cout << "S3TC not supported, textures will be uploaded uncompressed" << std::endl;
+
+    if (numThreads <= 0) numThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    pbos.resize(std::max(pboCount, 1));
+    glGenBuffers((GLsizei)pbos.size(), pbos.data());
+    nextPbo = 0;
+
+    stopping = false;
+    for (int i = 0; i < numThreads; ++i) workers.emplace_back(&TextureManager::workerLoop, this);
+}
+
+void TextureManager::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+
+    for (Decoded& image : ready) stbi_image_free(image.pixels);
+    ready.clear();
+    if (!pbos.empty()) glDeleteBuffers((GLsizei)pbos.size(), pbos.data());
+    pbos.clear();
+
+    for (const auto& entry : entries) glDeleteTextures(1, &entry.first);
+    entries.clear();
+    byPath.clear();
+    byHash.clear();
+    arrays.clear();
+    layerByPath.clear();
+    layerByHash.clear();
+    waiting.clear();
+}
+
+GLuint TextureManager::request(const string& path)
+{
+    // Mesmo arquivo por outro caminho relativo (ou cópia já reconhecida pelo hash em update())
+    const string canonical = canonicalPath(path);
+    auto found = byPath.find(canonical);
+    if (found != byPath.end())
+    {
+        ++entries[found->second].refs;
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.requested;
+        ++stats.shared;
+        return found->second;
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Pixel branco: não altera a cor do material enquanto a imagem não chega
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    entries[texture] = { canonical, 0, 1, false };
+    byPath[canonical] = texture;
+
+    load(canonical, { texture, -1 });
+    return texture;
+}
+
+void TextureManager::load(const string& canonical, Target target)
+{
+    // Arquivo já na fila para outro destino: a mesma decodificação serve aos dois
+    auto pending = waiting.find(canonical);
+    if (pending != waiting.end())
+    {
+        pending->second.push_back(target);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.requested;
+        ++stats.shared;
+        return;
+    }
+
+    waiting[canonical].push_back(target);
+    enqueue({ canonical });
+}
+
+void TextureManager::enqueue(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stats.requested == 0 || (idleLocked() && reported))
+        {
+            firstRequest = std::chrono::steady_clock::now();
+            reported = false;
+        }
+        ++stats.requested;
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+vector<TextureLayer> TextureManager::requestArray(const vector<string>& paths)
+{
+    vector<TextureLayer> layers(paths.size());
+    vector<string> canonicals(paths.size());
+    unordered_map<string, size_t> firstUse;
+    std::map<pair<int, int>, vector<size_t>> groups; // (largura, altura) -> índices em paths
+    vector<GLuint> reused;                            // arrays de chamadas anteriores com camadas pedidas de novo
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        canonicals[i] = canonicalPath(paths[i]);
+        if (!firstUse.emplace(canonicals[i], i).second) continue;
+
+        // Camada já registrada pelo caminho, ou pelo hash já conhecido de uma textura 2D do mesmo arquivo
+        auto registered = layerByPath.find(canonicals[i]);
+        auto texture = byPath.find(canonicals[i]);
+        if (registered == layerByPath.end() && texture != byPath.end() && entries[texture->second].hash)
+        {
+            auto sameContent = layerByHash.find(entries[texture->second].hash);
+            if (sameContent != layerByHash.end()) registered = layerByPath.emplace(canonicals[i], sameContent->second).first;
+        }
+        if (registered != layerByPath.end())
+        {
+            layers[i] = registered->second;
+            if (std::find(reused.begin(), reused.end(), layers[i].array) == reused.end()) reused.push_back(layers[i].array);
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.requested;
+            ++stats.shared;
+            continue;
+        }
+
+        int width = 0, height = 0, channels = 0;
+        if (!stbi_info(canonicals[i].c_str(), &width, &height, &channels))
+        {
+            std::cout << "Failed to load texture: " << paths[i] << std::endl;
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.failed;
+            continue;
+        }
+        groups[{ width, height }].push_back(i);
+    }
+
+    // Camadas brancas, como o pixel provisório de request(); um bloco BC3 branco e opaco:
+    // alfa 255 nos dois extremos e cor 0xFFFF nos dois extremos, todos os índices 0
+    const uint8_t whiteBlock[16] = { 255, 255, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0 };
+    const uint32_t format = compress ? TEXTURE_BC3 : TEXTURE_RGBA8;
+    vector<uint8_t> white;
+    for (const auto& group : groups)
+    {
+        ArrayInfo info = { format, group.first.first, group.first.second, 1, (int)group.second.size() };
+        for (int w = info.width, h = info.height; (w > 1 || h > 1) && info.levels < (int)TEXTURE_MAX_LEVELS; w = std::max(1, w / 2), h = std::max(1, h / 2))
+            ++info.levels;
+
+        GLuint array;
+        glGenTextures(1, &array);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, info.levels - 1);
+        for (int level = 0, w = info.width, h = info.height; level < info.levels; ++level, w = std::max(1, w / 2), h = std::max(1, h / 2))
+        {
+            if (format == TEXTURE_RGBA8)
+            {
+                white.assign((size_t)w * h * 4 * info.layers, 255);
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, w, h, info.layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+            }
+            else
+            {
+                const size_t blocks = (size_t)((w + 3) / 4) * ((h + 3) / 4) * info.layers;
+                white.resize(blocks * 16);
+                for (size_t b = 0; b < blocks; ++b) memcpy(white.data() + b * 16, whiteBlock, 16);
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, w, h, info.layers, 0, (GLsizei)white.size(), white.data());
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        entries[array] = { string(), 0, 1, true };
+        arrays[array] = info;
+        for (size_t layer = 0; layer < group.second.size(); ++layer)
+        {
+            const size_t i = group.second[layer];
+            layers[i] = { array, (int)layer };
+            layerByPath[canonicals[i]] = layers[i];
+            load(canonicals[i], { array, (int)layer });
+        }
+    }
+    for (GLuint array : reused) ++entries[array].refs;
+
+    for (size_t i = 0; i < paths.size(); ++i) layers[i] = layers[firstUse[canonicals[i]]];
+    return layers;
+}
+
+void TextureManager::release(GLuint texture)
+{
+    auto found = entries.find(texture);
+    if (found != entries.end() && found->second.refs > 0) --found->second.refs;
+}
+
+void TextureManager::evictUnused()
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.refs > 0 || !it->second.loaded)
+        {
+            ++it;
+            continue;
+        }
+
+        const GLuint texture = it->first;
+        for (auto path = byPath.begin(); path != byPath.end();)
+        {
+            if (path->second == texture) path = byPath.erase(path);
+            else ++path;
+        }
+        auto hash = byHash.find(it->second.hash);
+        if (hash != byHash.end() && hash->second == texture) byHash.erase(hash);
+        for (auto layer = layerByPath.begin(); layer != layerByPath.end();)
+        {
+            if (layer->second.array == texture) layer = layerByPath.erase(layer);
+            else ++layer;
+        }
+        for (auto layer = layerByHash.begin(); layer != layerByHash.end();)
+        {
+            if (layer->second.array == texture) layer = layerByHash.erase(layer);
+            else ++layer;
+        }
+        arrays.erase(texture);
+        glDeleteTextures(1, &texture);
+        it = entries.erase(it);
+        ++stats.evicted;
+    }
+}
+
+bool TextureManager::idleLocked() const
+{
+    return jobs.empty() && ready.empty() && inFlight == 0;
+}
+
+bool TextureManager::idle() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return idleLocked();
+}
+
+void TextureManager::workerLoop()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            ++inFlight;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const uint64_t hash = hashFile(job.path);
+        unique_ptr<CompressedTexture> cached(new CompressedTexture());
+        if (!loadCompressedTexture(job.path, *cached, compress)) cached.reset();
+
+        // RGB fica com 3 canais; cinza, cinza + alfa e RGBA viram RGBA (camadas de array só usam o .vbt)
+        int width = 0, height = 0, channels = 0;
+        unsigned char* pixels = nullptr;
+        if (cached)
+        {
+            width = (int)cached->width;
+            height = (int)cached->height;
+        }
+        else if (stbi_info(job.path.c_str(), &width, &height, &channels))
+        {
+            const int desired = channels == 3 ? 3 : 4;
+            pixels = stbi_load(job.path.c_str(), &width, &height, &channels, desired);
+            channels = desired;
+        }
+        const double ms = millisecondsSince(start);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --inFlight;
+            stats.decodeMs += ms;
+            ready.push_back({ std::move(job.path), hash, pixels, width, height, channels, std::move(cached) });
+        }
+    }
+}
+
+void TextureManager::upload(const Decoded& image, GLuint texture)
+{
+    const size_t size = (size_t)image.width * image.height * image.channels;
+    const GLenum format = image.channels == 3 ? GL_RGB : GL_RGBA;
+
+    // Anel de PBOs: glBufferData com nullptr descarta o conteúdo anterior, então o driver
+    // não precisa esperar a GPU terminar de ler o envio que usou este buffer antes
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % pbos.size();
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped)
+    {
+        memcpy(mapped, image.pixels, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // com o PBO ligado, image.pixels seria lido como deslocamento
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // linhas RGB de largura ímpar não são múltiplas de 4
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, mapped ? nullptr : image.pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void TextureManager::uploadLevels(const Decoded& image, GLuint target)
+{
+    const CompressedTexture& texture = *image.cached;
+    const uint64_t base = texture.levels.front().offset;
+    const size_t size = image.byteSize();
+    const GLenum format = texture.format == TEXTURE_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+    // Todos os níveis de uma vez no PBO; cada glTexImage2D/glCompressedTexImage2D lê o seu trecho
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % pbos.size();
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped)
+    {
+        memcpy(mapped, texture.data + base, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, target);
+    for (size_t level = 0; level < texture.levels.size(); ++level)
+    {
+        const TextureCacheLevel& entry = texture.levels[level];
+        const void* source = mapped ? (const void*)(uintptr_t)(entry.offset - base) : (const void*)(texture.data + entry.offset);
+        if (texture.format == TEXTURE_RGBA8) glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA, entry.width, entry.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, source);
+        else glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, format, entry.width, entry.height, 0, entry.size, source);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool TextureManager::uploadLayer(const Decoded& image, const Target& layer)
+{
+    auto found = arrays.find(layer.texture);
+    if (found == arrays.end()) return false; // array já apagado
+    if (!image.cached) return false;        // camadas só recebem os níveis do .vbt
+    const ArrayInfo& info = found->second;
+    const CompressedTexture& texture = *image.cached;
+
+    // BC1 vira BC3 juntando um bloco de alfa opaco a cada bloco de cor (o codificador só usa o
+    // modo de 4 cores, que é o mesmo nos dois formatos)
+    const bool widen = info.format == TEXTURE_BC3 && texture.format == TEXTURE_BC1;
+    if ((int)texture.width != info.width || (int)texture.height != info.height || (texture.format != info.format && !widen))
+    {
+        std::cout << "Texture does not match its array: " << image.path << std::endl;
+        return false;
+    }
+
+    const size_t levels = std::min(texture.levels.size(), (size_t)info.levels);
+    vector<size_t> offsets(levels + 1, 0);
+    for (size_t level = 0; level < levels; ++level) offsets[level + 1] = offsets[level] + texture.levels[level].size * (widen ? 2 : 1);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % pbos.size();
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, offsets[levels], nullptr, GL_STREAM_DRAW);
+    uint8_t* mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, offsets[levels], GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    vector<uint8_t> staging;
+    if (!mapped)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        staging.resize(offsets[levels]);
+    }
+    uint8_t* target = mapped ? mapped : staging.data();
+    for (size_t level = 0; level < levels; ++level)
+    {
+        const TextureCacheLevel& entry = texture.levels[level];
+        const uint8_t* source = texture.data + entry.offset;
+        if (!widen)
+        {
+            memcpy(target + offsets[level], source, entry.size);
+            continue;
+        }
+        const uint8_t opaque[8] = { 255, 255, 0, 0, 0, 0, 0, 0 };
+        for (size_t block = 0; block < entry.size / 8; ++block)
+        {
+            memcpy(target + offsets[level] + block * 16, opaque, 8);
+            memcpy(target + offsets[level] + block * 16 + 8, source + block * 8, 8);
+        }
+    }
+    if (mapped) glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, layer.texture);
+    for (size_t level = 0; level < levels; ++level)
+    {
+        const TextureCacheLevel& entry = texture.levels[level];
+        const void* source = mapped ? (const void*)(uintptr_t)offsets[level] : (const void*)(staging.data() + offsets[level]);
+        const GLsizei size = (GLsizei)(offsets[level + 1] - offsets[level]);
+        if (info.format == TEXTURE_RGBA8)
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, 0, 0, layer.layer, entry.width, entry.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, source);
+        else
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, 0, 0, layer.layer, entry.width, entry.height, 1, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, size, source);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void TextureManager::registerHash(const Decoded& image, const Target& target)
+{
+    if (!image.hash) return;
+
+    // Conteúdo já registrado por outro caminho: o caminho desta imagem passa a apontar para a
+    // textura (ou camada) existente; quem já recebeu este destino continua usando-o até release()
+    if (target.layer < 0)
+    {
+        entries[target.texture].hash = image.hash;
+        auto same = byHash.find(image.hash);
+        if (same == byHash.end()) byHash[image.hash] = target.texture;
+        else if (same->second != target.texture) byPath[image.path] = same->second;
+        return;
+    }
+
+    auto same = layerByHash.find(image.hash);
+    if (same == layerByHash.end()) layerByHash[image.hash] = { target.texture, target.layer };
+    else if (same->second.array != target.texture || same->second.layer != target.layer) layerByPath[image.path] = same->second;
+}
+
+void TextureManager::update(size_t maxBytes)
+{
+    size_t sent = 0;
+    for (;;)
+    {
+        Decoded image;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ready.empty()) break;
+            const size_t size = ready.front().byteSize();
+            if (sent > 0 && sent + size > maxBytes) break;
+            image = std::move(ready.front());
+            ready.pop_front();
+        }
+
+        vector<Target> targets;
+        auto pending = waiting.find(image.path);
+        if (pending != waiting.end())
+        {
+            targets = std::move(pending->second);
+            waiting.erase(pending);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t failed = 0, uploaded = 0;
+        for (const Target& target : targets)
+        {
+            auto entry = entries.find(target.texture);
+            if (entry != entries.end() && target.layer < 0) entry->second.loaded = true;
+
+            bool ok = image.pixels || image.cached;
+            if (ok && target.layer >= 0) ok = uploadLayer(image, target);
+            else if (ok && image.cached) uploadLevels(image, target.texture);
+            else if (ok) upload(image, target.texture);
+
+            if (!ok)
+            {
+                std::cout << "Failed to load texture: " << image.path << std::endl;
+                ++failed;
+                continue;
+            }
+            registerHash(image, target);
+            ++uploaded;
+        }
+        const size_t size = image.byteSize() * uploaded;
+        sent += size;
+        stbi_image_free(image.pixels);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.failed += failed;
+        if (uploaded == 0) continue;
+        stats.uploadMs += millisecondsSince(start);
+        stats.uploadedBytes += size;
+        ++stats.decoded;
+        if (image.cached && image.cached->format != TEXTURE_RGBA8) ++stats.compressed;
+    }
+
+    evictUnused();
+
+    // Resumo quando a fila esvazia: tempo total e vazão de decodificação
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!reported && stats.requested > 0 && idleLocked())
+    {
+        reported = true;
+        stats.elapsedMs = millisecondsSince(firstRequest);
+        const double megabytes = stats.uploadedBytes / (1024.0 * 1024.0);
+        std::cout << "Textures loaded: " << stats.decoded << " (" << stats.compressed << " compressed, " << stats.shared << " shared, " << stats.failed << " failed, " << workers.size() << " thread(s)) in "
+                  << stats.elapsedMs << " ms; decode " << stats.decodeMs << " ms total, upload " << stats.uploadMs << " ms, "
+                  << megabytes / (stats.elapsedMs / 1000.0) << " MB/s" << std::endl;
+    }
+}
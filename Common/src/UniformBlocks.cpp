@@ -0,0 +1,95 @@
+#include "UniformBlocks.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+MaterialBlock makeMaterialBlock(const Material& material)
+{
+    MaterialBlock block = {};
+    block.Ka = glm::vec4(material.Ka, 0.0f);
+    block.Kd = glm::vec4(material.Kd, 0.0f);
+    block.Ks = glm::vec4(material.Ks, 0.0f);
+    block.Ns = material.Ns;
+    return block;
+}
+
+void bindUniformBlocks(GLuint program)
+{
+    struct Block { const char* name; UniformBlockBinding binding; };
+    static const Block blocks[] = {
+        { "Camera", UBO_BINDING_CAMERA },
+        { "Lights", UBO_BINDING_LIGHTS },
+        { "Material", UBO_BINDING_MATERIAL },
+    };
+    for (const Block& block : blocks)
+    {
+        const GLuint index = glGetUniformBlockIndex(program, block.name);
+        if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, block.binding);
+    }
+}
+
+void UniformBuffer::create(UniformBlockBinding binding, size_t size)
+{
+    destroy();
+    this->size = size;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+}
+
+void UniformBuffer::destroy()
+{
+    if (buffer) glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    size = 0;
+}
+
+void UniformBuffer::update(const void* data, size_t size)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, std::min(size, this->size), data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void MaterialBuffer::upload(const vector<Material>& materials)
+{
+    destroy();
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = std::max(alignment, 1);
+    stride = (sizeof(MaterialBlock) + alignment - 1) / alignment * alignment;
+    count = materials.size();
+
+    vector<uint8_t> data(std::max<size_t>(count, 1) * stride, 0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const MaterialBlock block = makeMaterialBlock(materials[i]);
+        memcpy(data.data() + i * stride, &block, sizeof(block));
+    }
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (count > 0) bind(0);
+}
+
+void MaterialBuffer::destroy()
+{
+    if (buffer) glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    stride = count = 0;
+}
+
+void MaterialBuffer::bind(size_t index) const
+{
+    if (index >= count)
+    {
+        std::cout << "MaterialBuffer: material " << index << " out of range" << std::endl;
+        return;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, UBO_BINDING_MATERIAL, buffer, index * stride, sizeof(MaterialBlock));
+}
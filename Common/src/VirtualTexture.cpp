@@ -0,0 +1,386 @@
+#include "VirtualTexture.h"
+#include "FileHash.h"
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+#include <filesystem>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    const uint32_t PINNED = 0xFFFFFFFFu;
+
+    // Handles dos uniforms de bind(), chamado a cada quadro
+    struct VirtualTextureUniforms
+    {
+        Uniform<int> cache = Shader::uniform<int>("vt_cache");
+        Uniform<int> indirection = Shader::uniform<int>("vt_indirection");
+        Uniform<glm::vec2> size = Shader::uniform<glm::vec2>("vt_size");
+        Uniform<float> pageSize = Shader::uniform<float>("vt_pageSize");
+        Uniform<float> border = Shader::uniform<float>("vt_border");
+        Uniform<float> cacheSize = Shader::uniform<float>("vt_cacheSize");
+        Uniform<int> maxLevel = Shader::uniform<int>("vt_maxLevel");
+        Uniform<int> id = Shader::uniform<int>("vt_id");
+        Uniform<float> feedbackBias = Shader::uniform<float>("vt_feedbackBias");
+        Uniform<int> levelRow[VT_MAX_LEVELS];
+
+        VirtualTextureUniforms()
+        {
+            for (uint32_t level = 0; level < VT_MAX_LEVELS; ++level)
+                levelRow[level] = Shader::uniform<int>("vt_levelRow[" + to_string(level) + "]");
+        }
+    };
+
+    const VirtualTextureUniforms& uniforms()
+    {
+        static const VirtualTextureUniforms handles;
+        return handles;
+    }
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    // As texturas e o framebuffer precisam do contexto: apagados em close()
+    file.close();
+}
+
+bool VirtualTexture::open(const string& imagePath, int cacheSlots, int id)
+{
+    close();
+    const string path = virtualTexturePath(imagePath);
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!sourceInfo(imagePath, sourceSize, sourceTime)) return false;
+
+    auto matches = [&]()
+    {
+        if (!file.open(path) || file.getSize() < sizeof(header)) return false;
+        memcpy(&header, file.begin(), sizeof(header));
+        return validVirtualTextureHeader(header, file.getSize()) && header.sourceSize == sourceSize &&
+               (header.sourceTime == sourceTime || header.sourceHash == hashFile(imagePath));
+    };
+    bool found = matches();
+    if (found && header.sourceTime != sourceTime)
+    {
+        // Aceito pelo hash: grava a data nova e mapeia de novo
+        file.close();
+        refreshSourceTime(path, offsetof(VirtualTextureHeader, sourceTime), sourceTime);
+        found = matches();
+    }
+    if (!found)
+    {
+        file.close();
+        if (!buildVirtualTexture(imagePath, path) || !matches())
+        {
+            file.close();
+            return false;
+        }
+    }
+
+    this->id = std::min(std::max(id, 1), 255);
+    this->cacheSlots = std::min(std::max(cacheSlots, 2), 255); // posição do slot cabe em 8 bits
+    slots.assign((size_t)this->cacheSlots * this->cacheSlots, Slot());
+    pageSlot.assign(header.pageCount, NO_PAGE);
+    requestStamp.assign(header.pageCount, 0);
+    pending.clear();
+    frame = 0;
+    stats = VirtualTextureStats();
+
+    // Cache de páginas, sem mipmaps (cada nível virtual tem as suas páginas)
+    const GLsizei cacheSize = (GLsizei)(this->cacheSlots * VT_STORED_PAGE_SIZE);
+    glGenTextures(1, &cacheTexture);
+    glBindTexture(GL_TEXTURE_2D, cacheTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheSize, cacheSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    // Indireção: a grade de páginas de cada nível, empilhadas a partir da linha levelRow[nível]
+    levelRow.assign(header.levelCount, 0);
+    indirectionHeight = 0;
+    for (uint32_t level = 0; level < header.levelCount; ++level)
+    {
+        levelRow[level] = indirectionHeight;
+        indirectionHeight += header.levels[level].pagesY;
+    }
+    indirection.assign((size_t)header.levels[0].pagesX * indirectionHeight * 4, 0);
+    glGenTextures(1, &indirectionTexture);
+    glBindTexture(GL_TEXTURE_2D, indirectionTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, header.levels[0].pagesX, indirectionHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // A página do nível mais grosso fica sempre no cache: toda página que falta cai nela no pior caso
+    const uint32_t root = header.pageCount - 1;
+    uploadPage(root, 0);
+    slots[0].page = root;
+    slots[0].lastUsed = PINNED;
+    pageSlot[root] = 0;
+    stats.residentPages = 1;
+    rebuildIndirection();
+    return true;
+}
+
+void VirtualTexture::close()
+{
+    if (cacheTexture) glDeleteTextures(1, &cacheTexture);
+    if (indirectionTexture) glDeleteTextures(1, &indirectionTexture);
+    if (feedbackColor) glDeleteTextures(1, &feedbackColor);
+    if (feedbackDepth) glDeleteRenderbuffers(1, &feedbackDepth);
+    if (feedbackFbo) glDeleteFramebuffers(1, &feedbackFbo);
+    if (!feedbackPbos.empty()) glDeleteBuffers((GLsizei)feedbackPbos.size(), feedbackPbos.data());
+    cacheTexture = indirectionTexture = feedbackColor = feedbackDepth = feedbackFbo = 0;
+    feedbackPbos.clear();
+    feedbackWidth = feedbackHeight = 0;
+    file.close();
+}
+
+uint32_t VirtualTexture::pageIndex(uint32_t level, uint32_t x, uint32_t y) const
+{
+    return header.levels[level].firstPage + y * header.levels[level].pagesX + x;
+}
+
+void VirtualTexture::bind(const Shader& shader, int cacheUnit, int indirectionUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + cacheUnit);
+    glBindTexture(GL_TEXTURE_2D, cacheTexture);
+    glActiveTexture(GL_TEXTURE0 + indirectionUnit);
+    glBindTexture(GL_TEXTURE_2D, indirectionTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    const VirtualTextureUniforms& u = uniforms();
+    shader.set(u.cache, cacheUnit);
+    shader.set(u.indirection, indirectionUnit);
+    shader.set(u.size, glm::vec2((float)header.levels[0].width, (float)header.levels[0].height));
+    shader.set(u.pageSize, (float)VT_PAGE_SIZE);
+    shader.set(u.border, (float)VT_PAGE_BORDER);
+    shader.set(u.cacheSize, (float)(cacheSlots * VT_STORED_PAGE_SIZE));
+    shader.set(u.maxLevel, (int)header.levelCount - 1);
+    for (uint32_t level = 0; level < header.levelCount; ++level)
+        shader.set(u.levelRow[level], (int)levelRow[level]);
+    shader.set(u.id, id);
+    shader.set(u.feedbackBias, feedbackBias);
+}
+
+void VirtualTexture::beginFeedback(int width, int height)
+{
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &savedFbo);
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, savedClearColor);
+
+    // O feedback menor que a janela aumenta as derivadas; o viés devolve o nível da janela
+    feedbackBias = std::log2(std::max(1.0f, (float)savedViewport[2] / width));
+
+    if (width != feedbackWidth || height != feedbackHeight)
+    {
+        if (!feedbackFbo)
+        {
+            glGenFramebuffers(1, &feedbackFbo);
+            glGenTextures(1, &feedbackColor);
+            glGenRenderbuffers(1, &feedbackDepth);
+            feedbackPbos.resize(2);
+            glGenBuffers(2, feedbackPbos.data());
+        }
+        glBindTexture(GL_TEXTURE_2D, feedbackColor);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, feedbackFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, feedbackColor, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Virtual texture feedback framebuffer is incomplete" << std::endl;
+
+        const size_t bytes = (size_t)width * height * 4;
+        for (GLuint pbo : feedbackPbos)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        feedbackWidth = width;
+        feedbackHeight = height;
+        feedbackReads = 0;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFbo);
+    glViewport(0, 0, feedbackWidth, feedbackHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // alfa 0 = nenhuma textura virtual
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTexture::endFeedback()
+{
+    // Leitura assíncrona em dois PBOs: o feedback deste quadro é processado no próximo,
+    // sem esperar a GPU terminar de desenhar
+    const size_t bytes = (size_t)feedbackWidth * feedbackHeight * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPbos[feedbackReads % 2]);
+    glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    if (feedbackReads > 0)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPbos[(feedbackReads + 1) % 2]);
+        const uint8_t* pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+        if (pixels)
+        {
+            processFeedback(pixels, (size_t)feedbackWidth * feedbackHeight);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+    }
+    ++feedbackReads;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)savedFbo);
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+    glClearColor(savedClearColor[0], savedClearColor[1], savedClearColor[2], savedClearColor[3]);
+}
+
+void VirtualTexture::processFeedback(const uint8_t* pixels, size_t count)
+{
+    ++frame;
+    pending.clear();
+    stats.pagesRequested = 0;
+    stats.pagesMissing = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* pixel = pixels + i * 4;
+        if (pixel[3] != id || pixel[2] >= header.levelCount) continue;
+        const VirtualTextureLevel& level = header.levels[pixel[2]];
+        if (pixel[0] >= level.pagesX || pixel[1] >= level.pagesY) continue;
+        requestPage(pixel[2], pixel[0], pixel[1]);
+    }
+
+    // Níveis grossos têm índices maiores: ordem decrescente envia primeiro as páginas que
+    // servem de substitutas para as outras
+    std::sort(pending.begin(), pending.end(), std::greater<uint32_t>());
+}
+
+void VirtualTexture::requestPage(uint32_t level, uint32_t x, uint32_t y)
+{
+    // A página e todas as mais grossas que a cobrem
+    for (; level < header.levelCount; ++level, x /= 2, y /= 2)
+    {
+        const uint32_t page = pageIndex(level, x, y);
+        if (requestStamp[page] == frame) return; // as de cima já foram pedidas também
+        requestStamp[page] = frame;
+        ++stats.pagesRequested;
+
+        if (pageSlot[page] != NO_PAGE)
+        {
+            Slot& slot = slots[pageSlot[page]];
+            if (slot.lastUsed != PINNED) slot.lastUsed = frame;
+        }
+        else
+        {
+            pending.push_back(page);
+            ++stats.pagesMissing;
+        }
+    }
+}
+
+void VirtualTexture::uploadPage(uint32_t page, uint32_t slot)
+{
+    const GLint x = (GLint)((slot % cacheSlots) * VT_STORED_PAGE_SIZE);
+    const GLint y = (GLint)((slot / cacheSlots) * VT_STORED_PAGE_SIZE);
+    glBindTexture(GL_TEXTURE_2D, cacheTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, VT_STORED_PAGE_SIZE, VT_STORED_PAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE,
+                    file.begin() + virtualTexturePageOffset(page));
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+int VirtualTexture::update(int maxPages)
+{
+    int uploaded = 0;
+    size_t next = 0;
+    for (; next < pending.size() && uploaded < maxPages; ++next)
+    {
+        const uint32_t page = pending[next];
+        if (pageSlot[page] != NO_PAGE) continue;
+
+        // Slot usado há mais tempo, sem tirar páginas pedidas neste feedback
+        uint32_t victim = NO_PAGE;
+        for (uint32_t s = 0; s < slots.size(); ++s)
+        {
+            if (slots[s].lastUsed == PINNED || slots[s].lastUsed == frame) continue;
+            if (slots[s].page == NO_PAGE)
+            {
+                victim = s;
+                break;
+            }
+            if (victim == NO_PAGE || slots[s].lastUsed < slots[victim].lastUsed) victim = s;
+        }
+        if (victim == NO_PAGE) break; // cache pequeno demais para o quadro: o resto usa páginas mais grossas
+
+        Slot& slot = slots[victim];
+        if (slot.page != NO_PAGE)
+        {
+            pageSlot[slot.page] = NO_PAGE;
+            ++stats.pagesEvicted;
+        }
+        else
+        {
+            ++stats.residentPages;
+        }
+        uploadPage(page, victim);
+        slot.page = page;
+        slot.lastUsed = frame;
+        pageSlot[page] = victim;
+        ++uploaded;
+    }
+    pending.erase(pending.begin(), pending.begin() + next);
+
+    stats.pagesUploaded += uploaded;
+    if (uploaded > 0) rebuildIndirection();
+    return uploaded;
+}
+
+void VirtualTexture::rebuildIndirection()
+{
+    // Do nível mais grosso para o mais fino: página fora do cache herda a entrada da página de cima
+    const uint32_t stride = header.levels[0].pagesX;
+    for (int level = (int)header.levelCount - 1; level >= 0; --level)
+    {
+        const VirtualTextureLevel& info = header.levels[level];
+        for (uint32_t y = 0; y < info.pagesY; ++y)
+        {
+            for (uint32_t x = 0; x < info.pagesX; ++x)
+            {
+                uint8_t* entry = indirection.data() + ((size_t)(levelRow[level] + y) * stride + x) * 4;
+                const uint32_t slot = pageSlot[pageIndex(level, x, y)];
+                if (slot != NO_PAGE)
+                {
+                    entry[0] = (uint8_t)(slot % cacheSlots);
+                    entry[1] = (uint8_t)(slot / cacheSlots);
+                    entry[2] = (uint8_t)level;
+                    entry[3] = 255;
+                }
+                else
+                {
+                    memcpy(entry, indirection.data() + ((size_t)(levelRow[level + 1] + y / 2) * stride + x / 2) * 4, 4);
+                }
+            }
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, indirectionTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, stride, indirectionHeight, GL_RGBA, GL_UNSIGNED_BYTE, indirection.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
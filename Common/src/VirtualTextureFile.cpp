@@ -0,0 +1,134 @@
+#include "VirtualTextureFile.h"
+#include "FileHash.h"
+#include "MipBuilder.h"
+
+#include "stb_image.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <algorithm>
+
+namespace
+{
+    const char VT_MAGIC[4] = { 'V', 'T', 'X', '1' };
+
+    // Página (x, y) de um nível com a borda tirada dos vizinhos (repetindo a borda da imagem)
+    void cutPage(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t pageX, uint32_t pageY, uint8_t* page)
+    {
+        for (uint32_t ty = 0; ty < VT_STORED_PAGE_SIZE; ++ty)
+        {
+            const int64_t y = (int64_t)pageY * VT_PAGE_SIZE + ty - VT_PAGE_BORDER;
+            const uint8_t* row = rgba + (size_t)std::min<int64_t>(std::max<int64_t>(y, 0), height - 1) * width * 4;
+            uint8_t* target = page + (size_t)ty * VT_STORED_PAGE_SIZE * 4;
+            for (uint32_t tx = 0; tx < VT_STORED_PAGE_SIZE; ++tx)
+            {
+                const int64_t x = (int64_t)pageX * VT_PAGE_SIZE + tx - VT_PAGE_BORDER;
+                memcpy(target + tx * 4, row + (size_t)std::min<int64_t>(std::max<int64_t>(x, 0), width - 1) * 4, 4);
+            }
+        }
+    }
+}
+
+bool validVirtualTextureHeader(const VirtualTextureHeader& header, size_t fileSize)
+{
+    if (memcmp(header.magic, VT_MAGIC, 4) != 0 || header.version != VT_FILE_VERSION) return false;
+    if (header.pageSize != VT_PAGE_SIZE || header.border != VT_PAGE_BORDER) return false;
+    if (header.levelCount == 0 || header.levelCount > VT_MAX_LEVELS) return false;
+    const VirtualTextureLevel& last = header.levels[header.levelCount - 1];
+    if (last.pagesX != 1 || last.pagesY != 1 || last.firstPage + 1 != header.pageCount) return false;
+    return fileSize >= virtualTexturePageOffset(header.pageCount);
+}
+
+string virtualTexturePath(const string& imagePath)
+{
+    return imagePath + ".vtx";
+}
+
+bool buildVirtualTexture(const string& imagePath, const string& outPath)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    VirtualTextureHeader header = {};
+    memcpy(header.magic, VT_MAGIC, 4);
+    header.version = VT_FILE_VERSION;
+    if (!sourceInfo(imagePath, header.sourceSize, header.sourceTime)) return false;
+    header.sourceHash = hashFile(imagePath);
+    header.pageSize = VT_PAGE_SIZE;
+    header.border = VT_PAGE_BORDER;
+
+    const string tmpPath = outPath + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write((const char*)&header, sizeof(header)); // reescrito no fim, com a tabela de níveis
+
+    // O nível 0 é lido direto do buffer do stb_image (sem cópia); ele é liberado logo depois de
+    // gerar o nível 1, e daí em diante level aponta para current
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+    if (!pixels)
+    {
+        out.close();
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    const uint8_t* level = pixels;
+    vector<uint8_t> current, next;
+
+    // Um nível de cada vez: corta as páginas, grava e só então monta o próximo
+    vector<uint8_t> page(VT_PAGE_BYTES);
+    uint32_t levelWidth = (uint32_t)width, levelHeight = (uint32_t)height;
+    while (header.levelCount < VT_MAX_LEVELS)
+    {
+        VirtualTextureLevel& entry = header.levels[header.levelCount++];
+        entry.width = levelWidth;
+        entry.height = levelHeight;
+        entry.pagesX = (levelWidth + VT_PAGE_SIZE - 1) / VT_PAGE_SIZE;
+        entry.pagesY = (levelHeight + VT_PAGE_SIZE - 1) / VT_PAGE_SIZE;
+        entry.firstPage = header.pageCount;
+        header.pageCount += entry.pagesX * entry.pagesY;
+
+        for (uint32_t y = 0; y < entry.pagesY; ++y)
+        {
+            for (uint32_t x = 0; x < entry.pagesX; ++x)
+            {
+                cutPage(level, levelWidth, levelHeight, x, y, page.data());
+                out.write((const char*)page.data(), page.size());
+            }
+        }
+
+        if (entry.pagesX == 1 && entry.pagesY == 1) break;
+        downsampleRgba(level, levelWidth, levelHeight, next);
+        if (pixels)
+        {
+            stbi_image_free(pixels);
+            pixels = nullptr;
+        }
+        current.swap(next);
+        level = current.data();
+        levelWidth = std::max(1u, levelWidth / 2);
+        levelHeight = std::max(1u, levelHeight / 2);
+    }
+    stbi_image_free(pixels); // imagem de uma página só: o laço não chegou a liberar
+    out.seekp(0);
+    out.write((const char*)&header, sizeof(header));
+    out.close();
+    if (!out.good()) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, outPath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Virtual texture built: " << outPath << " (" << width << "x" << height << ", " << header.levelCount << " levels, "
+              << header.pageCount << " pages, " << ms << " ms)" << std::endl;
+    return true;
+}
@@ -1,59 +1,110 @@
 #version 330 core
+
+// Features da variante (ShaderVariants.h injeta os #define depois do #version); sem defines,
+// o shader completo de antes
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 3 // luzes acesas, no começo de lights[]
+#endif
+#ifndef HAS_DIFFUSE_MAP
+#define HAS_DIFFUSE_MAP 1  // 0: sem textura, cor só do material
+#endif
+#ifndef HAS_SPECULAR
+#define HAS_SPECULAR 1     // 0: sem termo especular (illum < 2 ou Ks nulo)
+#endif
+#ifndef INSTANCED
+#define INSTANCED 0        // 1: camada da textura por instância (sprite.vs)
+#endif
+// Origem da cor difusa (TextureSource em ShaderVariants.h)
+#define TEXTURE_SOURCE_2D 0      // tex_buffer
+#define TEXTURE_SOURCE_ARRAY 1   // camada de tex_array
+#define TEXTURE_SOURCE_VIRTUAL 2 // textura virtual (VirtualTexture::bind)
+#ifndef TEXTURE_SOURCE
+#define TEXTURE_SOURCE TEXTURE_SOURCE_2D
+#endif
+
+#define MAX_POINT_LIGHTS 3 // tamanho do array do bloco Lights (UniformBlocks.h)
+
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+#if INSTANCED
+flat in int InstanceLayer; // camada por instância, < 0 usa texLayer
+#endif
 
+#if TEXTURE_SOURCE == TEXTURE_SOURCE_2D
 uniform sampler2D tex_buffer;
+#elif TEXTURE_SOURCE == TEXTURE_SOURCE_ARRAY
+// Texturas empacotadas em camadas de um array (TextureManager::requestArray)
+uniform sampler2DArray tex_array;
+uniform int texLayer;
+#elif TEXTURE_SOURCE == TEXTURE_SOURCE_VIRTUAL
+// Textura virtual (VirtualTexture): páginas num cache e tabela de indireção por nível
+uniform sampler2D vt_cache;
+uniform sampler2D vt_indirection;
+uniform vec2 vt_size;       // tamanho do nível 0 em pixels
+uniform float vt_pageSize;
+uniform float vt_border;
+uniform float vt_cacheSize; // lado da textura cache em pixels
+uniform int vt_maxLevel;
+uniform int vt_levelRow[16]; // linha da indireção onde começa cada nível
+#endif
+
+// Blocos compartilhados por todos os programas; o layout std140 é espelhado pelos structs de
+// UniformBlocks.h (vec3 ocupa um vec4 lá)
+layout(std140) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos; // xyz
+};
 
-struct Material {
-    vec3 Ka;
-    vec3 Kd;
-    vec3 Ks;
+layout(std140) uniform Material
+{
+    vec4 Ka; // rgb
+    vec4 Kd; // rgb
+    vec4 Ks; // rgb
     float Ns;
-};
-uniform Material material;
+} material;
 
 struct PointLight {
-    vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 position; // xyz
+    vec4 ambient;  // rgb
+    vec4 diffuse;  // rgb
+    vec4 specular; // rgb
     float constant;
     float linear;
     float quadratic;
-    bool enabled; // Added to enable/disable light
 };
 
-// Declare your three lights
-uniform PointLight keyLight;
-uniform PointLight fillLight;
-uniform PointLight backLight;
-
-uniform vec3 viewPos;
+// Luzes acesas primeiro: só as NUM_POINT_LIGHTS primeiras são avaliadas
+layout(std140) uniform Lights
+{
+    PointLight lights[MAX_POINT_LIGHTS];
+};
 
 vec3 calculateLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
-    if (!light.enabled) { // Se a luz estiver desabilitada, não contribui com iluminação
-        return vec3(0.0);
-    }
-
     // Componente Ambiente
-    vec3 ambient = light.ambient * material.Ka;
+    vec3 ambient = light.ambient.rgb * material.Ka.rgb;
 
     // Componente Difusa
-    vec3 lightDir = normalize(light.position - fragPos);
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * (diff * material.Kd);
+    vec3 diffuse = light.diffuse.rgb * (diff * material.Kd.rgb);
 
     // Componente Especular
+#if HAS_SPECULAR
     vec3 reflectDir = reflect(-lightDir, normal); // Vetor de reflexão
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.Ns); // Cálculo de especularidade com Ns
-    vec3 specular = light.specular * (spec * material.Ks);
+    vec3 specular = light.specular.rgb * (spec * material.Ks.rgb);
+#else
+    vec3 specular = vec3(0.0);
+#endif
 
     // Atenuação
-    float distance = length(light.position - fragPos);
+    float distance = length(light.position.xyz - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
 
     // Aplica a atenuação a todas as componentes da luz
@@ -64,19 +115,65 @@ vec3 calculateLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     return (ambient + diffuse + specular);
 }
 
+#if TEXTURE_SOURCE == TEXTURE_SOURCE_VIRTUAL
+// Mesmo nível e mesma página que vt_feedback.fs escreve no passe de feedback
+vec2 vtLevelSize(int level)
+{
+    return max(floor(vt_size / exp2(float(level))), vec2(1.0));
+}
+
+vec4 sampleVirtual(vec2 uv)
+{
+    vec2 dx = dFdx(uv * vt_size);
+    vec2 dy = dFdy(uv * vt_size);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+    int level = int(clamp(floor(lod), 0.0, float(vt_maxLevel)));
+
+    uv = fract(uv);
+    vec2 texel = uv * vtLevelSize(level);
+    vec2 pages = ceil(vtLevelSize(level) / vt_pageSize);
+    ivec2 page = ivec2(min(floor(texel / vt_pageSize), pages - 1.0));
+
+    // Entrada: slot x, slot y e o nível da página que está no cache (pode ser mais grossa)
+    ivec3 entry = ivec3(round(texelFetch(vt_indirection, ivec2(page.x, vt_levelRow[level] + page.y), 0).rgb * 255.0));
+    if (entry.b != level)
+    {
+        texel = uv * vtLevelSize(entry.b);
+        pages = ceil(vtLevelSize(entry.b) / vt_pageSize);
+        page = ivec2(min(floor(texel / vt_pageSize), pages - 1.0));
+    }
+    vec2 inPage = texel - vec2(page) * vt_pageSize;
+    vec2 cacheTexel = vec2(entry.xy) * (vt_pageSize + 2.0 * vt_border) + vt_border + inPage;
+    return textureLod(vt_cache, cacheTexel / vt_cacheSize, 0.0);
+}
+#endif
 
 void main()
 {
     vec3 norm = normalize(Normal); // Normal normalizada
-    vec3 viewDir = normalize(viewPos - FragPos); // Vetor da câmera para o fragmento
+    vec3 viewDir = normalize(viewPos.xyz - FragPos); // Vetor da câmera para o fragmento
 
     vec3 result = vec3(0.0);
 
-    // Calcula a iluminação para cada fonte de luz e soma os resultados
-    result += calculateLight(keyLight, norm, FragPos, viewDir);
-    result += calculateLight(fillLight, norm, FragPos, viewDir);
-    result += calculateLight(backLight, norm, FragPos, viewDir);
+    // Calcula a iluminação para cada fonte de luz acesa e soma os resultados
+    // (limite constante: o compilador desenrola o laço)
+    for (int i = 0; i < NUM_POINT_LIGHTS; ++i)
+        result += calculateLight(lights[i], norm, FragPos, viewDir);
 
     // Multiplica o resultado da iluminação pela cor da textura
-    FragColor = vec4(result, 1.0) * texture(tex_buffer, TexCoords);
+#if HAS_DIFFUSE_MAP && TEXTURE_SOURCE == TEXTURE_SOURCE_VIRTUAL
+    vec4 texColor = sampleVirtual(TexCoords);
+#elif HAS_DIFFUSE_MAP && TEXTURE_SOURCE == TEXTURE_SOURCE_ARRAY
+#if INSTANCED
+    int layer = InstanceLayer >= 0 ? InstanceLayer : texLayer;
+#else
+    int layer = texLayer;
+#endif
+    vec4 texColor = texture(tex_array, vec3(TexCoords, layer));
+#elif HAS_DIFFUSE_MAP
+    vec4 texColor = texture(tex_buffer, TexCoords);
+#else
+    vec4 texColor = vec4(1.0);
+#endif
+    FragColor = vec4(result, 1.0) * texColor;
 }
\ No newline at end of file
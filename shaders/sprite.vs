@@ -1,20 +1,78 @@
 #version 330 core
+
+// Variante: QUANTIZED_NORMALS 1 para malhas quantizadas (MeshCache.h), definido por ShaderVariants
+#ifndef QUANTIZED_NORMALS
+#define QUANTIZED_NORMALS 0
+#endif
+// Variante: INSTANCED 1 lê model e a camada da textura por instância (InstanceBuffer.h)
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
 layout (location = 2) in vec3 aNormal;
+layout (location = 3) in vec2 aOctNormal; // normal em octaedro (vértices quantizados)
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
+#if INSTANCED
+layout (location = 4) in mat4 aInstanceModel; // locations 4 a 7
+layout (location = 8) in vec4 aInstanceData;  // x: camada da textura (< 0: uniform texLayer)
+flat out int InstanceLayer;
+#else
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#endif
+
+// Câmera compartilhada por todos os programas (UniformBlocks.h, CameraBlock)
+layout(std140) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos; // xyz
+};
+
+#if QUANTIZED_NORMALS
+// Vértices quantizados: aPos chega normalizado em [0, 1] dentro da caixa da malha e a normal
+// em octaedro
+uniform vec3 posOffset;
+uniform vec3 posScale;
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+#endif
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal; 
+#if INSTANCED
+    mat4 model = aInstanceModel;
+    // Cofatores de mat3(model): mesma direção de transpose(inverse()) sem inverter por vértice
+    // (o sinal do determinante mantém as normais para fora com escala negativa)
+    mat3 m = mat3(model);
+    mat3 normalMatrix = mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1])) * sign(dot(cross(m[0], m[1]), m[2]));
+    InstanceLayer = int(aInstanceData.x);
+#else
+    mat3 normalMatrix = mat3(transpose(inverse(model)));
+#endif
+
+#if QUANTIZED_NORMALS
+    vec3 position = posOffset + aPos * posScale;
+    vec3 normal = decodeOctahedral(aOctNormal);
+#else
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+#endif
+
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = normalMatrix * normal;
     TexCoords = aTexCoords;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 330 core
+// Passe de feedback da textura virtual (usar com sprite.vs): escreve por pixel a página e o
+// nível que sprite.fs vai ler, para VirtualTexture::endFeedback saber o que enviar ao cache.
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+uniform vec2 vt_size;
+uniform float vt_pageSize;
+uniform int vt_maxLevel;
+uniform int vt_id;
+uniform float vt_feedbackBias; // log2(janela / feedback)
+
+void main()
+{
+    vec2 dx = dFdx(TexCoords * vt_size);
+    vec2 dy = dFdy(TexCoords * vt_size);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) - vt_feedbackBias;
+    int level = int(clamp(floor(lod), 0.0, float(vt_maxLevel)));
+
+    vec2 levelSize = max(floor(vt_size / exp2(float(level))), vec2(1.0));
+    vec2 pages = ceil(levelSize / vt_pageSize);
+    vec2 page = min(floor(fract(TexCoords) * levelSize / vt_pageSize), pages - 1.0);
+
+    FragColor = vec4(page, float(level), float(vt_id)) / 255.0;
+}
@@ -2,6 +2,8 @@
 #include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "ShaderCache.h"
+#include "InstanceBuffer.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -11,21 +13,21 @@ using namespace std;
 // Protótipos das funções
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 int setupShader();
-GLuint setupGeometry(bool isYellow); // Alterado para retornar GLuint
+GLuint setupGeometry(GLsizei& vertexCount); // Um cubo só, dividido por todos os objetos
 
 // Dimensões da janela
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 
-// Código fonte do Vertex Shader
+// Código fonte do Vertex Shader: model e cor vêm de cada instância (InstanceBuffer.h)
 const GLchar* vertexShaderSource = "#version 450\n"
 "layout (location = 0) in vec3 position;\n"
-"layout (location = 1) in vec3 color;\n"
-"uniform mat4 model;\n"
+"layout (location = 4) in mat4 instanceModel;\n"
+"layout (location = 8) in vec4 instanceColor;\n"
 "out vec4 finalColor;\n"
 "void main()\n"
 "{\n"
-"gl_Position = model * vec4(position, 1.0);\n"
-"finalColor = vec4(color, 1.0);\n"
+"gl_Position = instanceModel * vec4(position, 1.0);\n"
+"finalColor = instanceColor;\n"
 "}\0";
 
 // Código fonte do Fragment Shader
@@ -42,7 +44,7 @@ struct Object3D {
     glm::vec3 position;
     glm::vec3 rotation;
     glm::vec3 scale;
-    GLuint VAO; // Cada objeto terá seu próprio VAO
+    glm::vec3 color;
     bool selected;
 };
 
@@ -81,12 +83,17 @@ int main() {
     GLuint shaderID = setupShader();
     glUseProgram(shaderID);
 
-    GLint modelLoc = glGetUniformLocation(shaderID, "model");
     glEnable(GL_DEPTH_TEST);
 
+    // Todos os cubos usam o mesmo VAO; transformação e cor de cada um vão no buffer de instâncias
+    GLsizei vertexCount = 0;
+    GLuint VAO = setupGeometry(vertexCount);
+    InstanceBuffer instances;
+    instances.create(VAO);
+
     // Adiciona dois objetos iniciais na cena (um amarelo e um vermelho)
-    objects.push_back({ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f), setupGeometry(true), true });  // Cubo amarelo
-    objects.push_back({ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f), setupGeometry(false), false }); // Cubo vermelho
+    objects.push_back({ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f), glm::vec3(1.0f, 1.0f, 0.0f), true });  // Cubo amarelo
+    objects.push_back({ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f), glm::vec3(1.0f, 0.0f, 0.0f), false }); // Cubo vermelho
 
     // Loop principal
     while (!glfwWindowShouldClose(window)) {
@@ -95,8 +102,10 @@ int main() {
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        for (size_t i = 0; i < objects.size(); ++i) {
-            Object3D& obj = objects[i];
+        // O selecionado vai primeiro: desenhar só a instância 0 é desenhar o contorno dele
+        instances.clear();
+        for (size_t n = 0; n < objects.size(); ++n) {
+            Object3D& obj = objects[(selectedObjectIndex + n) % objects.size()];
 
             glm::mat4 model = glm::mat4(1.0f);
             model = glm::translate(model, obj.position);
@@ -105,27 +114,23 @@ int main() {
             model = glm::rotate(model, obj.rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
             model = glm::scale(model, obj.scale);
 
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            glBindVertexArray(obj.VAO);
-
-            // Desenho do objeto
-            if (obj.selected) {
-                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Wireframe
-                glDrawArrays(GL_TRIANGLES, 0, 36);
-                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); // Preenchido
-            }
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-
-            glBindVertexArray(0);
+            instances.add(model, glm::vec4(obj.color, 1.0f));
         }
+        instances.upload();
+
+        // Desenho de todos os objetos numa chamada só
+        glBindVertexArray(VAO);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Wireframe do selecionado
+        instances.drawArrays(GL_TRIANGLES, 0, vertexCount, 1);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); // Preenchido
+        instances.drawArrays(GL_TRIANGLES, 0, vertexCount);
+        glBindVertexArray(0);
 
         glfwSwapBuffers(window);
     }
 
-    for (auto& obj : objects) {
-        glDeleteVertexArrays(1, &obj.VAO);
-    }
+    instances.destroy();
+    glDeleteVertexArrays(1, &VAO);
     glfwTerminate();
     return 0;
 }
@@ -166,56 +171,22 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 }
 
 int setupShader() {
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
+    // Compila e linka os shaders acima, ou reaproveita o binário do programa gravado numa execução anterior
+    return buildProgram(vertexShaderSource, fragmentShaderSource, "", "Modulo2_Cubo");
 }
 
-GLuint setupGeometry(bool isYellow) { // Alterado para retornar GLuint
+GLuint setupGeometry(GLsizei& vertexCount) {
     GLfloat vertices[] = {
         // Frente
-        -0.5, -0.5,  0.5, isYellow ? 1.0f : 1.0f, isYellow ? 1.0f : 0.0f, 0.0f,
-         0.5, -0.5,  0.5, isYellow ? 1.0f : 1.0f, isYellow ? 1.0f : 0.0f, 0.0f,
-         0.5,  0.5,  0.5, isYellow ? 1.0f : 1.0f, isYellow ? 1.0f : 0.0f, 0.0f,
-        -0.5, -0.5,  0.5, isYellow ? 1.0f : 1.0f, isYellow ? 1.0f : 0.0f, 0.0f,
-         0.5,  0.5,  0.5, isYellow ? 1.0f : 1.0f, isYellow ? 1.0f : 0.0f, 0.0f,
-        -0.5,  0.5,  0.5, isYellow ? 1.0f : 1.0f, isYellow ? 1.0f : 0.0f, 0.0f,
+        -0.5, -0.5,  0.5,
+         0.5, -0.5,  0.5,
+         0.5,  0.5,  0.5,
+        -0.5, -0.5,  0.5,
+         0.5,  0.5,  0.5,
+        -0.5,  0.5,  0.5,
         // Outros lados...
     };
+    vertexCount = sizeof(vertices) / (3 * sizeof(GLfloat)); // a cor agora é por instância
 
     GLuint VBO, VAO;
     glGenBuffers(1, &VBO);
@@ -225,12 +196,9 @@ GLuint setupGeometry(bool isYellow) { // Alterado para retornar GLuint
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
     glEnableVertexAttribArray(0);
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
@@ -8,6 +8,8 @@
 #include <cmath>
 #include <cstdio>
 #include <random>
+#include <chrono>
+#include <algorithm>
 
 using namespace std;
 
@@ -23,19 +25,17 @@ using namespace std;
 #include "Shader.h"
 #include "Camera.h"
 #include "Mesh.h" // Assuming you have a Mesh class for better object handling
+#include "MeshCache.h"
+#include "Material.h"
+#include "UniformBlocks.h"
+#include "ShaderVariants.h"
+#include "ShaderWatcher.h"
+#include "InstanceBuffer.h"
+#include "TextureManager.h"
 
-// Global variables (consider encapsulating in a scene class for larger projects)
-vector<GLfloat> global_vertices;
-vector<GLfloat> global_textures;
-vector<GLfloat> global_normals;
+// Material table shared by all objects; index 0 is the default material for faces without usemtl
+vector<Material> sceneMaterials(1);
 
-glm::vec3 Ka; // Ambient material color
-glm::vec3 Kd; // Diffuse material color
-glm::vec3 Ks; // Specular material color
-float Ns;     // Shininess exponent
-
-string mtlFilePath = "";
-string textureFilePath = "";
 string basePath = "../assets/"; // Adjust this if your assets are elsewhere
 
 const int WINDOW_WIDTH = 800;
@@ -45,108 +45,212 @@ bool rotateX = false;
 bool rotateY = false;
 bool rotateZ = false;
 
-// Removed global objectScale as it will be per-object
-
-int verticesToDraw = 0; // Number of vertices for the loaded OBJ model
+// Largest simplification error, in pixels on screen, accepted when choosing a level of detail
+const float LOD_MAX_PIXEL_ERROR = 1.0f;
+
+// Field of copies of the selected object toggled with I (instancing stress test: 100k copies)
+const int INSTANCE_FIELD_SIDE = 100;
+const int INSTANCE_FIELD_LAYERS = 10;
+const float INSTANCE_FIELD_SPACING = 1.0f;
+
+// Contiguous index range drawn with a single material (sorted by material in the mesh cache)
+struct SubmeshDraw {
+    GLsizei indexCount;
+    size_t indexByteOffset;
+    int material; // index into sceneMaterials
+    uint32_t firstMeshlet; // clusters of this submesh in SceneObject::meshlets (none = drawn whole)
+    uint32_t meshletCount;
+};
 
 // Structure to hold properties of each object in the scene
 struct SceneObject {
     GLuint VAO;
-    GLuint textureID;
-    int numVertices;
+    string texturePath;  // used by submeshes whose material has no map_Kd
+    GLuint textureID;    // texture array holding texturePath, filled by packSceneTextures
+    int textureLayer;
+    int numIndices;
+    GLenum indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    vector<SubmeshDraw> submeshes;
+    vector<MeshCacheLod> lods;   // submesh ranges, from full detail to coarsest
+    vector<Meshlet> meshlets;    // culled against the camera every frame
+    size_t indexSize;            // bytes per index
+    bool quantized;              // vertices in MESH_VERTEX_QUANTIZED format
+    glm::vec3 positionOffset;    // decode of quantized positions (mesh bounding box)
+    glm::vec3 positionScale;
     glm::vec3 position;
     glm::vec3 scale;
     float rotationAngle;
     glm::vec3 rotationAxis;
-    // You might want to add material properties here too if they differ per object
-    // glm::vec3 Ka, Kd, Ks;
-    // float Ns;
+    glm::vec3 boundsCenter;      // bounding sphere in object space (from the meshlets)
+    float boundsRadius;
+    vector<glm::vec3> copies;    // extra copies at these offsets from position, drawn instanced
+    InstanceBuffer instances;    // transforms of the visible copies, rebuilt every frame
+};
+
+// Instanced copy that passed frustum culling, with the level of detail for its distance
+struct VisibleCopy {
+    glm::vec3 position;
+    size_t level;
 };
 
 std::vector<SceneObject> sceneObjects; // List of objects in the scene
 int selectedObjectIndex = 0;          // Index of the currently selected object
 
 Camera camera;
+TextureManager textureManager; // decodes textures on worker threads; objects show a 1x1 placeholder meanwhile
 
 // Function Prototypes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void setupWindow(GLFWwindow*& window);
 void resetAllRotateFlags(); // Renamed from resetAllRotate to avoid confusion
-void readFromMtl(string path);
-int setupGeometry(const vector<GLfloat>& vertices, const vector<GLfloat>& textures, const vector<GLfloat>& normals, int& numVertices);
-int loadTexture(string path);
-void readFromObj(string path, vector<GLfloat>& out_vertices, vector<GLfloat>& out_textures, vector<GLfloat>& out_normals, string& out_mtlFilePath);
+void readFromMtl(string path, const CachedMesh& mesh, vector<SubmeshDraw>& out_submeshes);
+void packSceneTextures();
+int setupGeometry(const CachedMesh& mesh, int& numIndices, GLenum& indexType);
+size_t selectLod(const SceneObject& obj, const glm::vec3& position, int viewportHeight);
+ShaderFeatures submeshFeatures(const SceneObject& obj, const Material& material);
+void computeBounds(SceneObject& obj);
+void toggleInstanceField(SceneObject& obj);
+void readFromObj(string path, CachedMesh& out_mesh, string& out_mtlFilePath);
 
 int main()
 {
+    auto startTime = chrono::steady_clock::now();
     GLFWwindow* window;
     setupWindow(window);
+    textureManager.initialize();
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    // Initialize Shader
-    Shader shader("../shaders/sprite.vs", "../shaders/sprite.fs");
-    glUseProgram(shader.ID);
-    shader.setInt("tex_buffer", 0);
-
-    // Setup camera
-    camera.initialize(&shader, WINDOW_WIDTH, WINDOW_HEIGHT);
-
     // --- Object 1: Suzanne (main object) ---
-    vector<GLfloat> suzanne_vertices, suzanne_textures, suzanne_normals;
+    CachedMesh suzanne_mesh;
     string suzanne_mtlPath;
-    readFromObj(basePath + "Modelos3D/Suzanne.obj", suzanne_vertices, suzanne_textures, suzanne_normals, suzanne_mtlPath);
-    readFromMtl(basePath + "Modelos3D/" + suzanne_mtlPath); // Load Suzanne's material
-    GLuint suzanne_texID = loadTexture(basePath + "Modelos3D/Suzanne.png"); // Load Suzanne's texture
+    readFromObj(basePath + "Modelos3D/Suzanne.obj", suzanne_mesh, suzanne_mtlPath);
 
     SceneObject suzanne;
+    readFromMtl(basePath + "Modelos3D/" + suzanne_mtlPath, suzanne_mesh, suzanne.submeshes); // Suzanne's texture comes from map_Kd
     suzanne.position = glm::vec3(0.0f, 0.0f, 0.0f);
     suzanne.scale = glm::vec3(0.5f);
     suzanne.rotationAngle = 0.0f;
     suzanne.rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f); // Default rotation axis
-    suzanne.textureID = suzanne_texID;
-    suzanne.VAO = setupGeometry(suzanne_vertices, suzanne_textures, suzanne_normals, suzanne.numVertices);
+    suzanne.textureID = 0;
+    suzanne.textureLayer = -1;
+    suzanne.VAO = setupGeometry(suzanne_mesh, suzanne.numIndices, suzanne.indexType);
+    suzanne.quantized = suzanne_mesh.vertexFormat == MESH_VERTEX_QUANTIZED;
+    suzanne.positionOffset = suzanne_mesh.positionOffset;
+    suzanne.positionScale = suzanne_mesh.positionScale;
+    suzanne.lods = suzanne_mesh.lods;
+    suzanne.meshlets = suzanne_mesh.meshlets;
+    suzanne.indexSize = suzanne_mesh.indexSize;
     sceneObjects.push_back(suzanne);
 
     // --- Object 2: Cube ---
-    vector<GLfloat> cube_vertices, cube_textures, cube_normals;
+    CachedMesh cube_mesh;
     string cube_mtlPath;
-    readFromObj(basePath + "Modelos3D/Cube.obj", cube_vertices, cube_textures, cube_normals, cube_mtlPath);
-    // For simplicity, let's reuse Suzanne's material/texture for the cube or define new ones if needed.
-    // For this example, I'll just use Suzanne's texture for the cube as well.
-    // In a real application, you'd load Cube.mtl and Cube.png
-    GLuint cube_texID = loadTexture(basePath + "Modelos3D/Suzanne.png"); // Using Suzanne's texture for cube
+    readFromObj(basePath + "Modelos3D/Cube.obj", cube_mesh, cube_mtlPath);
+    // Cube.mtl has no materials, so the cube uses the default material and Suzanne's texture
 
     SceneObject cube;
+    readFromMtl(basePath + "Modelos3D/" + cube_mtlPath, cube_mesh, cube.submeshes);
     cube.position = glm::vec3(1.5f, 0.0f, 0.0f); // Position cube next to Suzanne
     cube.scale = glm::vec3(0.3f);
     cube.rotationAngle = 0.0f;
     cube.rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
-    cube.textureID = cube_texID;
-    cube.VAO = setupGeometry(cube_vertices, cube_textures, cube_normals, cube.numVertices);
+    cube.texturePath = basePath + "Modelos3D/Suzanne.png"; // Same file as Suzanne's map_Kd: shares its layer
+    cube.textureID = 0;
+    cube.textureLayer = -1;
+    cube.VAO = setupGeometry(cube_mesh, cube.numIndices, cube.indexType);
+    cube.quantized = cube_mesh.vertexFormat == MESH_VERTEX_QUANTIZED;
+    cube.positionOffset = cube_mesh.positionOffset;
+    cube.positionScale = cube_mesh.positionScale;
+    cube.lods = cube_mesh.lods;
+    cube.meshlets = cube_mesh.meshlets;
+    cube.indexSize = cube_mesh.indexSize;
     sceneObjects.push_back(cube);
 
+    packSceneTextures();
 
-    // Set initial lighting properties (these are general for the scene, not per-object for now)
-    shader.setVec3("material.Ka", Ka);
-    shader.setVec3("material.Kd", Kd);
-    shader.setVec3("material.Ks", Ks);
-    shader.setFloat("material.Ns", Ns);
+    // Instance buffers are created once the objects stop moving in sceneObjects
+    for (SceneObject& obj : sceneObjects) {
+        computeBounds(obj);
+        obj.instances.create(obj.VAO);
+    }
 
-    shader.setVec3("light.position", 1.0f, 1.0f, 1.0f);
-    shader.setVec3("light.ambient", 0.1f, 0.1f, 0.1f);
-    shader.setVec3("light.diffuse", 0.8f, 0.8f, 0.8f);
-    shader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+    // Shader variants: each submesh runs a program built only with the features it uses
+    // (light count, diffuse map and its source, specular term, quantized vertices)
+    ShaderVariants sprite("../shaders/sprite.vs", "../shaders/sprite.fs");
+    sprite.setOnCreate([](Shader& shader) {
+        shader.setInt("tex_array", 1); // TEXTURE_SOURCE_ARRAY variants only declare the array sampler
+    });
+
+    // Saving sprite.vs/sprite.fs recompiles the variants in the background (Linux, inotify)
+    ShaderWatcher shaderWatcher;
+    shaderWatcher.start(window);
+    sprite.setWatcher(&shaderWatcher);
+
+    // Variants used by the scene are compiled together, in parallel when the driver can
+    vector<ShaderFeatures> sceneFeatures;
+    for (const SceneObject& obj : sceneObjects) {
+        for (const SubmeshDraw& submesh : obj.submeshes) {
+            sceneFeatures.push_back(submeshFeatures(obj, sceneMaterials[submesh.material]));
+        }
+    }
+    sprite.prepare(sceneFeatures);
+
+    // Uniforms set per object/submesh are resolved once and work with every variant;
+    // the draw loop only indexes the handles
+    Uniform<glm::mat4> modelUniform = Shader::uniform<glm::mat4>("model");
+    Uniform<glm::vec3> posOffsetUniform = Shader::uniform<glm::vec3>("posOffset");
+    Uniform<glm::vec3> posScaleUniform = Shader::uniform<glm::vec3>("posScale");
+    Uniform<int> texLayerUniform = Shader::uniform<int>("texLayer");
+
+    // Setup camera (the variants bind the Camera block themselves)
+    camera.initialize(nullptr, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+
+    // Set initial lighting properties (these are general for the scene, not per-object for now).
+    // Lights and materials live in uniform buffers shared by every program (UniformBlocks.h)
+    // Only the key light is on: it is the first entry and the variants use NUM_POINT_LIGHTS 1
+    LightsBlock lights;
+    PointLightBlock& keyLight = lights.lights[0];
+    keyLight.position = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    keyLight.ambient = glm::vec4(0.1f, 0.1f, 0.1f, 0.0f);
+    keyLight.diffuse = glm::vec4(0.8f, 0.8f, 0.8f, 0.0f);
+    keyLight.specular = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+    UniformBuffer lightsBuffer;
+    lightsBuffer.create(UBO_BINDING_LIGHTS, sizeof(LightsBlock));
+    lightsBuffer.update(lights);
+
+    MaterialBuffer materialBuffer;
+    materialBuffer.upload(sceneMaterials);
 
     glEnable(GL_DEPTH_TEST); // Enable depth testing
+    // The meshlet cone test drops back-facing clusters, so the GPU must drop back faces too
+    // (OBJ faces are counter-clockwise seen from outside)
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CCW);
+
+    // Visible meshlet ranges of the submesh being drawn (glMultiDrawElements arguments)
+    vector<uint32_t> drawOffsets, drawCounts;
+    vector<GLsizei> multiCounts;
+    vector<const void*> multiOffsets;
+    MeshletCullStats cullStats;
+    // Visible instanced copies and, per level of detail, how many there are and where their
+    // range starts in the instance buffer
+    vector<VisibleCopy> visibleCopies;
+    vector<GLsizei> lodInstanceCounts, lodFirstInstance;
+    string windowTitle;
+    bool firstFrame = true;
 
     // Game loop
     while (!glfwWindowShouldClose(window))
     {
         glfwPollEvents();
+        textureManager.update(); // uploads the textures decoded since the last frame
+        shaderWatcher.update(); // swaps in shaders recompiled since the last frame
 
         int currentWidth, currentHeight;
         glfwGetFramebufferSize(window, &currentWidth, &currentHeight);
@@ -156,10 +260,21 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         camera.update(); // Update camera's view and projection matrices in the shader
+        Frustum frustum = extractFrustum(camera.getProjectionMatrix() * camera.getViewMatrix());
+        cullStats.reset();
+        size_t visibleInstances = 0, totalInstances = 0;
+
+        // Program, material and texture are only rebound when they change between submeshes
+        GLuint boundProgram = 0;
+        int boundMaterial = -1;
+        GLuint boundTexture = 0;
+        int boundLayer = -1;
+        glActiveTexture(GL_TEXTURE1);
 
         // Render all objects
         for (size_t i = 0; i < sceneObjects.size(); ++i) {
             SceneObject& obj = sceneObjects[i];
+            if (obj.lods.empty()) continue; // the OBJ failed to load: nothing to draw
 
             glm::mat4 model = glm::mat4(1);
 
@@ -182,24 +297,148 @@ int main()
             }
             model = glm::rotate(model, obj.rotationAngle, obj.rotationAxis);
 
-            shader.setMat4("model", model); // Send model matrix to shader
+            boundProgram = 0; // per-object uniforms go to each program the object uses
+
+            // Objects with copies are drawn instanced: one transform per visible copy (the object
+            // itself included), culled by bounding sphere. Each copy gets the level of detail for its
+            // own distance; the instance buffer holds the copies grouped by level, and each level
+            // draws its submeshes once for its range of instances
+            const bool instanced = !obj.copies.empty();
+            lodInstanceCounts.assign(obj.lods.size(), 0);
+            lodFirstInstance.assign(obj.lods.size(), 0);
+            if (instanced) {
+                const glm::vec3 center = glm::vec3(model * glm::vec4(obj.boundsCenter, 1.0f)) - obj.position;
+                const float radius = obj.boundsRadius * std::max(obj.scale.x, std::max(obj.scale.y, obj.scale.z));
+                visibleCopies.clear();
+                for (size_t c = 0; c <= obj.copies.size(); ++c) {
+                    const glm::vec3 position = obj.position + (c == 0 ? glm::vec3(0.0f) : obj.copies[c - 1]);
+                    if (!sphereInFrustum(frustum, position + center, radius)) continue;
+                    const size_t level = selectLod(obj, position, currentHeight);
+                    visibleCopies.push_back({ position, level });
+                    ++lodInstanceCounts[level];
+                }
+                for (size_t l = 1; l < obj.lods.size(); ++l) {
+                    lodFirstInstance[l] = lodFirstInstance[l - 1] + lodInstanceCounts[l - 1];
+                }
+                std::stable_sort(visibleCopies.begin(), visibleCopies.end(),
+                                 [](const VisibleCopy& a, const VisibleCopy& b) { return a.level < b.level; });
+
+                obj.instances.clear();
+                glm::mat4 copyModel = model;
+                for (const VisibleCopy& copy : visibleCopies) {
+                    copyModel[3] = glm::vec4(copy.position, 1.0f); // same scale and rotation, moved
+                    obj.instances.add(copyModel, glm::vec4(-1.0f)); // texture layer from the material
+                }
+                obj.instances.upload();
+                visibleInstances += obj.instances.size();
+                totalInstances += obj.copies.size() + 1;
+                if (obj.instances.size() == 0) continue;
+            } else {
+                lodInstanceCounts[selectLod(obj, obj.position, currentHeight)] = 1;
+            }
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, obj.textureID);
             glBindVertexArray(obj.VAO);
-            glDrawArrays(GL_TRIANGLES, 0, obj.numVertices);
+            for (size_t l = 0; l < obj.lods.size(); ++l) {
+                if (lodInstanceCounts[l] == 0) continue;
+
+                // Only the submeshes of the level of detail picked for this distance are drawn
+                const MeshCacheLod& lod = obj.lods[l];
+                for (uint32_t s = lod.firstSubmesh; s < lod.firstSubmesh + lod.submeshCount; ++s) {
+                    const SubmeshDraw& submesh = obj.submeshes[s];
+                    const Material& material = sceneMaterials[submesh.material];
+                    ShaderFeatures features = submeshFeatures(obj, material);
+                    features.instanced = instanced;
+                    Shader& shader = sprite.get(features);
+                    if (shader.ID != boundProgram) {
+                        glUseProgram(shader.ID);
+                        shader.set(modelUniform, model); // Send model matrix to shader (instanced variants read it per instance)
+                        // Quantized vertices are decoded in sprite.vs (QUANTIZED_NORMALS variants)
+                        shader.set(posOffsetUniform, obj.positionOffset);
+                        shader.set(posScaleUniform, obj.positionScale);
+                        boundProgram = shader.ID;
+                        boundLayer = -1; // texLayer is per program too
+                    }
+                    if (submesh.material != boundMaterial) {
+                        materialBuffer.bind(submesh.material);
+                        boundMaterial = submesh.material;
+                    }
+                    // Textures of the same size share one array, so usually only the layer changes
+                    GLuint texture = material.textureID != 0 ? material.textureID : obj.textureID;
+                    int layer = material.textureID != 0 ? material.textureLayer : obj.textureLayer;
+                    if (texture != boundTexture) {
+                        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+                        boundTexture = texture;
+                    }
+                    if (layer != boundLayer) {
+                        shader.set(texLayerUniform, layer);
+                        boundLayer = layer;
+                    }
+                    if (instanced) {
+                        obj.instances.drawElements(GL_TRIANGLES, submesh.indexCount, obj.indexType, submesh.indexByteOffset,
+                                                   lodFirstInstance[l], lodInstanceCounts[l]);
+                        continue;
+                    }
+                    if (submesh.meshletCount == 0) {
+                        glDrawElements(GL_TRIANGLES, submesh.indexCount, obj.indexType, (void*)submesh.indexByteOffset);
+                        continue;
+                    }
+
+                    // Only clusters inside the frustum and not entirely back-facing are drawn
+                    drawOffsets.clear();
+                    drawCounts.clear();
+                    cullMeshlets(&obj.meshlets[submesh.firstMeshlet], submesh.meshletCount, model, frustum, camera.getCameraPos(),
+                                 drawOffsets, drawCounts, cullStats);
+                    multiCounts.resize(drawCounts.size());
+                    multiOffsets.resize(drawOffsets.size());
+                    for (size_t d = 0; d < drawCounts.size(); ++d) {
+                        multiCounts[d] = (GLsizei)drawCounts[d];
+                        multiOffsets[d] = (const void*)(drawOffsets[d] * obj.indexSize);
+                    }
+                    if (!multiCounts.empty()) {
+                        glMultiDrawElements(GL_TRIANGLES, multiCounts.data(), obj.indexType, multiOffsets.data(), (GLsizei)multiCounts.size());
+                    }
+                }
+            }
             glBindVertexArray(0);
         }
 
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind texture
+        // Per-frame culling report in the title bar (only rewritten when the numbers change)
+        string title = "Vivencial 1 - Selecao e Transformacoes | triangles " +
+                       to_string(cullStats.triangles - cullStats.frustumCulled - cullStats.backfaceCulled) + "/" + to_string(cullStats.triangles) +
+                       ", frustum culled " + to_string(cullStats.frustumCulled) +
+                       ", backface culled " + to_string(cullStats.backfaceCulled);
+        if (totalInstances > 0) {
+            title += " | instances " + to_string(visibleInstances) + "/" + to_string(totalInstances);
+        }
+        if (title != windowTitle) {
+            glfwSetWindowTitle(window, title.c_str());
+            windowTitle = title;
+        }
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0); // Unbind texture
 
         glfwSwapBuffers(window);
+
+        if (firstFrame) {
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+            cout << "Time to first frame: " << ms << " ms" << endl;
+            // Cold start compiles every program; warm starts load the cached binaries
+            const ShaderCacheStats& shaderStats = getShaderCacheStats();
+            cout << "Shader programs: " << shaderStats.hits << " from cache (" << shaderStats.loadMs << " ms), "
+                 << shaderStats.misses << " compiled (" << shaderStats.compileMs << " ms)" << endl;
+            firstFrame = false;
+        }
     }
 
     // Clean up
-    for (const auto& obj : sceneObjects) {
+    for (auto& obj : sceneObjects) {
         glDeleteVertexArrays(1, &obj.VAO);
+        obj.instances.destroy();
     }
+    textureManager.shutdown();
+    lightsBuffer.destroy();
+    materialBuffer.destroy();
+    shaderWatcher.stop();
     glfwTerminate();
     return 0;
 }
@@ -255,6 +494,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             if (key == GLFW_KEY_P && action == GLFW_PRESS) { // Pause rotation
                 resetAllRotateFlags();
             }
+            if (key == GLFW_KEY_I && action == GLFW_PRESS) { // Field of instanced copies
+                toggleInstanceField(currentObject);
+            }
         }
     }
 
@@ -299,194 +541,162 @@ void resetAllRotateFlags() {
     rotateZ = false;
 }
 
-// Reads material properties from MTL file
-void readFromMtl(string path)
+// Reads every material of the MTL file into sceneMaterials and maps the mesh submeshes to them
+void readFromMtl(string path, const CachedMesh& mesh, vector<SubmeshDraw>& out_submeshes)
 {
-    string line, readValue;
-    ifstream mtlFile(path);
-
-    if (!mtlFile.is_open()) {
-        cerr << "Erro ao abrir arquivo MTL: " << path << endl;
-        // Set default material properties if file not found
-        Ka = glm::vec3(0.1f, 0.1f, 0.1f);
-        Kd = glm::vec3(0.7f, 0.7f, 0.7f);
-        Ks = glm::vec3(1.0f, 1.0f, 1.0f);
-        Ns = 32.0f;
-        textureFilePath = ""; // Clear any previous texture path
-        return;
+    const size_t firstMaterial = sceneMaterials.size();
+    loadMtl(path, sceneMaterials); // map_Kd paths are already relative to the MTL folder; loaded by packSceneTextures
+    // If the file is missing or a name is not found, submeshes use the default material (index 0).
+    // Only this file's materials are searched, so equal names in other files don't clash
+    vector<int> materialIds = resolveMaterials(sceneMaterials, firstMaterial, mesh.materialNames, 0);
+    out_submeshes.clear();
+    const size_t indexSize = mesh.indexSize;
+    for (const MeshCacheSubmesh& submesh : mesh.submeshes) {
+        SubmeshDraw draw;
+        draw.indexCount = submesh.indexCount;
+        draw.indexByteOffset = submesh.indexOffset * indexSize;
+        draw.material = 0;
+        draw.firstMeshlet = submesh.firstMeshlet;
+        draw.meshletCount = mesh.meshletCount(&submesh - mesh.submeshes.data());
+        if (submesh.materialId != MESH_NO_MATERIAL) {
+            draw.material = materialIds[submesh.materialId];
+        }
+        out_submeshes.push_back(draw);
     }
+}
 
-    // Default values in case they are not specified in the MTL
-    Ka = glm::vec3(0.1f, 0.1f, 0.1f);
-    Kd = glm::vec3(0.7f, 0.7f, 0.7f);
-    Ks = glm::vec3(1.0f, 1.0f, 1.0f);
-    Ns = 32.0f;
-
-    while (getline(mtlFile, line))
-    {
-        istringstream iss(line);
-        string prefix;
-        iss >> prefix;
+// Packs the map_Kd of every material and the texture of every object into texture arrays
+// (one per image size), so the draw loop binds a single texture for the whole scene
+void packSceneTextures()
+{
+    vector<string> paths;
+    for (const Material& material : sceneMaterials) {
+        if (!material.map_Kd.empty()) paths.push_back(material.map_Kd);
+    }
+    for (const SceneObject& obj : sceneObjects) {
+        if (!obj.texturePath.empty()) paths.push_back(obj.texturePath);
+    }
 
-        if (prefix == "map_Kd")
-        {
-            iss >> textureFilePath;
-        }
-        else if (prefix == "Ka")
-        {
-            iss >> Ka.x >> Ka.y >> Ka.z;
-        }
-        else if (prefix == "Kd")
-        {
-            iss >> Kd.x >> Kd.y >> Kd.z;
-        }
-        else if (prefix == "Ks")
-        {
-            iss >> Ks.x >> Ks.y >> Ks.z;
-        }
-        else if (prefix == "Ns")
-        {
-            iss >> Ns;
-        }
+    vector<TextureLayer> layers = textureManager.requestArray(paths);
+    size_t next = 0;
+    for (Material& material : sceneMaterials) {
+        if (material.map_Kd.empty()) continue;
+        material.textureID = layers[next].array;
+        material.textureLayer = layers[next++].layer;
+    }
+    for (SceneObject& obj : sceneObjects) {
+        if (obj.texturePath.empty()) continue;
+        obj.textureID = layers[next].array;
+        obj.textureLayer = layers[next++].layer;
     }
-    mtlFile.close();
 }
 
-// Setup VAO and VBOs for object geometry
-int setupGeometry(const vector<GLfloat>& vertices_in, const vector<GLfloat>& textures_in, const vector<GLfloat>& normals_in, int& numVertices)
+// Setup VAO, interleaved VBO and EBO for indexed object geometry
+int setupGeometry(const CachedMesh& mesh, int& numIndices, GLenum& indexType)
 {
-    GLuint VAO, VBO[3];
+    GLuint VAO, VBO, EBO;
 
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(3, VBO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, vertices_in.size() * sizeof(GLfloat), vertices_in.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0); // Position
-    glEnableVertexAttribArray(0);
+    // Vertex and index blobs come straight from the mapped mesh cache
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertices, GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-    glBufferData(GL_ARRAY_BUFFER, textures_in.size() * sizeof(GLfloat), textures_in.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0); // Texture coordinates
-    glEnableVertexAttribArray(1);
+    // Position, texture coordinates and normal, in the vertex format stored in the cache
+    Mesh::setupVertexAttributes(mesh);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
-    glBufferData(GL_ARRAY_BUFFER, normals_in.size() * sizeof(GLfloat), normals_in.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0); // Normals
-    glEnableVertexAttribArray(2);
+    // Element buffer is recorded in the VAO, so it must be bound before unbinding the VAO
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indices, GL_STATIC_DRAW);
+    indexType = (mesh.indexSize == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    numIndices = mesh.indexCount;
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    numVertices = vertices_in.size() / 3; // Each vertex has 3 floats for position
-
     return VAO;
 }
 
-// Loads a texture from a file
-int loadTexture(string path)
-{
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data) {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        cout << "Failed to load texture: " << path << endl;
-    }
-
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    return texID;
+// Shader variant of a submesh: one light (the key light), the object's vertex format and what
+// its material actually uses
+ShaderFeatures submeshFeatures(const SceneObject& obj, const Material& material) {
+    ShaderFeatures features;
+    features.numPointLights = 1;
+    features.hasDiffuseMap = material.textureID != 0 || obj.textureID != 0;
+    features.hasSpecular = materialHasSpecular(material);
+    features.quantizedNormals = obj.quantized;
+    features.textureSource = TEXTURE_SOURCE_ARRAY; // every scene texture is a layer of a texture array
+    return features;
 }
 
-// Reads OBJ file data
-void readFromObj(string path, vector<GLfloat>& out_vertices, vector<GLfloat>& out_textures, vector<GLfloat>& out_normals, string& out_mtlFilePath) {
-    std::ifstream file(path);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+// Bounding sphere of the whole mesh, enclosing the bounding spheres of its meshlets
+void computeBounds(SceneObject& obj) {
+    if (obj.meshlets.empty()) {
+        obj.boundsCenter = glm::vec3(0.0f);
+        obj.boundsRadius = 1e30f; // never culled
         return;
     }
+    glm::vec3 boundsMin(1e30f), boundsMax(-1e30f);
+    for (const Meshlet& meshlet : obj.meshlets) {
+        const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+        boundsMin = glm::min(boundsMin, center - meshlet.radius);
+        boundsMax = glm::max(boundsMax, center + meshlet.radius);
+    }
+    obj.boundsCenter = (boundsMin + boundsMax) * 0.5f;
+    obj.boundsRadius = 0.0f;
+    for (const Meshlet& meshlet : obj.meshlets) {
+        const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+        obj.boundsRadius = std::max(obj.boundsRadius, glm::length(center - obj.boundsCenter) + meshlet.radius);
+    }
+}
 
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_textures;
-    std::vector<glm::vec3> temp_normais;
-
-    std::string line;
-
-    // Clear output vectors for new object
-    out_vertices.clear();
-    out_textures.clear();
-    out_normals.clear();
-
-    while (std::getline(file, line)) {
-        if (line.length() > 0) {
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
-
-            if (prefix == "v") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                temp_vertices.push_back(values);
-            } else if (prefix == "vt") {
-                glm::vec2 values;
-                iss >> values.x >> values.y;
-                temp_textures.push_back(values);
-            } else if (prefix == "vn") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                temp_normais.push_back(values);
-            } else if (prefix == "f") {
-                for (int i = 0; i < 3; ++i) { // Assuming triangular faces
-                    unsigned int vertexIndex, textIndex, normalIndex;
-                    char slash;
-
-                    iss >> vertexIndex >> slash >> textIndex >> slash >> normalIndex;
-
-                    // OBJ indices are 1-based, convert to 0-based
-                    out_vertices.push_back(temp_vertices[vertexIndex - 1].x);
-                    out_vertices.push_back(temp_vertices[vertexIndex - 1].y);
-                    out_vertices.push_back(temp_vertices[vertexIndex - 1].z);
-
-                    out_textures.push_back(temp_textures[textIndex - 1].x);
-                    out_textures.push_back(1.0f - temp_textures[textIndex - 1].y); // Flip V coordinate for OpenGL
-
-                    out_normals.push_back(temp_normais[normalIndex - 1].x);
-                    out_normals.push_back(temp_normais[normalIndex - 1].y);
-                    out_normals.push_back(temp_normais[normalIndex - 1].z);
-                }
-            } else if (prefix == "mtllib") {
-                iss >> out_mtlFilePath;
-            }
-        }
+// Fills a grid below the object with copies of it, or removes them
+void toggleInstanceField(SceneObject& obj) {
+    if (!obj.copies.empty()) {
+        obj.copies.clear();
+        return;
     }
-    file.close();
-    std::cout << "OBJ file loaded: " << path << std::endl;
-}                 out_normals.push_back(temp_normais[normalIndex - 1].x);
-                    out_normals.push_back(temp_normais[normalIndex - 1].y);
-                    out_normals.push_back(temp_normais[normalIndex - 1].z);
-                }
-            } else if (prefix == "mtllib") {
-                iss >> out_mtlFilePath;
+    obj.copies.reserve((size_t)INSTANCE_FIELD_SIDE * INSTANCE_FIELD_SIDE * INSTANCE_FIELD_LAYERS);
+    for (int y = 0; y < INSTANCE_FIELD_LAYERS; ++y) {
+        for (int z = 0; z < INSTANCE_FIELD_SIDE; ++z) {
+            for (int x = 0; x < INSTANCE_FIELD_SIDE; ++x) {
+                obj.copies.push_back(glm::vec3(x - (INSTANCE_FIELD_SIDE - 1) * 0.5f, -1.0f - y, z - (INSTANCE_FIELD_SIDE - 1) * 0.5f) * INSTANCE_FIELD_SPACING);
             }
         }
     }
-    file.close();
-    std::cout << "OBJ file loaded: " << path << std::endl;
-}
\ No newline at end of file
+    cout << "Instance field: " << obj.copies.size() << " copies" << endl;
+}
+
+// Index of the coarsest level whose simplification error projects to at most LOD_MAX_PIXEL_ERROR
+// pixels for a copy of the object at position (obj.lods must not be empty: objects whose OBJ
+// failed to load are skipped before this)
+size_t selectLod(const SceneObject& obj, const glm::vec3& position, int viewportHeight) {
+    float distance = glm::length(camera.getCameraPos() - position);
+    float scale = std::max(obj.scale.x, std::max(obj.scale.y, obj.scale.z));
+    // Pixels per world unit at this distance: projection[1][1] = 1 / tan(fovy / 2)
+    float pixelsPerUnit = camera.getProjectionMatrix()[1][1] * viewportHeight * 0.5f / std::max(distance, 0.001f);
+
+    size_t chosen = 0;
+    for (size_t i = 1; i < obj.lods.size(); ++i) {
+        if (obj.lods[i].error * scale * pixelsPerUnit > LOD_MAX_PIXEL_ERROR) break;
+        chosen = i;
+    }
+    return chosen;
+}
+
+// Reads OBJ file data (through the binary mesh cache in Common/MeshCache)
+void readFromObj(string path, CachedMesh& out_mesh, string& out_mtlFilePath) {
+    MeshCacheOptions options;
+    options.vertexFormat = MESH_VERTEX_QUANTIZED; // 16 bytes per vertex instead of 32
+    options.lod.ratios = { 0.5f, 0.25f, 0.125f };  // simplified levels stored in the cache with the full mesh
+    if (!loadCachedMesh(path, out_mesh, options)) {
+        return;
+    }
+    printMeshCacheStats(path, out_mesh);
+
+    out_mtlFilePath = out_mesh.mtlLib;
+}
@@ -10,6 +10,7 @@
 #include <cmath>
 #include <cstdio>
 #include <random>
+#include <chrono>
 
 using namespace std;
 
@@ -24,12 +25,18 @@ using namespace std;
 
 #include "Shader.h"
 #include "Camera.h" 
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "Material.h"
+#include "TextureManager.h"
+#include "UniformBlocks.h"
+#include "ShaderVariants.h"
+#include "ShaderWatcher.h"
 
 
-glm::vec3 Ka_material; 
-glm::vec3 Kd_material; 
-glm::vec3 Ks_material; 
-float Ns_material;     
+vector<Material> materials(1); 
+CachedMesh global_mesh; 
+vector<int> submeshMaterials; 
 
 string mtlFilePath = "";
 string textureFilePath = "";
@@ -44,7 +51,8 @@ bool rotateY = false;
 bool rotateZ = false;
 float objectScale = 0.5f; 
 
-int verticesToDraw = 0; 
+int indicesToDraw = 0; 
+GLenum indexType = GL_UNSIGNED_INT; 
 
 
 struct PointLight {
@@ -63,42 +71,61 @@ PointLight keyLight;
 PointLight fillLight;
 PointLight backLight;
 
+LightsBlock lightsBlock;
+int lightMask = -1;
+int enabledLights = 0;
+UniformBuffer lightsBuffer;
+MaterialBuffer materialBuffer;
+
 Camera camera; 
+TextureManager textureManager; 
 
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void setupWindow(GLFWwindow*& window);
-void setupShaderLightsAndMaterials(Shader& shader); 
+void setupLightsAndMaterials();
 void readFromMtl(string path);
 int setupGeometry();
-int loadTexture(string path);
 void readFromObj(string path);
 void configureLights(const glm::vec3& objectPosition, float objectRadius);
-void updateLightUniforms(Shader& shader);
+int updateLightUniforms();
+ShaderFeatures materialFeatures(const Material& material, int numLights);
 
 int main()
 {
+    auto startTime = chrono::steady_clock::now();
     GLFWwindow* window;
     setupWindow(window);
+    textureManager.initialize();
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    Shader shader("../shaders/sprite.vs", "../shaders/sprite.fs");
-    glUseProgram(shader.ID);
-    shader.setInt("tex_buffer", 0);
-
-    
-    camera.initialize(&shader, WINDOW_WIDTH, WINDOW_HEIGHT);
-
     readFromObj(basePath + "Modelos3D/Suzanne.obj"); 
-    readFromMtl(basePath + "Modelos3D/Suzanne.mtl"); 
-    GLuint texID = loadTexture(basePath + "Modelos3D/Suzanne.png"); 
+    readFromMtl(basePath + "Modelos3D/" + mtlFilePath); 
 
     GLuint VAO = setupGeometry();
 
+    // one program per material/light combination, with only the code it needs
+    ShaderVariants sprite("../shaders/sprite.vs", "../shaders/sprite.fs");
+    sprite.setOnCreate([](Shader& shader) {
+        shader.setInt("tex_buffer", 0);
+        shader.setVec3("posOffset", global_mesh.positionOffset);
+        shader.setVec3("posScale", global_mesh.positionScale);
+    });
+
+    // shader edits are picked up while running (Linux, inotify)
+    ShaderWatcher shaderWatcher;
+    shaderWatcher.start(window);
+    sprite.setWatcher(&shaderWatcher);
+
+    
+    camera.initialize(nullptr, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    Uniform<glm::mat4> modelUniform = Shader::uniform<glm::mat4>("model");
+
     
     glm::vec3 suzannePosition = glm::vec3(0.0f, 0.0f, 0.0f);
     float suzanneRadius = 0.5f; 
@@ -107,14 +134,22 @@ int main()
     configureLights(suzannePosition, suzanneRadius);
 
     
-    setupShaderLightsAndMaterials(shader); 
+    setupLightsAndMaterials();
+
+    // variants of every material with all lights on, compiled together
+    vector<ShaderFeatures> sceneFeatures;
+    for (const Material& material : materials) sceneFeatures.push_back(materialFeatures(material, enabledLights));
+    sprite.prepare(sceneFeatures);
 
     glEnable(GL_DEPTH_TEST);
+    bool firstFrame = true;
 
     
     while (!glfwWindowShouldClose(window))
     {
         glfwPollEvents();
+        textureManager.update();
+        shaderWatcher.update();
 
         int currentWidth, currentHeight;
         glfwGetFramebufferSize(window, &currentWidth, &currentHeight);
@@ -135,22 +170,46 @@ int main()
         if (rotateY) model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         if (rotateZ) model = glm::rotate(model, angle, glm::vec3(0.0f, 0.0f, 1.0f));
 
-        shader.setMat4("model", model); 
-
         
-        updateLightUniforms(shader);
+        int numLights = updateLightUniforms();
 
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texID);
         glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, verticesToDraw);
+        // level 0 covers the whole mesh; lods is empty when the OBJ failed to load
+        const uint32_t submeshCount = global_mesh.lods.empty() ? 0 : global_mesh.lods[0].submeshCount;
+        GLuint boundProgram = 0;
+        for (size_t i = 0; i < submeshCount; ++i) {
+            const MeshCacheSubmesh& submesh = global_mesh.submeshes[i];
+            const Material& material = materials[submeshMaterials[i]];
+            Shader& shader = sprite.get(materialFeatures(material, numLights));
+            if (shader.ID != boundProgram) {
+                glUseProgram(shader.ID);
+                shader.set(modelUniform, model);
+                boundProgram = shader.ID;
+            }
+            materialBuffer.bind(submeshMaterials[i]);
+            glBindTexture(GL_TEXTURE_2D, material.textureID);
+            glDrawElements(GL_TRIANGLES, submesh.indexCount, indexType, (void*)(size_t)(submesh.indexOffset * global_mesh.indexSize));
+        }
         glBindVertexArray(0);
         glBindTexture(GL_TEXTURE_2D, 0);
 
         glfwSwapBuffers(window);
+
+        if (firstFrame) {
+            cout << "Time to first frame: " << chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count() << " ms" << endl;
+            const ShaderCacheStats& shaderStats = getShaderCacheStats();
+            cout << "Shader programs: " << shaderStats.hits << " from cache (" << shaderStats.loadMs << " ms), "
+                 << shaderStats.misses << " compiled (" << shaderStats.compileMs << " ms)" << endl;
+            firstFrame = false;
+        }
     }
 
     glDeleteVertexArrays(1, &VAO);
+    textureManager.shutdown();
+    lightsBuffer.destroy();
+    materialBuffer.destroy();
+    shaderWatcher.stop();
     glfwTerminate();
     return 0;
 }
@@ -240,130 +299,101 @@ void configureLights(const glm::vec3& objectPosition, float objectRadius) {
 }
 
 
-void setupShaderLightsAndMaterials(Shader& shader) {
-    
-    shader.setVec3("material.Ka", Ka_material);
-    shader.setVec3("material.Kd", Kd_material);
-    shader.setVec3("material.Ks", Ks_material);
-    shader.setFloat("material.Ns", Ns_material);
+PointLightBlock toLightBlock(const PointLight& light) {
+    PointLightBlock block;
+    block.position = glm::vec4(light.position, 1.0f);
+    block.ambient = glm::vec4(light.ambient, 0.0f);
+    block.diffuse = glm::vec4(light.diffuse, 0.0f);
+    block.specular = glm::vec4(light.specular, 0.0f);
+    block.constant = light.constant;
+    block.linear = light.linear;
+    block.quadratic = light.quadratic;
+    return block;
+}
 
-    
-    shader.setVec3("keyLight.position", keyLight.position);
-    shader.setVec3("keyLight.ambient", keyLight.ambient);
-    shader.setVec3("keyLight.diffuse", keyLight.diffuse);
-    shader.setVec3("keyLight.specular", keyLight.specular);
-    shader.setFloat("keyLight.constant", keyLight.constant);
-    shader.setFloat("keyLight.linear", keyLight.linear);
-    shader.setFloat("keyLight.quadratic", keyLight.quadratic);
 
-    
-    shader.setVec3("fillLight.position", fillLight.position);
-    shader.setVec3("fillLight.ambient", fillLight.ambient);
-    shader.setVec3("fillLight.diffuse", fillLight.diffuse);
-    shader.setVec3("fillLight.specular", fillLight.specular);
-    shader.setFloat("fillLight.constant", fillLight.constant);
-    shader.setFloat("fillLight.linear", fillLight.linear);
-    shader.setFloat("fillLight.quadratic", fillLight.quadratic);
+void setupLightsAndMaterials() {
+    lightsBuffer.create(UBO_BINDING_LIGHTS, sizeof(LightsBlock));
+    lightMask = -1;
+    updateLightUniforms();
 
-    
-    shader.setVec3("backLight.position", backLight.position);
-    shader.setVec3("backLight.ambient", backLight.ambient);
-    shader.setVec3("backLight.diffuse", backLight.diffuse);
-    shader.setVec3("backLight.specular", backLight.specular);
-    shader.setFloat("backLight.constant", backLight.constant);
-    shader.setFloat("backLight.linear", backLight.linear);
-    shader.setFloat("backLight.quadratic", backLight.quadratic);
+    materialBuffer.upload(materials);
+}
+
+
+// The lights that are on are packed at the front of the block and the shader variant only
+// evaluates those; the block is only re-sent when a light was toggled
+int updateLightUniforms() {
+    const PointLight* lights[MAX_POINT_LIGHTS] = { &keyLight, &fillLight, &backLight };
+    int mask = 0;
+    for (int i = 0; i < MAX_POINT_LIGHTS; ++i) {
+        if (lights[i]->enabled) mask |= 1 << i;
+    }
+    if (mask == lightMask) return enabledLights;
+
+    lightMask = mask;
+    enabledLights = 0;
+    lightsBlock = LightsBlock();
+    for (int i = 0; i < MAX_POINT_LIGHTS; ++i) {
+        if (lights[i]->enabled) lightsBlock.lights[enabledLights++] = toLightBlock(*lights[i]);
+    }
+    lightsBuffer.update(lightsBlock);
+    return enabledLights;
 }
 
 
-void updateLightUniforms(Shader& shader) {
-    shader.setBool("keyLight.enabled", keyLight.enabled);
-    shader.setBool("fillLight.enabled", fillLight.enabled);
-    shader.setBool("backLight.enabled", backLight.enabled);
+ShaderFeatures materialFeatures(const Material& material, int numLights) {
+    ShaderFeatures features;
+    features.numPointLights = numLights;
+    features.hasDiffuseMap = material.textureID != 0;
+    features.hasSpecular = materialHasSpecular(material);
+    features.quantizedNormals = global_mesh.vertexFormat == MESH_VERTEX_QUANTIZED;
+    features.textureSource = TEXTURE_SOURCE_2D;
+    return features;
 }
 
 
 void readFromMtl(string path)
 {
-    string line, readValue;
-    ifstream mtlFile(path);
+    materials.resize(1); 
 
-    if (!mtlFile.is_open()) {
-        cerr << "Erro ao abrir arquivo MTL: " << path << endl;
-        
-        Ka_material = glm::vec3(0.1f, 0.1f, 0.1f);
-        Kd_material = glm::vec3(0.7f, 0.7f, 0.7f);
-        Ks_material = glm::vec3(1.0f, 1.0f, 1.0f);
-        Ns_material = 32.0f;
-        textureFilePath = ""; 
-        return;
+    if (loadMtl(path, materials)) {
+        for (size_t i = 1; i < materials.size(); ++i) {
+            if (!materials[i].map_Kd.empty()) {
+                materials[i].textureID = textureManager.request(materials[i].map_Kd);
+            }
+        }
     }
 
     
-    Ka_material = glm::vec3(0.1f, 0.1f, 0.1f);
-    Kd_material = glm::vec3(0.7f, 0.7f, 0.7f);
-    Ks_material = glm::vec3(1.0f, 1.0f, 1.0f);
-    Ns_material = 32.0f;
-
-    while (getline(mtlFile, line))
-    {
-        istringstream iss(line);
-        string prefix;
-        iss >> prefix;
-
-        if (prefix == "map_Kd")
-        {
-            iss >> textureFilePath;
-        }
-        else if (prefix == "Ka")
-        {
-            iss >> Ka_material.x >> Ka_material.y >> Ka_material.z;
-        }
-        else if (prefix == "Kd")
-        {
-            iss >> Kd_material.x >> Kd_material.y >> Kd_material.z;
-        }
-        else if (prefix == "Ks")
-        {
-            iss >> Ks_material.x >> Ks_material.y >> Ks_material.z;
-        }
-        else if (prefix == "Ns")
-        {
-            iss >> Ns_material;
-        }
+    vector<int> materialIds = resolveMaterials(materials, 1, global_mesh.materialNames, 0);
+    submeshMaterials.clear();
+    for (const MeshCacheSubmesh& submesh : global_mesh.submeshes) {
+        submeshMaterials.push_back(submesh.materialId != MESH_NO_MATERIAL ? materialIds[submesh.materialId] : 0);
     }
-    mtlFile.close();
 }
 
 
-vector<GLfloat> global_vertices;
-vector<GLfloat> global_textures;
-vector<GLfloat> global_normals;
 
 
 int setupGeometry()
 {
-    GLuint VAO, VBO[3];
+    GLuint VAO, VBO, EBO;
 
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(3, VBO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, global_vertices.size() * sizeof(GLfloat), global_vertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0); 
-    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, global_mesh.vertexBytes(), global_mesh.vertices, GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-    glBufferData(GL_ARRAY_BUFFER, global_textures.size() * sizeof(GLfloat), global_textures.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0); 
-    glEnableVertexAttribArray(1);
+    Mesh::setupVertexAttributes(global_mesh);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
-    glBufferData(GL_ARRAY_BUFFER, global_normals.size() * sizeof(GLfloat), global_normals.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0); 
-    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, global_mesh.indexBytes(), global_mesh.indices, GL_STATIC_DRAW);
+    indexType = (global_mesh.indexSize == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
@@ -372,97 +402,14 @@ int setupGeometry()
 }
 
 
-int loadTexture(string path)
-{
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data) {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        cout << "Failed to load texture: " << path << endl;
-    }
-
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    return texID;
-}
-
-
 void readFromObj(string path) {
-    std::ifstream file(path);
-
-    if (!file.is_open()) {
-        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+    MeshCacheOptions options;
+    options.vertexFormat = MESH_VERTEX_QUANTIZED;
+    if (!loadCachedMesh(path, global_mesh, options)) {
         return;
     }
+    printMeshCacheStats(path, global_mesh);
 
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_textures;
-    std::vector<glm::vec3> temp_normais;
-
-    std::string line;
-
-    
-    global_vertices.clear();
-    global_textures.clear();
-    global_normals.clear();
-
-    while (std::getline(file, line)) {
-        if (line.length() > 0) {
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
-
-            if (prefix == "v") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                temp_vertices.push_back(values);
-            } else if (prefix == "vt") {
-                glm::vec2 values;
-                iss >> values.x >> values.y;
-                temp_textures.push_back(values);
-            } else if (prefix == "vn") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                temp_normais.push_back(values);
-            } else if (prefix == "f") {
-                for (int i = 0; i < 3; ++i) { 
-                    unsigned int vertexIndex, textIndex, normalIndex;
-                    char slash;
-
-                    iss >> vertexIndex >> slash >> textIndex >> slash >> normalIndex;
-
-                    
-                    global_vertices.push_back(temp_vertices[vertexIndex - 1].x);
-                    global_vertices.push_back(temp_vertices[vertexIndex - 1].y);
-                    global_vertices.push_back(temp_vertices[vertexIndex - 1].z);
-
-                    global_textures.push_back(temp_textures[textIndex - 1].x);
-                    global_textures.push_back(1.0f - temp_textures[textIndex - 1].y); 
-
-                    global_normals.push_back(temp_normais[normalIndex - 1].x);
-                    global_normals.push_back(temp_normais[normalIndex - 1].y);
-                    global_normals.push_back(temp_normais[normalIndex - 1].z);
-                }
-            } else if (prefix == "mtllib") {
-                iss >> mtlFilePath;
-            }
-        }
-    }
-    file.close();
-    verticesToDraw = global_vertices.size() / 3;
-    std::cout << "OBJ file loaded: " << path << ". Total vertices for drawing: " << verticesToDraw << std::endl;
+    mtlFilePath = global_mesh.mtlLib;
+    indicesToDraw = global_mesh.indexCount;
 }
\ No newline at end of file
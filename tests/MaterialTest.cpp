@@ -0,0 +1,132 @@
+// Leitura de .mtl (loadMtl, Common/Material.h) com respostas conhecidas.
+//
+// Cada material do arquivo sintético tem mapas com opções antes do nome do arquivo: -o e -s com
+// 1, 2 ou 3 números (inclusive negativos), -bm (que vira bumpMultiplier), -mm, -clamp e -imfchan.
+// As opções têm que ser puladas por inteiro e o resto da linha tem que ser o arquivo, resolvido
+// em relação à pasta do .mtl: nomes com espaço, nomes que começam com dígito ("1.png", que não é
+// mais um número de -s) e caminhos absolutos. Um bloco usa fim de linha CRLF.
+//
+// Uso: MaterialTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
+
+#include "Material.h"
+
+using namespace std;
+
+namespace
+{
+    const char* const MTL_TEXT =
+        "# materiais de teste\n"
+        "newmtl Pedra\n"
+        "Ka 0.2 0.2 0.2\n"
+        "Kd 0.5 0.25 0.125\n"
+        "Ns 64\n"
+        "map_Kd -o 0.5 0.5 0 -s 2 2 1 texturas/pedra.png\n"
+        "map_Bump -bm 0.35 texturas/pedra_normal.png\n"
+        "\n"
+        "newmtl Madeira\n"
+        "Tr 0.25\n"
+        "map_Kd -s 4 madeira escura.png\n"
+        "bump -bm 2 -o 0.1 0.2 -clamp on relevo madeira.png\n"
+        "map_Ks -s -1 1 1.png\n"
+        "\n"
+        "newmtl Metal\r\n"
+        "illum 3\r\n"
+        "map_Kd -o 1 -s 1 2 metal.png\r\n"
+        "map_bump -imfchan l -bm 0.5 metal_relevo.png\r\n"
+        "map_d -mm 0 1 /abs/alpha.png\r\n"
+        "\n"
+        "newmtl Simples\n"
+        "map_Kd simples.png\n";
+
+    struct Expected
+    {
+        const char* name;
+        const char* map_Kd;
+        const char* map_Ks;
+        const char* map_Bump;
+        const char* map_d;
+        float bumpMultiplier;
+        float d;
+        int illum;
+    };
+
+    // Caminhos relativos à pasta do .mtl; "/..." fica como está
+    const Expected EXPECTED[] = {
+        { "Pedra", "texturas/pedra.png", "", "texturas/pedra_normal.png", "", 0.35f, 1.0f, 2 },
+        { "Madeira", "madeira escura.png", "1.png", "relevo madeira.png", "", 2.0f, 0.75f, 2 },
+        { "Metal", "metal.png", "", "metal_relevo.png", "/abs/alpha.png", 0.5f, 1.0f, 3 },
+        { "Simples", "simples.png", "", "", "", 1.0f, 1.0f, 2 },
+    };
+
+    string resolved(const string& directory, const char* file)
+    {
+        if (*file == '\0') return string();
+        return *file == '/' ? string(file) : directory + file;
+    }
+
+    bool check(const char* what, const string& got, const string& want, const string& name)
+    {
+        if (got == want) return true;
+        cerr << "FAIL: " << name << ": " << what << " is \"" << got << "\", expected \"" << want << "\"" << endl;
+        return false;
+    }
+}
+
+int main()
+{
+    const filesystem::path path = filesystem::temp_directory_path() / "MaterialTest.mtl";
+    FILE* f = fopen(path.string().c_str(), "wb");
+    if (!f || fputs(MTL_TEXT, f) < 0 || fclose(f) != 0)
+    {
+        cerr << "FAIL: could not write " << path.string() << endl;
+        return 1;
+    }
+
+    vector<Material> materials;
+    materials.emplace_back(); // material já existente: loadMtl acrescenta depois dele
+    const bool loaded = loadMtl(path.string(), materials);
+    filesystem::remove(path);
+
+    const size_t expectedCount = sizeof(EXPECTED) / sizeof(EXPECTED[0]);
+    if (!loaded || materials.size() != expectedCount + 1)
+    {
+        cerr << "FAIL: loadMtl returned " << loaded << " with " << materials.size() - 1 << " materials, expected " << expectedCount << endl;
+        return 1;
+    }
+
+    const string directory = path.parent_path().string() + "/";
+    bool ok = true;
+    for (size_t i = 0; i < expectedCount; ++i)
+    {
+        const Expected& e = EXPECTED[i];
+        const Material& m = materials[i + 1];
+        bool materialOk = check("name", m.name, e.name, e.name);
+        materialOk = check("map_Kd", m.map_Kd, resolved(directory, e.map_Kd), e.name) && materialOk;
+        materialOk = check("map_Ks", m.map_Ks, resolved(directory, e.map_Ks), e.name) && materialOk;
+        materialOk = check("map_Bump", m.map_Bump, resolved(directory, e.map_Bump), e.name) && materialOk;
+        materialOk = check("map_d", m.map_d, resolved(directory, e.map_d), e.name) && materialOk;
+        if (m.bumpMultiplier != e.bumpMultiplier || std::fabs(m.d - e.d) > 1e-6f || m.illum != e.illum)
+        {
+            cerr << "FAIL: " << e.name << ": bumpMultiplier " << m.bumpMultiplier << ", d " << m.d << ", illum " << m.illum << endl;
+            materialOk = false;
+        }
+        printf("%-10s %s\n", e.name, materialOk ? "ok" : "FAIL");
+        ok = materialOk && ok;
+    }
+
+    // Valores numéricos do primeiro bloco
+    const Material& pedra = materials[1];
+    if (pedra.Kd != glm::vec3(0.5f, 0.25f, 0.125f) || pedra.Ka != glm::vec3(0.2f) || pedra.Ns != 64.0f)
+    {
+        cerr << "FAIL: Pedra: Ka, Kd or Ns" << endl;
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
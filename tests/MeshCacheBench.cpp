@@ -0,0 +1,129 @@
+// Carga fria x carga quente do cache binário de malhas (.vbm, Common/MeshCache).
+//
+// O .obj é copiado para a pasta temporária, sem .vbm ao lado: a primeira loadCachedMesh
+// lê, solda, otimiza e grava o cache (fria); as seguintes só mapeiam o .vbm (quente).
+// Falha se a carga quente não vier do cache ou se os blocos de vértices, índices,
+// submalhas e níveis de detalhe forem diferentes dos gerados na carga fria. Com o .obj
+// tocado (data nova, mesmo conteúdo), o cache tem que ser aceito pelo hash e passar a
+// guardar a data nova, para que as cargas seguintes não precisem de hash.
+//
+// Uso: MeshCacheBench [arquivo.obj ...]   (padrão: Suzanne.obj e SuzanneSubdiv1.obj)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+
+#include "MeshCache.h"
+#include "FileHash.h"
+
+using namespace std;
+
+namespace
+{
+    double elapsedMs(chrono::steady_clock::time_point start)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    bool sameMesh(const CachedMesh& a, const CachedMesh& b)
+    {
+        return a.vertexFormat == b.vertexFormat && a.vertexStride == b.vertexStride &&
+               a.vertexCount == b.vertexCount && a.indexSize == b.indexSize && a.indexCount == b.indexCount &&
+               memcmp(a.vertices, b.vertices, a.vertexBytes()) == 0 &&
+               memcmp(a.indices, b.indices, a.indexBytes()) == 0 &&
+               a.submeshes.size() == b.submeshes.size() &&
+               memcmp(a.submeshes.data(), b.submeshes.data(), a.submeshes.size() * sizeof(MeshCacheSubmesh)) == 0 &&
+               a.lods.size() == b.lods.size() &&
+               memcmp(a.lods.data(), b.lods.data(), a.lods.size() * sizeof(MeshCacheLod)) == 0 &&
+               a.meshlets.size() == b.meshlets.size() &&
+               a.materialNames == b.materialNames && a.mtlLib == b.mtlLib;
+    }
+
+    bool benchFile(const string& source, int warmRepeats)
+    {
+        const filesystem::path objPath = filesystem::temp_directory_path() / filesystem::path(source).filename();
+        filesystem::copy_file(source, objPath, filesystem::copy_options::overwrite_existing);
+        filesystem::remove(meshCachePath(objPath.string()));
+
+        CachedMesh cold;
+        auto start = chrono::steady_clock::now();
+        bool ok = loadCachedMesh(objPath.string(), cold);
+        const double coldMs = elapsedMs(start);
+
+        double warmMs = 1e30;
+        for (int i = 0; ok && i < warmRepeats; ++i)
+        {
+            CachedMesh warm;
+            start = chrono::steady_clock::now();
+            ok = loadCachedMesh(objPath.string(), warm);
+            warmMs = min(warmMs, elapsedMs(start));
+            if (ok && (!warm.fromCache || !sameMesh(cold, warm)))
+            {
+                cerr << "FAIL: " << source << ": warm load " << (warm.fromCache ? "differs from the cold load" : "did not use the cache") << endl;
+                ok = false;
+            }
+        }
+
+        if (ok)
+        {
+            // Mesmo conteúdo com outra data
+            filesystem::last_write_time(objPath, filesystem::last_write_time(objPath) + chrono::hours(1));
+            uint64_t size = 0;
+            int64_t time = 0;
+            CachedMesh touched;
+            ok = sourceInfo(objPath.string(), size, time) && loadCachedMesh(objPath.string(), touched) && touched.fromCache;
+
+            MeshCacheHeader header = {};
+            FILE* f = fopen(meshCachePath(objPath.string()).c_str(), "rb");
+            const bool read = f && fread(&header, sizeof(header), 1, f) == 1;
+            if (f) fclose(f);
+            if (!ok || !read || header.sourceTime != time)
+            {
+                cerr << "FAIL: " << source << ": after touching the .obj the cache was " << (ok ? "not refreshed" : "rebuilt") << endl;
+                ok = false;
+            }
+        }
+
+        if (ok)
+        {
+            cout << filesystem::path(source).filename().string() << ": " << cold.vertexCount << " vertices, "
+                 << cold.indexCount / 3 << " triangles\n"
+                 << "  cold (parse + optimize + write) " << coldMs << " ms\n"
+                 << "  warm (mapped .vbm, best of " << warmRepeats << ") " << warmMs << " ms\n"
+                 << "  speedup " << coldMs / warmMs << "x" << endl;
+        }
+        else if (cold.vertexCount == 0)
+        {
+            cerr << "FAIL: could not load " << source << endl;
+        }
+
+        filesystem::remove(meshCachePath(objPath.string()));
+        filesystem::remove(objPath);
+        return ok;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    vector<string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        files.push_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        files = { string(ASSETS_DIR) + "Suzanne.obj", string(ASSETS_DIR) + "SuzanneSubdiv1.obj" };
+    }
+
+    bool ok = true;
+    for (const string& file : files)
+    {
+        ok = benchFile(file, 5) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,310 @@
+// Simplificação por erro quádrico (Common/MeshSimplifier.h) com respostas conhecidas.
+//
+// Grades de 16 x 16 células, planas (z = 0) ou com relevo senoidal. A plana é simplificada ao
+// máximo com erro quase zero; a com relevo, até 10% dos triângulos com erro alto, onde só a
+// classificação dos vértices segura a forma:
+//   - borda aberta: a projeção em XY cobre o quadrado exatamente uma vez (amostras numa grade),
+//     as arestas abertas que sobram ficam sobre os lados e os cantos não somem;
+//   - costura: a coluna x = 8 tem vértices duplicados (uv de duas ilhas). Nenhum triângulo pode
+//     misturar as ilhas, cada ilha cobre a sua metade e os dois lados da costura continuam usando
+//     as mesmas posições (sem rasgo).
+// Lod::error de generateLods: (quase) zero na grade plana; num relevo senoidal, igual à maior distância
+// de um vértice do nível 0 aos triângulos de cada nível, calculada aqui por força bruta.
+//
+// Uso: MeshSimplifierTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+
+#include "MeshSimplifier.h"
+
+using namespace std;
+
+namespace
+{
+    const int N = 16;
+
+    struct Grid
+    {
+        vector<float> positions; // 3 floats por vértice
+        vector<int> island;      // ilha de uv de cada vértice
+        vector<uint32_t> indices;
+    };
+
+    // Grade (N + 1) x (N + 1); com seam, os vértices da coluna N / 2 existem uma vez por ilha
+    Grid makeGrid(bool seam, float (*height)(int, int))
+    {
+        Grid grid;
+        vector<uint32_t> left((N + 1) * (N + 1)), right((N + 1) * (N + 1));
+        for (int y = 0; y <= N; ++y)
+        {
+            for (int x = 0; x <= N; ++x)
+            {
+                const int copies = (seam && x == N / 2) ? 2 : 1;
+                for (int copy = 0; copy < copies; ++copy)
+                {
+                    const uint32_t v = (uint32_t)grid.island.size();
+                    grid.positions.insert(grid.positions.end(), { (float)x, (float)y, height(x, y) });
+                    const int island = seam && (x > N / 2 || (x == N / 2 && copy == 1)) ? 1 : 0;
+                    grid.island.push_back(island);
+                    if (island == 0 || copies == 1) left[y * (N + 1) + x] = v;
+                    if (island == 1 || copies == 1) right[y * (N + 1) + x] = v;
+                }
+            }
+        }
+        for (int y = 0; y < N; ++y)
+        {
+            for (int x = 0; x < N; ++x)
+            {
+                const vector<uint32_t>& side = (seam && x >= N / 2) ? right : left;
+                const uint32_t a = side[y * (N + 1) + x], b = side[y * (N + 1) + x + 1];
+                const uint32_t d = side[(y + 1) * (N + 1) + x], e = side[(y + 1) * (N + 1) + x + 1];
+                grid.indices.insert(grid.indices.end(), { a, b, e, a, e, d });
+            }
+        }
+        return grid;
+    }
+
+    float flat(int, int) { return 0.0f; }
+    float waves(int x, int y) { return (float)(1.5 * sin(x * 0.6) * sin(y * 0.5)); }
+
+    float signedArea2d(const Grid& grid, const uint32_t* tri)
+    {
+        const float* a = &grid.positions[tri[0] * 3];
+        const float* b = &grid.positions[tri[1] * 3];
+        const float* c = &grid.positions[tri[2] * 3];
+        return 0.5f * ((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]));
+    }
+
+    bool insideTriangle2d(const Grid& grid, const uint32_t* tri, float px, float py)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const float* a = &grid.positions[tri[k] * 3];
+            const float* b = &grid.positions[tri[(k + 1) % 3] * 3];
+            if ((b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0]) <= 0.0f) return false;
+        }
+        return true;
+    }
+
+    // Cada amostra em [x0, x1] x [0, N] coberta por exatamente um dos triângulos da ilha
+    bool coversOnce(const Grid& grid, const vector<uint32_t>& indices, int island, float x0, float x1, const string& name)
+    {
+        const int samples = 64;
+        for (int sy = 0; sy < samples; ++sy)
+        {
+            for (int sx = 0; sx < samples; ++sx)
+            {
+                const float px = x0 + (x1 - x0) * (sx + 0.37f) / samples, py = N * (sy + 0.61f) / samples;
+                int covered = 0;
+                for (size_t i = 0; i < indices.size(); i += 3)
+                    if ((island < 0 || grid.island[indices[i]] == island) && insideTriangle2d(grid, &indices[i], px, py)) ++covered;
+                if (covered != 1)
+                {
+                    cerr << "FAIL: " << name << ": point (" << px << ", " << py << ") covered by " << covered << " triangles" << endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    vector<uint32_t> simplify(const Grid& grid, size_t target, float maxError, float& error)
+    {
+        vector<uint32_t> out(grid.indices.size());
+        const size_t count = simplifyMesh(grid.indices.data(), grid.indices.size(), grid.positions.data(), 3, grid.island.size(),
+                                          target, maxError, out.data(), &error);
+        out.resize(count);
+        return out;
+    }
+
+    // Arestas abertas do resultado (sem a aresta oposta): todas têm que estar sobre um lado do
+    // quadrado ou sobre a costura, e os quatro cantos do quadrado continuam lá
+    bool keepsOutline(const Grid& grid, const vector<uint32_t>& out, bool seam, const string& name)
+    {
+        set<pair<uint32_t, uint32_t>> edges;
+        for (size_t i = 0; i < out.size(); i += 3)
+            for (int k = 0; k < 3; ++k) edges.insert({ out[i + k], out[i + (k + 1) % 3] });
+
+        auto onLine = [](float a, float b, bool seam) { return a == b && (a == 0.0f || a == N || (seam && a == N / 2)); };
+        for (const auto& edge : edges)
+        {
+            if (edges.count({ edge.second, edge.first })) continue;
+            const float* a = &grid.positions[edge.first * 3];
+            const float* b = &grid.positions[edge.second * 3];
+            if (!onLine(a[0], b[0], seam) && !onLine(a[1], b[1], false))
+            {
+                cerr << "FAIL: " << name << ": open edge (" << a[0] << ", " << a[1] << ") - (" << b[0] << ", " << b[1] << ") left the outline" << endl;
+                return false;
+            }
+        }
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            const float cx = (corner & 1) ? (float)N : 0.0f, cy = (corner & 2) ? (float)N : 0.0f;
+            bool found = false;
+            for (uint32_t v : out) found = found || (grid.positions[v * 3] == cx && grid.positions[v * 3 + 1] == cy);
+            if (!found)
+            {
+                cerr << "FAIL: " << name << ": corner (" << cx << ", " << cy << ") was collapsed" << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Na plana o erro tem que ficar em zero e nenhum triângulo pode virar; com relevo a normal
+    // varia e só a cobertura em XY conta
+    bool testBorder(const char* name, float (*height)(int, int))
+    {
+        const bool isFlat = height == flat;
+        const Grid grid = makeGrid(false, height);
+        float error = 1.0f;
+        const vector<uint32_t> out = simplify(grid, isFlat ? 0 : grid.indices.size() / 10 / 3 * 3, isFlat ? 1e-3f : 100.0f, error);
+        bool ok = true;
+        for (size_t i = 0; i < out.size() && ok && isFlat; i += 3)
+        {
+            if (signedArea2d(grid, &out[i]) <= 0.0f)
+            {
+                cerr << "FAIL: " << name << ": triangle " << i / 3 << " flipped or degenerate" << endl;
+                ok = false;
+            }
+        }
+        ok = ok && coversOnce(grid, out, -1, 0.0f, (float)N, name);
+        ok = ok && keepsOutline(grid, out, false, name);
+        if (ok && ((isFlat && error > 1e-6f) || out.size() / 3 > grid.indices.size() / 3 / 8))
+        {
+            cerr << "FAIL: " << name << ": " << out.size() / 3 << " triangles left with error " << error << endl;
+            ok = false;
+        }
+        printf("%-28s %zu -> %zu triangles, error %g  %s\n", name, grid.indices.size() / 3, out.size() / 3, error, ok ? "ok" : "FAIL");
+        return ok;
+    }
+
+    bool testSeam(const char* name, float (*height)(int, int))
+    {
+        const bool isFlat = height == flat;
+        const Grid grid = makeGrid(true, height);
+        float error = 1.0f;
+        const vector<uint32_t> out = simplify(grid, isFlat ? 0 : grid.indices.size() / 10 / 3 * 3, isFlat ? 1e-3f : 100.0f, error);
+        bool ok = true;
+        for (size_t i = 0; i < out.size() && ok; i += 3)
+        {
+            if (grid.island[out[i]] != grid.island[out[i + 1]] || grid.island[out[i]] != grid.island[out[i + 2]])
+            {
+                cerr << "FAIL: " << name << ": triangle " << i / 3 << " mixes both uv islands" << endl;
+                ok = false;
+            }
+        }
+        ok = ok && coversOnce(grid, out, 0, 0.0f, N / 2.0f, name + string(", left island"));
+        ok = ok && coversOnce(grid, out, 1, N / 2.0f, (float)N, name + string(", right island"));
+        ok = ok && keepsOutline(grid, out, true, name);
+
+        // Posições da costura usadas por cada lado
+        set<float> seamLeft, seamRight;
+        for (uint32_t v : out)
+        {
+            if (grid.positions[v * 3] != N / 2) continue;
+            (grid.island[v] == 0 ? seamLeft : seamRight).insert(grid.positions[v * 3 + 1]);
+        }
+        if (ok && seamLeft != seamRight)
+        {
+            cerr << "FAIL: " << name << ": the two sides use " << seamLeft.size() << " and " << seamRight.size() << " seam positions" << endl;
+            ok = false;
+        }
+        if (ok && ((isFlat && error > 1e-6f) || out.size() / 3 > grid.indices.size() / 3 / 4))
+        {
+            cerr << "FAIL: " << name << ": " << out.size() / 3 << " triangles left with error " << error << endl;
+            ok = false;
+        }
+        printf("%-28s %zu -> %zu triangles, %zu seam vertices  %s\n", name, grid.indices.size() / 3, out.size() / 3,
+               seamLeft.size(), ok ? "ok" : "FAIL");
+        return ok;
+    }
+
+    // Distância de p ao triângulo abc por força bruta: projeção no plano se cair dentro, senão a
+    // menor distância às três arestas
+    float pointTriangleDistance(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        const glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+        const glm::vec3 q = p - normal * glm::dot(p - a, normal);
+        if (glm::dot(glm::cross(b - a, q - a), normal) >= 0.0f && glm::dot(glm::cross(c - b, q - b), normal) >= 0.0f &&
+            glm::dot(glm::cross(a - c, q - c), normal) >= 0.0f)
+            return glm::length(p - q);
+
+        float best = 1e30f;
+        const glm::vec3 corners[3] = { a, b, c };
+        for (int k = 0; k < 3; ++k)
+        {
+            const glm::vec3 e0 = corners[k], e1 = corners[(k + 1) % 3];
+            const float t = std::clamp(glm::dot(p - e0, e1 - e0) / glm::dot(e1 - e0, e1 - e0), 0.0f, 1.0f);
+            best = std::min(best, glm::length(p - (e0 + (e1 - e0) * t)));
+        }
+        return best;
+    }
+
+    bool testLodError(const char* name, float (*height)(int, int), bool expectZero)
+    {
+        const Grid grid = makeGrid(false, height);
+        IndexedMesh mesh;
+        mesh.positions = grid.positions;
+        mesh.texcoords.assign(grid.island.size() * 2, 0.0f);
+        mesh.normals.assign(grid.island.size() * 3, 0.0f);
+        mesh.indices = grid.indices;
+        mesh.submeshes.push_back({ 0, (uint32_t)grid.indices.size(), -1 });
+        MeshLodOptions options;
+        options.ratios = { 0.5f, 0.25f };
+        generateLods(mesh, options);
+
+        bool ok = mesh.lods.size() == 3 && mesh.lods[0].error == 0.0f;
+        if (!ok) cerr << "FAIL: " << name << ": " << mesh.lods.size() << " levels" << endl;
+        for (size_t l = 1; l < mesh.lods.size() && ok; ++l)
+        {
+            const IndexedMesh::Lod& lod = mesh.lods[l];
+            float expected = 0.0f;
+            for (size_t v = 0; v < grid.island.size(); ++v)
+            {
+                const glm::vec3 p(mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2]);
+                float best = 1e30f;
+                for (uint32_t s = 0; s < lod.submeshCount; ++s)
+                {
+                    const IndexedMesh::Submesh& submesh = mesh.submeshes[lod.firstSubmesh + s];
+                    for (uint32_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; i += 3)
+                    {
+                        auto corner = [&](uint32_t k) {
+                            const uint32_t c = mesh.indices[i + k];
+                            return glm::vec3(mesh.positions[c * 3], mesh.positions[c * 3 + 1], mesh.positions[c * 3 + 2]);
+                        };
+                        best = std::min(best, pointTriangleDistance(p, corner(0), corner(1), corner(2)));
+                    }
+                }
+                expected = std::max(expected, best);
+            }
+            expected = std::max(expected, mesh.lods[l - 1].error);
+
+            if (std::fabs(lod.error - expected) > 1e-4f + 1e-3f * expected || (expectZero && lod.error > 1e-5f) || (!expectZero && lod.error <= 0.0f))
+            {
+                cerr << "FAIL: " << name << ": level " << l << " reports error " << lod.error << ", measured " << expected << endl;
+                ok = false;
+            }
+            printf("%-28s level %zu: error %.5f, measured %.5f\n", name, l, lod.error, expected);
+        }
+        printf("%-28s %s\n", name, ok ? "ok" : "FAIL");
+        return ok;
+    }
+}
+
+int main()
+{
+    bool ok = testBorder("open border, flat", flat);
+    ok = testBorder("open border, waves", waves) && ok;
+    ok = testSeam("uv seam, flat", flat) && ok;
+    ok = testSeam("uv seam, waves", waves) && ok;
+    ok = testLodError("Lod::error, flat grid", flat, true) && ok;
+    ok = testLodError("Lod::error, waves", waves, false) && ok;
+    return ok ? 0 : 1;
+}
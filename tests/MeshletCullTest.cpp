@@ -0,0 +1,167 @@
+// Meshlets e descarte na CPU (Common/Meshlet.h) com respostas conhecidas.
+//
+// Um cubo de lado 2 com normais por face: cada face tem a sua grade de 7 x 7 células (64 vértices,
+// 98 triângulos, anti-horária vista de fora), então vira exatamente um meshlet, com cone de
+// abertura zero ao longo da normal da face. Com a câmera de frente para uma face, as outras cinco
+// estão de costas e têm que ser descartadas pelo cone; de um canto, três ficam visíveis em três
+// faixas, e duas faces vizinhas no buffer viram uma faixa só. Com a câmera virada para o outro
+// lado, tudo sai pelo frustum. Uma matriz model com translação, escala e rotação de 180 graus
+// confere que o cone é testado no espaço do objeto (a face visível passa a ser a de trás) e que o
+// raio da esfera acompanha a escala. Os triângulos das faixas desenhadas têm que ser exatamente
+// os da(s) face(s) visível(is).
+//
+// Uso: MeshletCullTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Meshlet.h"
+
+using namespace std;
+
+namespace
+{
+    const int CELLS = 7;
+    const size_t FACE_TRIANGLES = CELLS * CELLS * 2;
+
+    // Eixos das faces, na ordem em que entram no buffer: +x, -x, +y, -y, +z, -z
+    const glm::vec3 FACE_NORMALS[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+    IndexedMesh makeCube()
+    {
+        IndexedMesh mesh;
+        for (const glm::vec3& n : FACE_NORMALS)
+        {
+            // Base (u, v) com u x v = n, para que os quads fiquem anti-horários vistos de fora
+            const glm::vec3 u = std::fabs(n.x) > 0.5f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+            const glm::vec3 v = glm::cross(n, u);
+            const uint32_t base = (uint32_t)mesh.vertexCount();
+            for (int j = 0; j <= CELLS; ++j)
+            {
+                for (int i = 0; i <= CELLS; ++i)
+                {
+                    const glm::vec3 p = n + u * (2.0f * i / CELLS - 1.0f) + v * (2.0f * j / CELLS - 1.0f);
+                    mesh.positions.insert(mesh.positions.end(), { p.x, p.y, p.z });
+                    mesh.normals.insert(mesh.normals.end(), { n.x, n.y, n.z });
+                    mesh.texcoords.insert(mesh.texcoords.end(), { (float)i / CELLS, (float)j / CELLS });
+                }
+            }
+            for (int j = 0; j < CELLS; ++j)
+            {
+                for (int i = 0; i < CELLS; ++i)
+                {
+                    const uint32_t a = base + j * (CELLS + 1) + i, b = a + 1, c = a + CELLS + 2, d = a + CELLS + 1;
+                    mesh.indices.insert(mesh.indices.end(), { a, b, c, a, c, d });
+                }
+            }
+        }
+        mesh.submeshes.push_back({ 0, (uint32_t)mesh.indices.size(), -1 });
+        return mesh;
+    }
+
+    // Face (0 .. 5) de um triângulo, pela normal geométrica
+    int triangleFace(const IndexedMesh& mesh, const uint32_t* tri)
+    {
+        glm::vec3 p[3];
+        for (int k = 0; k < 3; ++k) p[k] = glm::vec3(mesh.positions[tri[k] * 3], mesh.positions[tri[k] * 3 + 1], mesh.positions[tri[k] * 3 + 2]);
+        const glm::vec3 normal = glm::normalize(glm::cross(p[1] - p[0], p[2] - p[0]));
+        for (int f = 0; f < 6; ++f)
+            if (glm::dot(normal, FACE_NORMALS[f]) > 0.99f) return f;
+        return -1;
+    }
+
+    bool testBuild(const IndexedMesh& mesh, const vector<Meshlet>& meshlets)
+    {
+        bool ok = meshlets.size() == 6;
+        for (size_t m = 0; m < meshlets.size() && ok; ++m)
+        {
+            const Meshlet& meshlet = meshlets[m];
+            const glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+            const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+            ok = meshlet.indexOffset == m * FACE_TRIANGLES * 3 && meshlet.indexCount == FACE_TRIANGLES * 3 &&
+                 meshlet.coneCutoff < 1e-3f && glm::dot(axis, FACE_NORMALS[m]) > 0.9999f &&
+                 glm::length(center - FACE_NORMALS[m]) < 1e-5f && std::fabs(meshlet.radius - std::sqrt(2.0f)) < 1e-5f;
+            for (uint32_t i = 0; i < meshlet.indexCount && ok; i += 3)
+                ok = triangleFace(mesh, &mesh.indices[meshlet.indexOffset + i]) == (int)m;
+            if (!ok) cerr << "FAIL: build: meshlet " << m << " is not face " << m << " with a closed cone along its normal" << endl;
+        }
+        if (meshlets.size() != 6) cerr << "FAIL: build: " << meshlets.size() << " meshlets, expected 6" << endl;
+        printf("%-34s %zu meshlets  %s\n", "build", meshlets.size(), ok ? "ok" : "FAIL");
+        return ok;
+    }
+
+    // visibleFaces: máscara das faces (no espaço do objeto) que têm que ser desenhadas
+    bool testView(const char* name, const IndexedMesh& mesh, const vector<Meshlet>& meshlets, const glm::mat4& model,
+                  const glm::vec3& eye, const glm::vec3& target, int visibleFaces, size_t expectedBackface, size_t expectedFrustum,
+                  size_t expectedDraws)
+    {
+        const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f) * glm::lookAt(eye, target, glm::vec3(0, 1, 0));
+        const Frustum frustum = extractFrustum(viewProjection);
+        vector<uint32_t> offsets, counts;
+        MeshletCullStats stats;
+        cullMeshlets(meshlets.data(), meshlets.size(), model, frustum, eye, offsets, counts, stats);
+
+        bool ok = stats.meshlets == 6 && stats.triangles == 6 * FACE_TRIANGLES && stats.backfaceCulled == expectedBackface &&
+                  stats.frustumCulled == expectedFrustum && stats.drawCalls == expectedDraws && offsets.size() == expectedDraws;
+        if (!ok)
+        {
+            cerr << "FAIL: " << name << ": " << stats.backfaceCulled << " backface and " << stats.frustumCulled << " frustum culled in "
+                 << stats.drawCalls << " draws, expected " << expectedBackface << ", " << expectedFrustum << " and " << expectedDraws << endl;
+        }
+
+        int drawnFaces = 0;
+        size_t drawnTriangles = 0;
+        for (size_t r = 0; r < offsets.size() && ok; ++r)
+        {
+            for (uint32_t i = 0; i < counts[r]; i += 3)
+            {
+                const int face = triangleFace(mesh, &mesh.indices[offsets[r] + i]);
+                drawnFaces |= face >= 0 ? 1 << face : 0;
+                ++drawnTriangles;
+            }
+        }
+        if (ok && (drawnFaces != visibleFaces || drawnTriangles + expectedBackface + expectedFrustum != 6 * FACE_TRIANGLES))
+        {
+            cerr << "FAIL: " << name << ": drew faces 0x" << hex << drawnFaces << ", expected 0x" << visibleFaces << dec << endl;
+            ok = false;
+        }
+        printf("%-34s %zu triangles drawn in %zu draws  %s\n", name, drawnTriangles, stats.drawCalls, ok ? "ok" : "FAIL");
+        return ok;
+    }
+}
+
+int main()
+{
+    IndexedMesh mesh = makeCube();
+    vector<Meshlet> meshlets;
+    vector<uint32_t> firstMeshlet;
+    buildMeshlets(mesh, meshlets, firstMeshlet);
+
+    bool ok = testBuild(mesh, meshlets);
+    if (!ok) return 1;
+
+    const glm::mat4 identity(1.0f);
+    const size_t face = FACE_TRIANGLES;
+    ok = testView("facing +z", mesh, meshlets, identity, glm::vec3(0, 0, 10), glm::vec3(0), 1 << 4, 5 * face, 0, 1) && ok;
+    ok = testView("off-centre, facing +z", mesh, meshlets, identity, glm::vec3(0.5f, -0.4f, 6), glm::vec3(0.5f, -0.4f, 0), 1 << 4, 5 * face, 0, 1) && ok;
+    ok = testView("corner (+x, +y, +z)", mesh, meshlets, identity, glm::vec3(6, 6, 6), glm::vec3(0), 1 | 1 << 2 | 1 << 4, 3 * face, 0, 3) && ok;
+    ok = testView("edge (-x, +y), one range", mesh, meshlets, identity, glm::vec3(-6, 6, 0), glm::vec3(0), 1 << 1 | 1 << 2, 4 * face, 0, 1) && ok;
+    ok = testView("looking away", mesh, meshlets, identity, glm::vec3(0, 0, 10), glm::vec3(0, 0, 20), 0, 0, 6 * face, 0) && ok;
+
+    // Cubo levado para (20, 0, -30), com escala 3 e virado de costas: a face -z fica de frente para +z
+    glm::mat4 model = glm::translate(identity, glm::vec3(20, 0, -30));
+    model = glm::scale(model, glm::vec3(3.0f));
+    model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0, 1, 0));
+    ok = testView("model rotated 180 degrees", mesh, meshlets, model, glm::vec3(20, 0, -10), glm::vec3(20, 0, -30), 1 << 5, 5 * face, 0, 1) && ok;
+    // Centro da face visível 1 unidade além do plano longe (100): só o raio escalado (3 * raiz(2))
+    // a mantém; a face oposta fica além de qualquer raio
+    ok = testView("model at the far plane", mesh, meshlets, model, glm::vec3(20, 0, 74), glm::vec3(20, 0, -30), 1 << 5, 4 * face, face, 1) && ok;
+    ok = testView("model outside the frustum", mesh, meshlets, model, glm::vec3(20, 0, -10), glm::vec3(20, 0, 10), 0, 0, 6 * face, 0) && ok;
+    return ok ? 0 : 1;
+}
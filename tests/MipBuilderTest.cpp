@@ -0,0 +1,100 @@
+// Caminhos escalar, SSE2 e AVX2 de downsampleRgba (Common/MipBuilder).
+//
+// As versões vetoriais precisam dar exatamente os mesmos bytes que a escalar, em sRGB e linear,
+// inclusive com largura ou altura ímpar e com largura ou altura 1. Depois mede cada caminho
+// numa imagem grande. Só são testados os caminhos que a CPU suporta (até mipSimdPath()).
+//
+// Uso: MipBuilderTest [lado [repeticoes]]   (padrão: imagem de 2048x2048 para a medição, 5 repetições)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <utility>
+
+#include "MipBuilder.h"
+
+using namespace std;
+
+namespace
+{
+    vector<uint8_t> randomImage(uint32_t width, uint32_t height, uint32_t seed)
+    {
+        vector<uint8_t> rgba((size_t)width * height * 4);
+        for (uint8_t& value : rgba)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            value = (uint8_t)(seed >> 24);
+        }
+        return rgba;
+    }
+
+    vector<MipSimdPath> availablePaths()
+    {
+        vector<MipSimdPath> paths = { MIP_SCALAR };
+        if (mipSimdPath() >= MIP_SSE2) paths.push_back(MIP_SSE2);
+        if (mipSimdPath() >= MIP_AVX2) paths.push_back(MIP_AVX2);
+        return paths;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t side = argc > 1 ? (uint32_t)atoi(argv[1]) : 2048;
+    const int repeats = argc > 2 ? atoi(argv[2]) : 5;
+    const vector<MipSimdPath> paths = availablePaths();
+    bool ok = true;
+
+    // Tamanhos que exercitam o fim de linha dos laços vetoriais (4 e 8 pixels de saída por passo)
+    const pair<uint32_t, uint32_t> sizes[] = {
+        { 1, 1 }, { 2, 1 }, { 1, 2 }, { 1, 7 }, { 7, 1 }, { 1, 64 }, { 64, 1 }, { 3, 3 }, { 5, 9 },
+        { 17, 1 }, { 1, 17 }, { 17, 3 }, { 31, 33 }, { 255, 129 }, { 256, 256 }, { 1023, 511 }
+    };
+    size_t compared = 0;
+    for (const auto& size : sizes)
+    {
+        const vector<uint8_t> image = randomImage(size.first, size.second, size.first * 131 + size.second);
+        for (bool srgb : { true, false })
+        {
+            vector<uint8_t> reference, result;
+            downsampleRgba(image.data(), size.first, size.second, reference, srgb, MIP_SCALAR);
+            for (MipSimdPath path : paths)
+            {
+                if (path == MIP_SCALAR) continue;
+                downsampleRgba(image.data(), size.first, size.second, result, srgb, path);
+                ++compared;
+                if (result != reference)
+                {
+                    cerr << "FAIL: " << mipSimdPathName(path) << " differs from scalar at " << size.first << "x" << size.second
+                         << (srgb ? " (sRGB)" : " (linear)") << endl;
+                    ok = false;
+                }
+            }
+        }
+    }
+    cout << compared << " SIMD results compared against scalar (best path on this CPU: " << mipSimdPathName(mipSimdPath()) << ")" << endl;
+
+    // Medição: um nível a partir de side x side, melhor de repeats
+    const vector<uint8_t> image = randomImage(side, side, 7);
+    vector<uint8_t> out;
+    double scalarMs = 0.0;
+    for (MipSimdPath path : paths)
+    {
+        double best = 1e30;
+        for (int i = 0; i < repeats; ++i)
+        {
+            auto start = chrono::steady_clock::now();
+            downsampleRgba(image.data(), side, side, out, true, path);
+            best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        }
+        if (path == MIP_SCALAR) scalarMs = best;
+        printf("%-6s %ux%u -> %ux%u  %8.3f ms  %8.1f MPix/s  %5.2fx\n", mipSimdPathName(path), side, side,
+               max(1u, side / 2), max(1u, side / 2), best, (double)side * side / (best * 1000.0), scalarMs / best);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+// Benchmark e teste de loadObj (Common/ObjLoader).
+//
+// Compara o leitor mapeado em memória com uma leitura por istringstream equivalente
+// à usada antes dele, no SuzanneSubdiv1.obj e num .obj sintético gerado na pasta temporária.
+// Os dois leitores precisam produzir exatamente os mesmos valores.
+//
+// Uso: ObjLoaderBench [triangulos [repeticoes]]
+//   padrão: 200000 triângulos, 3 repetições (rápido o bastante para o ctest)
+//   ObjLoaderBench 10000000 é a medição com 10M de triângulos (~700 MB em disco)
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <filesystem>
+
+#include "ObjLoader.h"
+
+using namespace std;
+
+namespace
+{
+    // Leitura linha a linha com istringstream (somente v, vt, vn e triângulos v/vt/vn)
+    bool loadObjStream(const string& path, ObjModel& model)
+    {
+        ifstream file(path);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        model.clear();
+
+        string line;
+        while (getline(file, line))
+        {
+            istringstream ss(line);
+            string word;
+            ss >> word;
+            if (word == "v")
+            {
+                glm::vec3 p;
+                ss >> p.x >> p.y >> p.z;
+                model.positions.push_back(p);
+            }
+            else if (word == "vt")
+            {
+                glm::vec2 t;
+                ss >> t.x >> t.y;
+                model.texcoords.push_back(t);
+            }
+            else if (word == "vn")
+            {
+                glm::vec3 n;
+                ss >> n.x >> n.y >> n.z;
+                model.normals.push_back(n);
+            }
+            else if (word == "f")
+            {
+                string corner;
+                while (ss >> corner)
+                {
+                    ObjIndex idx = { -1, -1, -1 };
+                    sscanf(corner.c_str(), "%d/%d/%d", &idx.v, &idx.vt, &idx.vn);
+                    idx.v -= 1;
+                    idx.vt -= 1;
+                    idx.vn -= 1;
+                    model.corners.push_back(idx);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Grade de vértices com dois triângulos por célula; 1000 células por linha
+    void writeSyntheticObj(const string& path, size_t triangles)
+    {
+        const size_t columns = 1000;
+        const size_t rows = (triangles + 2 * columns - 1) / (2 * columns);
+
+        FILE* f = fopen(path.c_str(), "wb");
+        for (size_t r = 0; r <= rows; ++r)
+        {
+            for (size_t c = 0; c <= columns; ++c)
+            {
+                fprintf(f, "v %.6f %.6f %.6f\n", c * 0.01, 0.001 * ((r * 7 + c * 13) % 101), r * 0.01);
+            }
+        }
+        for (size_t r = 0; r <= rows; ++r)
+        {
+            for (size_t c = 0; c <= columns; ++c)
+            {
+                fprintf(f, "vt %.6f %.6f\n", (double)c / columns, (double)r / rows);
+            }
+        }
+        fprintf(f, "vn 0 1 0\n");
+
+        size_t written = 0;
+        for (size_t r = 0; r < rows && written < triangles; ++r)
+        {
+            for (size_t c = 0; c < columns && written < triangles; ++c)
+            {
+                size_t a = r * (columns + 1) + c + 1;
+                size_t b = a + 1;
+                size_t d = a + columns + 1;
+                size_t e = d + 1;
+                fprintf(f, "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n", a, a, d, d, b, b);
+                if (++written < triangles)
+                {
+                    fprintf(f, "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n", b, b, d, d, e, e);
+                    ++written;
+                }
+            }
+        }
+        fclose(f);
+    }
+
+    // Menor tempo (ms) entre as repetições
+    double bestOf(int repeats, const function<void()>& run)
+    {
+        double best = 1e30;
+        for (int i = 0; i < repeats; ++i)
+        {
+            auto start = chrono::steady_clock::now();
+            run();
+            best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    template <typename T>
+    bool sameBytes(const vector<T>& a, const vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool sameGeometry(const ObjModel& a, const ObjModel& b)
+    {
+        return sameBytes(a.positions, b.positions) && sameBytes(a.texcoords, b.texcoords) &&
+               sameBytes(a.normals, b.normals) && sameBytes(a.corners, b.corners);
+    }
+
+    // Mede os dois leitores no arquivo e confere se os resultados coincidem
+    bool benchFile(const string& label, const string& path, int repeats)
+    {
+        ObjModel mapped, streamed;
+        double mappedMs = bestOf(repeats, [&]() { loadObj(path, mapped); });
+        double streamMs = bestOf(repeats, [&]() { loadObjStream(path, streamed); });
+
+        size_t triangles = mapped.triangleCount();
+        cout << label << ": " << triangles << " triangles, best of " << repeats << "\n"
+             << "  loadObj       " << mappedMs << " ms (" << triangles / (mappedMs * 1000.0) << " Mtri/s)\n"
+             << "  istringstream " << streamMs << " ms (" << triangles / (streamMs * 1000.0) << " Mtri/s)\n"
+             << "  speedup       " << streamMs / mappedMs << "x" << endl;
+
+        if (triangles == 0 || !sameGeometry(mapped, streamed))
+        {
+            cerr << "FAIL: " << label << " differs between loadObj and the istringstream reader" << endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t triangles = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+    int repeats = argc > 2 ? atoi(argv[2]) : 3;
+
+    bool ok = benchFile("SuzanneSubdiv1.obj", string(ASSETS_DIR) + "SuzanneSubdiv1.obj", repeats);
+
+    string synthetic = (filesystem::temp_directory_path() / "ObjLoaderBench.obj").string();
+    writeSyntheticObj(synthetic, triangles);
+    ok = benchFile("synthetic", synthetic, repeats) && ok;
+    filesystem::remove(synthetic);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+// Leitura paralela de loadObj: o resultado com N threads tem que ser idêntico, byte a byte,
+// ao da leitura com uma thread, e o tempo é medido para cada N (escalabilidade).
+//
+// O .obj sintético tem vários MB (cada thread recebe pelo menos 1 MB), troca de material
+// a cada linha da grade e mistura quads, triângulos e índices negativos, para que as
+// fronteiras entre blocos caiam no meio de faixas de material e de faces de todos os tipos.
+//
+// Uso: ObjParallelTest [threadsMax [triangulos]]
+//   padrão: até max(8, hardware_concurrency) threads, 400000 triângulos
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "ObjLoader.h"
+
+using namespace std;
+
+namespace
+{
+    // Grade de 1000 células por linha; cada célula é um quad ou dois triângulos
+    void writeSyntheticObj(const string& path, size_t triangles)
+    {
+        const size_t columns = 1000;
+        const size_t rows = (triangles + 2 * columns - 1) / (2 * columns);
+        const char* materials[] = { "Pedra", "Madeira", "Metal" };
+
+        FILE* f = fopen(path.c_str(), "wb");
+        fprintf(f, "mtllib Sintetico.mtl\n");
+        for (size_t r = 0; r <= rows; ++r)
+        {
+            for (size_t c = 0; c <= columns; ++c)
+            {
+                fprintf(f, "v %.6f %.6f %.6f\n", c * 0.01, 0.001 * ((r * 7 + c * 13) % 101), r * 0.01);
+                fprintf(f, "vt %.6f %.6f\n", (double)c / columns, (double)r / rows);
+            }
+        }
+        fprintf(f, "vn 0 1 0\nvn 0 0.707107 0.707107\n");
+
+        const long long perRow = (long long)columns + 1;
+        const long long total = perRow * (long long)(rows + 1);
+        size_t written = 0;
+        for (size_t r = 0; r < rows && written < triangles; ++r)
+        {
+            fprintf(f, "usemtl %s\n", materials[(r * 5 / 3) % 3]);
+            for (size_t c = 0; c < columns && written < triangles; ++c)
+            {
+                long long a = (long long)(r * perRow + c + 1);
+                long long b = a + 1;
+                long long d = a + perRow;
+                long long e = d + 1;
+                int vn = 1 + (int)(c & 1);
+                if (r % 4 == 3)
+                {
+                    // índices relativos ao fim da lista (o arquivo declara todos os vértices antes das faces)
+                    a -= total + 1;
+                    b -= total + 1;
+                    d -= total + 1;
+                    e -= total + 1;
+                }
+
+                if (c % 3 == 0 && written + 2 <= triangles)
+                {
+                    fprintf(f, "f %lld/%lld/%d %lld/%lld/%d %lld/%lld/%d %lld/%lld/%d\n", a, a, vn, d, d, vn, e, e, vn, b, b, vn);
+                    written += 2;
+                }
+                else
+                {
+                    fprintf(f, "f %lld/%lld/%d %lld/%lld/%d %lld/%lld/%d\n", a, a, vn, d, d, vn, b, b, vn);
+                    if (++written < triangles)
+                    {
+                        fprintf(f, "f %lld//%d %lld//%d %lld//%d\n", b, vn, d, vn, e, vn);
+                        ++written;
+                    }
+                }
+            }
+        }
+        fclose(f);
+    }
+
+    template <typename T>
+    bool sameBytes(const vector<T>& a, const vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool sameModel(const ObjModel& a, const ObjModel& b)
+    {
+        if (!sameBytes(a.positions, b.positions) || !sameBytes(a.texcoords, b.texcoords) ||
+            !sameBytes(a.normals, b.normals) || !sameBytes(a.corners, b.corners) ||
+            a.mtlLib != b.mtlLib || a.materialNames != b.materialNames ||
+            a.materialRanges.size() != b.materialRanges.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.materialRanges.size(); ++i)
+        {
+            if (a.materialRanges[i].firstTriangle != b.materialRanges[i].firstTriangle ||
+                a.materialRanges[i].materialId != b.materialRanges[i].materialId)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double timeLoad(const string& path, ObjModel& model, int threads, bool& loaded)
+    {
+        // silencia a linha de log de loadObj para não quebrar a tabela
+        streambuf* out = cout.rdbuf(nullptr);
+        auto start = chrono::steady_clock::now();
+        loaded = loadObj(path, model, threads);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout.rdbuf(out);
+        return ms;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = argc > 1 ? atoi(argv[1]) : max(8, (int)thread::hardware_concurrency());
+    size_t triangles = argc > 2 ? strtoull(argv[2], nullptr, 10) : 400000;
+
+    string path = (filesystem::temp_directory_path() / "ObjParallelTest.obj").string();
+    writeSyntheticObj(path, triangles);
+    cout << "synthetic OBJ: " << filesystem::file_size(path) / (1024.0 * 1024.0) << " MB" << endl;
+
+    bool ok = true;
+    ObjModel serial;
+    bool loaded = false;
+    double serialMs = timeLoad(path, serial, 1, loaded);
+    if (!loaded || serial.triangleCount() != triangles || serial.materialNames.size() != 3)
+    {
+        cerr << "FAIL: serial load returned " << serial.triangleCount() << " triangles, "
+             << serial.materialNames.size() << " materials" << endl;
+        ok = false;
+    }
+
+    cout << "threads  time (ms)  speedup  identical" << endl;
+    printf("%7d  %9.2f  %7.2f  %s\n", 1, serialMs, 1.0, "-");
+    for (int threads = 2; ok && threads <= maxThreads; ++threads)
+    {
+        ObjModel parallel;
+        double ms = timeLoad(path, parallel, threads, loaded);
+        bool same = loaded && sameModel(serial, parallel);
+        printf("%7d  %9.2f  %7.2f  %s\n", threads, ms, serialMs / ms, same ? "yes" : "NO");
+        if (!same)
+        {
+            cerr << "FAIL: " << threads << " threads differ from the serial load" << endl;
+            ok = false;
+        }
+    }
+
+    filesystem::remove(path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,267 @@
+// Leitura em streaming (streamObj, Common/ObjStream.h) com respostas conhecidas.
+//
+// O .obj sintético é uma grade de 128 x 80 células (20480 triângulos, ~1 MB) com valores exatos
+// em float, quads v/vt/vn e pares de triângulos com índices negativos, e troca de material a cada
+// 7 linhas. Com o menor orçamento (janela de 64 KB, blocos de 1024 vértices) o arquivo passa por
+// várias janelas e blocos; os triângulos entregues ao sink, concatenados, têm que ser exatamente
+// os escritos, com o material certo, e cada bloco tem que respeitar o limite de vértices e índices.
+// Com a otimização ligada a ordem muda dentro dos blocos, então a comparação é como conjunto.
+// Uma face com mais cantos do que cabem num bloco precisa falhar (e não travar) com o orçamento
+// mínimo e ser lida com um orçamento maior.
+//
+// Uso: ObjStreamTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <filesystem>
+
+#include "MeshCache.h"
+#include "ObjStream.h"
+#include "FileHash.h"
+
+using namespace std;
+
+namespace
+{
+    const int COLUMNS = 128;
+    const int ROWS = 80;
+    const int ROWS_PER_MATERIAL = 7;
+    const char* const MATERIALS[] = { "Pedra", "Madeira", "Metal" };
+
+    // Triângulo como três vértices completos, na ordem dos cantos
+    typedef array<float, 24> Triangle;
+
+    struct Expected
+    {
+        vector<Triangle> triangles;
+        vector<int> materials; // por triângulo
+    };
+
+    // Canto (r, c) da grade com a normal vn (1 ou 2, como no .obj)
+    MeshVertex gridVertex(int r, int c, int vn)
+    {
+        // Tudo múltiplo de potências de 2: o texto do .obj volta ao mesmo float
+        MeshVertex vertex;
+        vertex.position[0] = 0.5f * c;
+        vertex.position[1] = 0.0625f * ((r * 7 + c * 13) % 5); // relevo baixo: o eixo da projeção é sempre Y
+        vertex.position[2] = 0.5f * r;
+        vertex.texcoord[0] = (float)c / COLUMNS;
+        vertex.texcoord[1] = 1.0f - (float)r / COLUMNS; // V invertido pelo carregador
+        vertex.normal[0] = 0.0f;
+        vertex.normal[1] = vn == 2 ? 0.75f : 1.0f;
+        vertex.normal[2] = vn == 2 ? 0.5f : 0.0f;
+        return vertex;
+    }
+
+    Triangle makeTriangle(const MeshVertex& a, const MeshVertex& b, const MeshVertex& c)
+    {
+        Triangle t;
+        memcpy(t.data(), &a, sizeof(MeshVertex));
+        memcpy(t.data() + 8, &b, sizeof(MeshVertex));
+        memcpy(t.data() + 16, &c, sizeof(MeshVertex));
+        return t;
+    }
+
+    // Grava a grade e devolve os triângulos esperados
+    bool writeGridObj(const string& path, Expected& expected)
+    {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        fprintf(f, "mtllib Grade.mtl\n");
+        for (int r = 0; r <= ROWS; ++r)
+        {
+            for (int c = 0; c <= COLUMNS; ++c)
+            {
+                const MeshVertex v = gridVertex(r, c, 1);
+                fprintf(f, "v %.9g %.9g %.9g\nvt %.9g %.9g\n", v.position[0], v.position[1], v.position[2], (float)c / COLUMNS, (float)r / COLUMNS);
+            }
+        }
+        fprintf(f, "vn 0 1 0\nvn 0 0.75 0.5\n");
+
+        const int perRow = COLUMNS + 1;
+        const int total = perRow * (ROWS + 1);
+        for (int r = 0; r < ROWS; ++r)
+        {
+            const int material = (r / ROWS_PER_MATERIAL) % 3;
+            if (r % ROWS_PER_MATERIAL == 0) fprintf(f, "usemtl %s\n", MATERIALS[material]);
+            for (int c = 0; c < COLUMNS; ++c)
+            {
+                const int a = r * perRow + c, b = a + 1, d = a + perRow, e = d + 1; // base 0
+                const int vn = 1 + (c & 1); // uma normal por célula: cantos repetidos com normais diferentes
+                const MeshVertex corners[4] = { gridVertex(r, c, vn), gridVertex(r, c + 1, vn), gridVertex(r + 1, c + 1, vn), gridVertex(r + 1, c, vn) };
+                if (r % 3 == 2)
+                {
+                    // Dois triângulos com índices negativos (relativos ao fim dos atributos)
+                    fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a - total, a - total, vn - 3, b - total, b - total, vn - 3, e - total, e - total, vn - 3);
+                    fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a - total, a - total, vn - 3, e - total, e - total, vn - 3, d - total, d - total, vn - 3);
+                }
+                else
+                {
+                    fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a + 1, a + 1, vn, b + 1, b + 1, vn, e + 1, e + 1, vn, d + 1, d + 1, vn);
+                }
+                // Quad convexo: leque a partir do primeiro canto, igual aos dois triângulos
+                expected.triangles.push_back(makeTriangle(corners[0], corners[1], corners[2]));
+                expected.triangles.push_back(makeTriangle(corners[0], corners[2], corners[3]));
+                expected.materials.push_back(material);
+                expected.materials.push_back(material);
+            }
+        }
+        return fclose(f) == 0;
+    }
+
+    class CollectSink : public ObjStreamSink
+    {
+    public:
+        explicit CollectSink(size_t maxVertices) : maxVertices(maxVertices) {}
+
+        bool consume(const MeshVertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, int materialId) override
+        {
+            ++chunks;
+            if (vertexCount > maxVertices || indexCount > maxVertices * 6 || indexCount % 3 != 0)
+            {
+                cerr << "FAIL: chunk " << chunks << " has " << vertexCount << " vertices and " << indexCount << " indices" << endl;
+                ok = false;
+            }
+            for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+            {
+                if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+                {
+                    cerr << "FAIL: chunk " << chunks << " has an index out of range" << endl;
+                    ok = false;
+                    return false;
+                }
+                triangles.push_back(makeTriangle(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]));
+                materials.push_back(materialId);
+            }
+            return true;
+        }
+
+        size_t maxVertices;
+        size_t chunks = 0;
+        bool ok = true;
+        vector<Triangle> triangles;
+        vector<int> materials;
+    };
+
+    // Roda o triângulo para começar no menor canto, mantendo o giro
+    Triangle canonical(const Triangle& t)
+    {
+        int first = 0;
+        for (int k = 1; k < 3; ++k)
+            if (std::lexicographical_compare(t.begin() + 8 * k, t.begin() + 8 * k + 8, t.begin() + 8 * first, t.begin() + 8 * first + 8)) first = k;
+        Triangle rotated;
+        for (int k = 0; k < 3; ++k) std::copy(t.begin() + 8 * ((first + k) % 3), t.begin() + 8 * ((first + k) % 3) + 8, rotated.begin() + 8 * k);
+        return rotated;
+    }
+
+    bool testGrid(const string& path, const Expected& expected, bool optimize)
+    {
+        ObjStreamOptions options;
+        options.memoryBudget = 1; // mínimo: janela de 64 KB e blocos de 1024 vértices
+        options.optimize.enabled = optimize;
+        ObjStreamInfo info;
+        CollectSink sink(1024);
+        const char* name = optimize ? "grid, optimized" : "grid";
+        bool ok = streamObj(path, sink, options, info) && sink.ok;
+
+        ok = ok && info.triangleCount == expected.triangles.size() && sink.triangles.size() == expected.triangles.size();
+        if (!ok) cerr << "FAIL: " << name << ": " << sink.triangles.size() << " triangles, expected " << expected.triangles.size() << endl;
+        if (ok && (info.mtlLib != "Grade.mtl" || info.materialNames != vector<string>(MATERIALS, MATERIALS + 3)))
+        {
+            cerr << "FAIL: " << name << ": mtllib or material names" << endl;
+            ok = false;
+        }
+        if (ok && info.sourceHash != hashFile(path))
+        {
+            cerr << "FAIL: " << name << ": sourceHash differs from hashFile" << endl;
+            ok = false;
+        }
+        if (ok && sink.materials != expected.materials)
+        {
+            cerr << "FAIL: " << name << ": triangles delivered with the wrong material" << endl;
+            ok = false;
+        }
+        if (ok && !optimize && sink.triangles != expected.triangles)
+        {
+            const size_t t = (size_t)(std::mismatch(sink.triangles.begin(), sink.triangles.end(), expected.triangles.begin()).first - sink.triangles.begin());
+            cerr << "FAIL: " << name << ": triangle " << t << " differs" << endl;
+            ok = false;
+        }
+        if (ok && optimize)
+        {
+            vector<Triangle> got, want;
+            for (const Triangle& t : sink.triangles) got.push_back(canonical(t));
+            for (const Triangle& t : expected.triangles) want.push_back(canonical(t));
+            std::sort(got.begin(), got.end());
+            std::sort(want.begin(), want.end());
+            if (got != want)
+            {
+                cerr << "FAIL: " << name << ": optimized chunks are not the same set of triangles" << endl;
+                ok = false;
+            }
+        }
+        printf("%-24s %zu triangles in %zu chunks  %s\n", name, sink.triangles.size(), sink.chunks, ok ? "ok" : "FAIL");
+        return ok;
+    }
+
+    // Um polígono convexo de corners cantos (um círculo)
+    bool testLargeFace(const string& path, int corners)
+    {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        for (int i = 0; i < corners; ++i)
+        {
+            const double angle = 6.283185307179586 * i / corners;
+            fprintf(f, "v %.6f %.6f 0\n", cos(angle), sin(angle));
+        }
+        fprintf(f, "f");
+        for (int i = 1; i <= corners; ++i) fprintf(f, " %d", i);
+        fprintf(f, "\n");
+        fclose(f);
+
+        ObjStreamOptions options;
+        options.memoryBudget = 1;
+        options.optimize.enabled = false;
+        ObjStreamInfo info;
+        CollectSink tight(1024);
+        const bool rejected = !streamObj(path, tight, options, info);
+
+        options.memoryBudget = 4u << 20;
+        CollectSink roomy(options.memoryBudget);
+        const bool read = streamObj(path, roomy, options, info) && roomy.ok && roomy.triangles.size() == (size_t)corners - 2 && roomy.chunks == 1;
+
+        if (!rejected) cerr << "FAIL: face with " << corners << " corners accepted with the minimum budget" << endl;
+        if (!read) cerr << "FAIL: face with " << corners << " corners not read with a 4 MB budget" << endl;
+        printf("%-24s %d corners: %s with 1024-vertex chunks, %zu triangles with 4 MB  %s\n", "large face", corners,
+               rejected ? "rejected" : "accepted", roomy.triangles.size(), rejected && read ? "ok" : "FAIL");
+        return rejected && read;
+    }
+}
+
+int main()
+{
+    const filesystem::path dir = filesystem::temp_directory_path();
+    const string gridPath = (dir / "ObjStreamTest_grid.obj").string();
+    const string facePath = (dir / "ObjStreamTest_face.obj").string();
+
+    Expected expected;
+    if (!writeGridObj(gridPath, expected))
+    {
+        cerr << "FAIL: could not write " << gridPath << endl;
+        return 1;
+    }
+
+    bool ok = testGrid(gridPath, expected, false);
+    ok = testGrid(gridPath, expected, true) && ok;
+    ok = testLargeFace(facePath, 3000) && ok;
+
+    filesystem::remove(gridPath);
+    filesystem::remove(facePath);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+// Triangulação de faces (triangulatePolygon em Common/ObjParse.h, usada por loadObj e streamObj)
+// com respostas conhecidas.
+//
+// O polígono em L de 6 cantos (área 3) precisa virar 4 triângulos que cobrem o L exatamente uma
+// vez (conferido por amostras numa grade: cada ponto dentro do L cai em um triângulo só, e os de
+// fora em nenhum) e que mantêm o sentido de giro da face. O L é testado nos dois sentidos, a
+// partir de cada canto e em três planos (XY, XZ e inclinado), para passar pela projeção no eixo
+// dominante. Também lê um .obj com o L escrito com os formatos de canto v, v/vt, v//vn, v/vt/vn
+// e índices negativos.
+//
+// Uso: ObjTriangulationTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
+
+#include "ObjLoader.h"
+#include "ObjParse.h"
+
+using namespace std;
+
+namespace
+{
+    // O L no plano (u, v), em sentido anti-horário
+    const glm::vec2 L_SHAPE[] = { { 0, 0 }, { 2, 0 }, { 2, 1 }, { 1, 1 }, { 1, 2 }, { 0, 2 } };
+    const size_t L_CORNERS = sizeof(L_SHAPE) / sizeof(L_SHAPE[0]);
+
+    float signedArea(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+    {
+        return 0.5f * ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+    }
+
+    bool insideL(const glm::vec2& p)
+    {
+        return p.x > 0 && p.y > 0 && p.x < 2 && p.y < 2 && (p.x < 1 || p.y < 1);
+    }
+
+    bool insideTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+    {
+        const float ab = signedArea(a, b, p), bc = signedArea(b, c, p), ca = signedArea(c, a, p);
+        return (ab > 0 && bc > 0 && ca > 0) || (ab < 0 && bc < 0 && ca < 0);
+    }
+
+    // Confere os triângulos (índices em shape) contra o L: quantidade, giro e cobertura
+    bool checkTriangles(const vector<ObjIndex>& corners, const vector<glm::vec2>& shape, float winding, const string& name)
+    {
+        if (corners.size() != 12)
+        {
+            cerr << "FAIL: " << name << ": " << corners.size() / 3 << " triangles, expected 4" << endl;
+            return false;
+        }
+        for (size_t t = 0; t < corners.size(); t += 3)
+        {
+            const float area = signedArea(shape[corners[t].v], shape[corners[t + 1].v], shape[corners[t + 2].v]);
+            if (area * winding <= 0.0f)
+            {
+                cerr << "FAIL: " << name << ": triangle " << t / 3 << " has area " << area << " (wrong winding or degenerate)" << endl;
+                return false;
+            }
+        }
+
+        // Amostras fora das arestas do L e das diagonais possíveis
+        const int samples = 40;
+        for (int y = 0; y < samples; ++y)
+        {
+            for (int x = 0; x < samples; ++x)
+            {
+                const glm::vec2 p(-0.2f + 2.4f * (x + 0.37f) / samples, -0.2f + 2.4f * (y + 0.61f) / samples);
+                int covered = 0;
+                for (size_t t = 0; t < corners.size(); t += 3)
+                    covered += insideTriangle(p, shape[corners[t].v], shape[corners[t + 1].v], shape[corners[t + 2].v]) ? 1 : 0;
+                if (covered != (insideL(p) ? 1 : 0))
+                {
+                    cerr << "FAIL: " << name << ": point (" << p.x << ", " << p.y << ") covered by " << covered << " triangles" << endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Triangula o L mergulhado em 3D por embed, no sentido dado, começando em cada um dos cantos
+    bool testPolygon(const string& name, bool reversed, function<glm::vec3(const glm::vec2&)> embed)
+    {
+        bool ok = true;
+        for (size_t start = 0; start < L_CORNERS && ok; ++start)
+        {
+            vector<glm::vec2> shape;
+            vector<glm::vec3> positions;
+            vector<ObjIndex> polygon;
+            for (size_t i = 0; i < L_CORNERS; ++i)
+            {
+                const size_t k = (start + i) % L_CORNERS;
+                shape.push_back(L_SHAPE[reversed ? L_CORNERS - 1 - k : k]);
+                positions.push_back(embed(shape.back()));
+                polygon.push_back({ (int)i, -1, -1 });
+            }
+
+            TriangulationScratch scratch;
+            vector<ObjIndex> corners;
+            triangulatePolygon(polygon.data(), polygon.size(), positions.data(), positions.size(), scratch, corners);
+            ok = checkTriangles(corners, shape, reversed ? -1.0f : 1.0f,
+                                name + (reversed ? ", clockwise" : "") + ", starting at corner " + to_string(start));
+        }
+        printf("%-24s %-10s %s\n", name.c_str(), reversed ? "clockwise" : "ccw", ok ? "ok" : "FAIL");
+        return ok;
+    }
+
+    // O L num .obj, um formato de canto diferente por vértice
+    bool testObjFile()
+    {
+        const filesystem::path path = filesystem::temp_directory_path() / "ObjTriangulationTest.obj";
+        FILE* f = fopen(path.string().c_str(), "wb");
+        if (!f) return false;
+        for (size_t i = 0; i < L_CORNERS; ++i)
+        {
+            fprintf(f, "v %g %g 0\n", L_SHAPE[i].x, L_SHAPE[i].y);
+            fprintf(f, "vt %g %g\n", L_SHAPE[i].x / 2, L_SHAPE[i].y / 2);
+        }
+        fprintf(f, "vn 0 0 1\n");
+        fprintf(f, "f 1 2/2 3//1 4/4/1 -2/-2/-1 -1/6\n");
+        fclose(f);
+
+        ObjModel model;
+        bool ok = loadObj(path.string(), model, 1);
+        filesystem::remove(path);
+        if (!ok)
+        {
+            cerr << "FAIL: loadObj" << endl;
+            return false;
+        }
+
+        vector<glm::vec2> shape(L_SHAPE, L_SHAPE + L_CORNERS);
+        ok = checkTriangles(model.corners, shape, 1.0f, "obj file");
+        // Cada canto do arquivo, pelo índice da posição: (vt, vn) esperados
+        const int expectedVt[] = { -1, 1, -1, 3, 4, 5 };
+        const int expectedVn[] = { -1, -1, 0, 0, 0, -1 };
+        for (const ObjIndex& corner : model.corners)
+        {
+            if (corner.v < 0 || corner.v >= (int)L_CORNERS || corner.vt != expectedVt[corner.v] || corner.vn != expectedVn[corner.v])
+            {
+                cerr << "FAIL: obj file: corner (" << corner.v << ", " << corner.vt << ", " << corner.vn << ") resolved wrongly" << endl;
+                ok = false;
+                break;
+            }
+        }
+        printf("%-24s %-10s %s\n", "obj file corner forms", "ccw", ok ? "ok" : "FAIL");
+        return ok;
+    }
+}
+
+int main()
+{
+    const pair<const char*, function<glm::vec3(const glm::vec2&)>> planes[] = {
+        { "plane XY", [](const glm::vec2& p) { return glm::vec3(p.x, p.y, 0.0f); } },
+        { "plane XZ", [](const glm::vec2& p) { return glm::vec3(p.x, 5.0f, p.y); } },
+        { "tilted plane", [](const glm::vec2& p) { return glm::vec3(0.3f * p.y - 1.0f, 0.6f * p.x, 0.8f * p.x + 0.5f * p.y); } },
+    };
+
+    bool ok = true;
+    for (const auto& plane : planes)
+    {
+        ok = testPolygon(plane.first, false, plane.second) && ok;
+        ok = testPolygon(plane.first, true, plane.second) && ok;
+    }
+    ok = testObjFile() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+// Chamadas ao driver e custo por uniform de Shader (Common/Shader.h), sem contexto OpenGL.
+//
+// Os ponteiros da glad são trocados por funções que só contam as chamadas e guardam a última
+// localização recebida. O programa tem os uniforms do sprite.fs usados por objeto; cada quadro
+// simulado faz, para cada objeto, os sets de model, posOffset, posScale, texLayer e de três
+// uniforms vt_* da textura virtual (um deles elemento de vt_levelRow).
+// Compara três caminhos: handles Uniform<T>, setters por nome (tabela refletida) e
+// glGetUniformLocation a cada set (como o Shader fazia antes da reflexão).
+// Falha se os handles consultarem o driver durante o quadro, se fizerem mais de um glUniform*
+// por set ou se chegarem a localizações diferentes das do driver.
+//
+// Uso: UniformBench [objetos [quadros]]   (padrão: 1000 objetos, 200 quadros)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "Shader.h"
+
+using namespace std;
+
+namespace
+{
+    // Uniforms ativos do programa simulado; a localização é o índice na lista
+    const char* const ACTIVE_UNIFORMS[] = {
+        "model", "posOffset", "posScale", "texLayer", "tex_buffer", "tex_array",
+        "vt_pageSize", "vt_border", "vt_cacheSize", "vt_maxLevel", "vt_levelRow[0]"
+    };
+    const int ACTIVE_COUNT = sizeof(ACTIVE_UNIFORMS) / sizeof(ACTIVE_UNIFORMS[0]);
+    const GLint VT_LEVEL_ROW_SIZE = 8;
+
+    size_t locationQueries = 0;
+    size_t uniformCalls = 0;
+    GLint lastLocation = -1;
+
+    GLint mockLocation(const char* name)
+    {
+        for (int i = 0; i < ACTIVE_COUNT; ++i)
+            if (strcmp(ACTIVE_UNIFORMS[i], name) == 0) return i;
+        for (GLint k = 1; k < VT_LEVEL_ROW_SIZE; ++k)
+            if (string(name) == "vt_levelRow[" + to_string(k) + "]") return ACTIVE_COUNT + k - 1;
+        return -1;
+    }
+
+    GLuint APIENTRY mockCreate() { return 1; }
+    GLuint APIENTRY mockCreateShader(GLenum) { return 2; }
+    void APIENTRY mockShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+    void APIENTRY mockObject(GLuint) {}
+    void APIENTRY mockAttach(GLuint, GLuint) {}
+    void APIENTRY mockShaderiv(GLuint, GLenum, GLint* value) { *value = GL_TRUE; }
+    void APIENTRY mockIntegerv(GLenum, GLint* value) { *value = 0; }
+    const GLubyte* APIENTRY mockString(GLenum) { return (const GLubyte*)"mock"; }
+    const GLubyte* APIENTRY mockStringi(GLenum, GLuint) { return (const GLubyte*)""; }
+
+    void APIENTRY mockProgramiv(GLuint, GLenum name, GLint* value)
+    {
+        if (name == GL_ACTIVE_UNIFORMS) *value = ACTIVE_COUNT;
+        else if (name == GL_ACTIVE_UNIFORM_MAX_LENGTH) *value = 32;
+        else *value = GL_TRUE;
+    }
+
+    void APIENTRY mockActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+    {
+        const char* uniform = ACTIVE_UNIFORMS[index];
+        *length = (GLsizei)std::min(strlen(uniform), (size_t)bufSize - 1);
+        memcpy(name, uniform, *length);
+        name[*length] = '\0';
+        *size = strcmp(uniform, "vt_levelRow[0]") == 0 ? VT_LEVEL_ROW_SIZE : 1;
+        *type = GL_FLOAT;
+    }
+
+    GLint APIENTRY mockGetUniformLocation(GLuint, const GLchar* name)
+    {
+        ++locationQueries;
+        return mockLocation(name);
+    }
+
+    void APIENTRY mockUniform1i(GLint location, GLint) { ++uniformCalls; lastLocation = location; }
+    void APIENTRY mockUniform1f(GLint location, GLfloat) { ++uniformCalls; lastLocation = location; }
+    void APIENTRY mockUniformfv(GLint location, GLsizei, const GLfloat*) { ++uniformCalls; lastLocation = location; }
+    void APIENTRY mockUniformMatrix4fv(GLint location, GLsizei, GLboolean, const GLfloat*) { ++uniformCalls; lastLocation = location; }
+
+    void installMockDriver()
+    {
+        glad_glCreateProgram = mockCreate;
+        glad_glCreateShader = mockCreateShader;
+        glad_glShaderSource = mockShaderSource;
+        glad_glCompileShader = mockObject;
+        glad_glAttachShader = mockAttach;
+        glad_glLinkProgram = mockObject;
+        glad_glDeleteShader = mockObject;
+        glad_glDeleteProgram = mockObject;
+        glad_glGetShaderiv = mockShaderiv;
+        glad_glGetProgramiv = mockProgramiv;
+        glad_glGetIntegerv = mockIntegerv;
+        glad_glGetString = mockString;
+        glad_glGetStringi = mockStringi;
+        glad_glGetActiveUniform = mockActiveUniform;
+        glad_glGetUniformLocation = mockGetUniformLocation;
+        glad_glUniform1i = mockUniform1i;
+        glad_glUniform1f = mockUniform1f;
+        glad_glUniform3fv = mockUniformfv;
+        glad_glUniformMatrix4fv = mockUniformMatrix4fv;
+    }
+
+    struct FrameCost
+    {
+        size_t locationQueries = 0;
+        size_t uniformCalls = 0;
+        double nsPerSet = 0.0;
+    };
+
+    // Mede frames quadros de f(objeto); sets = sets por objeto
+    template <typename F>
+    FrameCost measure(int objects, int frames, int sets, F f)
+    {
+        const size_t queriesBefore = locationQueries, callsBefore = uniformCalls;
+        auto start = chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+            for (int i = 0; i < objects; ++i) f(i);
+        const double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+        FrameCost cost;
+        cost.locationQueries = (locationQueries - queriesBefore) / frames;
+        cost.uniformCalls = (uniformCalls - callsBefore) / frames;
+        cost.nsPerSet = ns / ((double)frames * objects * sets);
+        return cost;
+    }
+
+    void printCost(const char* name, const FrameCost& cost)
+    {
+        printf("%-28s %10zu %10zu %10.2f\n", name, cost.locationQueries, cost.uniformCalls, cost.nsPerSet);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int objects = argc > 1 ? max(1, atoi(argv[1])) : 1000;
+    const int frames = argc > 2 ? max(1, atoi(argv[2])) : 200;
+    const int setsPerObject = 7;
+    bool ok = true;
+
+    installMockDriver();
+    setShaderCacheEnabled(false);
+    ShaderBatch batch;
+    const int program = batch.submit("#version 330 core\nvoid main() {}\n", "#version 330 core\nvoid main() {}\n", "", "UniformBench");
+
+    // Um handle antes e outro depois da reflexão: os dois caminhos de resolução de slots
+    Uniform<glm::mat4> model = Shader::uniform<glm::mat4>("model");
+    Shader shader(batch, program);
+    Uniform<glm::vec3> posOffset = Shader::uniform<glm::vec3>("posOffset");
+    Uniform<glm::vec3> posScale = Shader::uniform<glm::vec3>("posScale");
+    Uniform<int> texLayer = Shader::uniform<int>("texLayer");
+    Uniform<float> cacheSize = Shader::uniform<float>("vt_cacheSize");
+    Uniform<int> maxLevel = Shader::uniform<int>("vt_maxLevel");
+    Uniform<int> levelRow = Shader::uniform<int>("vt_levelRow[5]");
+    const size_t reflectionQueries = locationQueries;
+
+    // Cada handle chega à mesma localização que o driver daria para o nome
+    const pair<const char*, function<void()>> checks[] = {
+        { "model", [&] { shader.set(model, glm::mat4(1.0f)); } },
+        { "posOffset", [&] { shader.set(posOffset, glm::vec3(0.0f)); } },
+        { "texLayer", [&] { shader.set(texLayer, 0); } },
+        { "vt_maxLevel", [&] { shader.set(maxLevel, 3); } },
+        { "vt_levelRow[5]", [&] { shader.set(levelRow, 0); } },
+    };
+    for (const auto& check : checks)
+    {
+        check.second();
+        if (lastLocation != mockLocation(check.first))
+        {
+            cerr << "FAIL: handle for " << check.first << " set location " << lastLocation << endl;
+            ok = false;
+        }
+    }
+
+    const glm::mat4 matrix(1.0f);
+    const glm::vec3 vector3(0.5f);
+    const FrameCost handles = measure(objects, frames, setsPerObject, [&](int i) {
+        shader.set(model, matrix);
+        shader.set(posOffset, vector3);
+        shader.set(posScale, vector3);
+        shader.set(texLayer, i);
+        shader.set(cacheSize, 2048.0f);
+        shader.set(maxLevel, 7);
+        shader.set(levelRow, i);
+    });
+    const FrameCost names = measure(objects, frames, setsPerObject, [&](int i) {
+        shader.setMat4("model", matrix);
+        shader.setVec3("posOffset", vector3);
+        shader.setVec3("posScale", vector3);
+        shader.setInt("texLayer", i);
+        shader.setFloat("vt_cacheSize", 2048.0f);
+        shader.setInt("vt_maxLevel", 7);
+        shader.setInt("vt_levelRow[5]", i);
+    });
+    const GLuint id = shader.ID;
+    const FrameCost queries = measure(objects, frames, setsPerObject, [&](int i) {
+        glUniformMatrix4fv(glGetUniformLocation(id, "model"), 1, GL_FALSE, glm::value_ptr(matrix));
+        glUniform3fv(glGetUniformLocation(id, "posOffset"), 1, glm::value_ptr(vector3));
+        glUniform3fv(glGetUniformLocation(id, "posScale"), 1, glm::value_ptr(vector3));
+        glUniform1i(glGetUniformLocation(id, "texLayer"), i);
+        glUniform1f(glGetUniformLocation(id, "vt_cacheSize"), 2048.0f);
+        glUniform1i(glGetUniformLocation(id, "vt_maxLevel"), 7);
+        glUniform1i(glGetUniformLocation(id, "vt_levelRow[5]"), i);
+    });
+
+    cout << objects << " objects x " << setsPerObject << " uniforms, " << frames << " frames; "
+         << reflectionQueries << " glGetUniformLocation calls during reflection" << endl;
+    printf("%-28s %10s %10s %10s\n", "per frame", "locations", "glUniform", "ns/set");
+    printCost("Uniform<T> handles", handles);
+    printCost("setters by name", names);
+    printCost("glGetUniformLocation + set", queries);
+
+    const size_t expectedCalls = (size_t)objects * setsPerObject;
+    if (handles.locationQueries != 0 || handles.uniformCalls != expectedCalls)
+    {
+        cerr << "FAIL: handles made " << handles.locationQueries << " location queries and "
+             << handles.uniformCalls << " glUniform calls per frame (expected 0 and " << expectedCalls << ")" << endl;
+        ok = false;
+    }
+    if (names.locationQueries != 0)
+    {
+        cerr << "FAIL: setters by name queried the driver " << names.locationQueries << " times per frame" << endl;
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,405 @@
+// Lado OpenGL da textura virtual (Common/VirtualTexture.h), sem contexto OpenGL.
+//
+// Os ponteiros da glad são trocados por um driver simulado: as texturas guardam o último
+// glTexSubImage2D, e o glReadPixels num PBO copia uma "cena" de feedback montada aqui, que o
+// glMapBufferRange devolve depois. Com uma imagem de 1024x1024 (8x8 páginas no nível 0) e um
+// cache de 2x2 slots (um fixo com a página mais grossa), confere:
+//   - a leitura do feedback, com um quadro de atraso e ignorando pixels de outro id;
+//   - o limite de páginas por update() e a ordem (mais grossas primeiro);
+//   - o conteúdo de cada página enviada ao cache, contra o .vtx;
+//   - a indireção depois de cada update, inclusive a queda para a página mais grossa;
+//   - a troca LRU: preserva as páginas pedidas no último feedback e tira a usada há mais tempo.
+//
+// Uso: VirtualTextureGLTest
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+#include "VirtualTexture.h"
+
+using namespace std;
+
+namespace
+{
+    const int FEEDBACK_WIDTH = 32;
+    const int FEEDBACK_HEIGHT = 16;
+
+    struct Upload
+    {
+        GLuint texture;
+        GLint x, y;
+        GLsizei width, height;
+        const uint8_t* pixels;
+    };
+
+    GLuint nextName = 1;
+    GLuint boundTexture = 0;
+    GLuint boundPackBuffer = 0;
+    vector<Upload> uploads;
+    map<GLuint, vector<uint8_t>> bufferData;
+    vector<uint8_t> scene((size_t)FEEDBACK_WIDTH * FEEDBACK_HEIGHT * 4, 0);
+    size_t readPixelsCalls = 0;
+
+    void APIENTRY mockGen(GLsizei n, GLuint* names) { for (GLsizei i = 0; i < n; ++i) names[i] = nextName++; }
+    void APIENTRY mockDelete(GLsizei, const GLuint*) {}
+    void APIENTRY mockBindTexture(GLenum, GLuint texture) { boundTexture = texture; }
+    void APIENTRY mockBind(GLenum, GLuint) {}
+    void APIENTRY mockEnum(GLenum) {}
+    void APIENTRY mockTexParameteri(GLenum, GLenum, GLint) {}
+    void APIENTRY mockTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) {}
+    void APIENTRY mockRenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) {}
+    void APIENTRY mockFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+    void APIENTRY mockFramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) {}
+    GLenum APIENTRY mockCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+    void APIENTRY mockViewport(GLint, GLint, GLsizei, GLsizei) {}
+    void APIENTRY mockClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {}
+    void APIENTRY mockClear(GLbitfield) {}
+    void APIENTRY mockGetFloatv(GLenum, GLfloat* value) { for (int i = 0; i < 4; ++i) value[i] = 0.0f; }
+    GLboolean APIENTRY mockUnmapBuffer(GLenum) { return GL_TRUE; }
+
+    void APIENTRY mockGetIntegerv(GLenum name, GLint* value)
+    {
+        if (name == GL_VIEWPORT)
+        {
+            const GLint viewport[4] = { 0, 0, FEEDBACK_WIDTH * 4, FEEDBACK_HEIGHT * 4 };
+            memcpy(value, viewport, sizeof(viewport));
+        }
+        else *value = 0;
+    }
+
+    void APIENTRY mockTexSubImage2D(GLenum, GLint, GLint x, GLint y, GLsizei width, GLsizei height, GLenum, GLenum, const void* pixels)
+    {
+        uploads.push_back({ boundTexture, x, y, width, height, (const uint8_t*)pixels });
+    }
+
+    void APIENTRY mockBindBuffer(GLenum target, GLuint buffer)
+    {
+        if (target == GL_PIXEL_PACK_BUFFER) boundPackBuffer = buffer;
+    }
+
+    void APIENTRY mockBufferData(GLenum, GLsizeiptr size, const void*, GLenum)
+    {
+        bufferData[boundPackBuffer].assign((size_t)size, 0);
+    }
+
+    // A "GPU" termina o desenho na hora: o PBO recebe a cena atual
+    void APIENTRY mockReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum, GLenum, void*)
+    {
+        ++readPixelsCalls;
+        vector<uint8_t>& data = bufferData[boundPackBuffer];
+        memcpy(data.data(), scene.data(), std::min(data.size(), (size_t)width * height * 4));
+    }
+
+    void* APIENTRY mockMapBufferRange(GLenum, GLintptr, GLsizeiptr, GLbitfield)
+    {
+        return bufferData[boundPackBuffer].data();
+    }
+
+    void installMockDriver()
+    {
+        glad_glGenTextures = mockGen;
+        glad_glGenFramebuffers = mockGen;
+        glad_glGenRenderbuffers = mockGen;
+        glad_glGenBuffers = mockGen;
+        glad_glDeleteTextures = mockDelete;
+        glad_glDeleteFramebuffers = mockDelete;
+        glad_glDeleteRenderbuffers = mockDelete;
+        glad_glDeleteBuffers = mockDelete;
+        glad_glBindTexture = mockBindTexture;
+        glad_glBindFramebuffer = mockBind;
+        glad_glBindRenderbuffer = mockBind;
+        glad_glBindBuffer = mockBindBuffer;
+        glad_glActiveTexture = mockEnum;
+        glad_glTexParameteri = mockTexParameteri;
+        glad_glTexImage2D = mockTexImage2D;
+        glad_glTexSubImage2D = mockTexSubImage2D;
+        glad_glRenderbufferStorage = mockRenderbufferStorage;
+        glad_glFramebufferTexture2D = mockFramebufferTexture2D;
+        glad_glFramebufferRenderbuffer = mockFramebufferRenderbuffer;
+        glad_glCheckFramebufferStatus = mockCheckFramebufferStatus;
+        glad_glGetIntegerv = mockGetIntegerv;
+        glad_glGetFloatv = mockGetFloatv;
+        glad_glViewport = mockViewport;
+        glad_glClearColor = mockClearColor;
+        glad_glClear = mockClear;
+        glad_glBufferData = mockBufferData;
+        glad_glReadPixels = mockReadPixels;
+        glad_glMapBufferRange = mockMapBufferRange;
+        glad_glUnmapBuffer = mockUnmapBuffer;
+    }
+
+    // TGA 32 bits sem compressão, linhas de cima para baixo
+    bool writeTga(const string& path, uint32_t width, uint32_t height)
+    {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        const uint8_t header[18] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                     (uint8_t)width, (uint8_t)(width >> 8), (uint8_t)height, (uint8_t)(height >> 8), 32, 0x28 };
+        fwrite(header, 1, sizeof(header), f);
+        vector<uint8_t> row((size_t)width * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                // Hash da posição: nenhuma página se repete, então o conteúdo identifica a página
+                uint32_t h = (x * 0x9E3779B1u) ^ (y * 0x85EBCA77u);
+                h ^= h >> 15;
+                h *= 0x2C1B3C6Du;
+                h ^= h >> 12;
+                memcpy(&row[x * 4], &h, 4);
+            }
+            fwrite(row.data(), 1, row.size(), f);
+        }
+        return fclose(f) == 0;
+    }
+
+    struct Request
+    {
+        uint8_t level, x, y;
+    };
+
+    // Preenche a cena com as páginas pedidas (uma por pixel, o resto vazio) e alguns pixels de
+    // outra textura virtual, que precisam ser ignorados
+    void setScene(const vector<Request>& requests, int id)
+    {
+        std::fill(scene.begin(), scene.end(), 0);
+        size_t pixel = 0;
+        for (const Request& request : requests)
+        {
+            uint8_t* p = scene.data() + 4 * pixel++;
+            p[0] = request.x;
+            p[1] = request.y;
+            p[2] = request.level;
+            p[3] = (uint8_t)id;
+        }
+        for (int i = 0; i < 8; ++i)
+        {
+            uint8_t* p = scene.data() + 4 * pixel++;
+            p[0] = p[1] = (uint8_t)i;
+            p[2] = 0;
+            p[3] = (uint8_t)(id + 1);
+        }
+    }
+
+    // Dois quadros com a mesma cena: o segundo processa a leitura do primeiro
+    void feedback(VirtualTexture& texture, const vector<Request>& requests, int id)
+    {
+        setScene(requests, id);
+        for (int i = 0; i < 2; ++i)
+        {
+            texture.beginFeedback(FEEDBACK_WIDTH, FEEDBACK_HEIGHT);
+            texture.endFeedback();
+        }
+    }
+
+    class Checker
+    {
+    public:
+        Checker(const VirtualTexture& texture, const MappedFile& vtx, GLuint cacheTexture, GLuint indirectionTexture)
+            : texture(texture), vtx(vtx), cacheTexture(cacheTexture), indirectionTexture(indirectionTexture)
+        {
+            const VirtualTextureHeader& header = texture.getHeader();
+            uint32_t row = 0;
+            for (uint32_t level = 0; level < header.levelCount; ++level)
+            {
+                levelRow.push_back(row);
+                row += header.levels[level].pagesY;
+            }
+        }
+
+        uint32_t page(uint32_t level, uint32_t x, uint32_t y) const
+        {
+            const VirtualTextureLevel& info = texture.getHeader().levels[level];
+            return info.firstPage + y * info.pagesX + x;
+        }
+
+        // Envios ao cache desde first: devolve as páginas, identificadas pelo conteúdo no .vtx
+        vector<uint32_t> cacheUploads(size_t first) const
+        {
+            vector<uint32_t> pages;
+            for (size_t i = first; i < uploads.size(); ++i)
+            {
+                const Upload& upload = uploads[i];
+                if (upload.texture != cacheTexture) continue;
+                uint32_t found = 0xFFFFFFFFu, matches = 0;
+                for (uint32_t page = 0; page < texture.getHeader().pageCount; ++page)
+                {
+                    if (memcmp(upload.pixels, (const uint8_t*)vtx.begin() + virtualTexturePageOffset(page), VT_PAGE_BYTES) == 0)
+                    {
+                        found = page;
+                        ++matches;
+                    }
+                }
+                if (upload.width != (GLsizei)VT_STORED_PAGE_SIZE || upload.height != (GLsizei)VT_STORED_PAGE_SIZE || matches != 1)
+                    cerr << "FAIL: cache upload " << i << " is not exactly one page of the .vtx" << endl;
+                pages.push_back(found);
+            }
+            return pages;
+        }
+
+        // Entrada da indireção no último envio da tabela: slot x, slot y, nível
+        bool entry(uint32_t level, uint32_t x, uint32_t y, uint8_t slotX, uint8_t slotY, uint8_t usedLevel, const char* what) const
+        {
+            const Upload* table = nullptr;
+            for (const Upload& upload : uploads)
+                if (upload.texture == indirectionTexture) table = &upload;
+            if (!table)
+            {
+                cerr << "FAIL: indirection never uploaded" << endl;
+                return false;
+            }
+            const uint8_t* e = table->pixels + ((size_t)(levelRow[level] + y) * table->width + x) * 4;
+            if (e[0] != slotX || e[1] != slotY || e[2] != usedLevel || e[3] != 255)
+            {
+                cerr << "FAIL: " << what << ": indirection of level " << level << " page (" << x << ", " << y << ") is ("
+                     << (int)e[0] << ", " << (int)e[1] << ", " << (int)e[2] << ", " << (int)e[3] << "), expected ("
+                     << (int)slotX << ", " << (int)slotY << ", " << (int)usedLevel << ", 255)" << endl;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        const VirtualTexture& texture;
+        const MappedFile& vtx;
+        GLuint cacheTexture;
+        GLuint indirectionTexture;
+        vector<uint32_t> levelRow;
+    };
+
+    bool expect(bool condition, const string& what)
+    {
+        if (!condition) cerr << "FAIL: " << what << endl;
+        return condition;
+    }
+}
+
+int main()
+{
+    installMockDriver();
+    const filesystem::path image = filesystem::temp_directory_path() / "VirtualTextureGLTest.tga";
+    const string vtxPath = virtualTexturePath(image.string());
+    if (!writeTga(image.string(), 1024, 1024))
+    {
+        cerr << "FAIL: could not write " << image << endl;
+        return 1;
+    }
+
+    bool ok = true;
+    {
+        const int id = 3;
+        VirtualTexture texture;
+        // Os nomes saem em ordem: cache e indireção são as duas primeiras texturas de open()
+        const GLuint cacheTexture = nextName, indirectionTexture = nextName + 1;
+        if (!texture.open(image.string(), 2, id))
+        {
+            cerr << "FAIL: open" << endl;
+            filesystem::remove(image);
+            return 1;
+        }
+        MappedFile vtx;
+        vtx.open(vtxPath);
+        const VirtualTextureHeader& header = texture.getHeader();
+        const uint8_t top = (uint8_t)(header.levelCount - 1);
+        Checker check(texture, vtx, cacheTexture, indirectionTexture);
+        ok = expect(header.levelCount == 4 && header.levels[0].pagesX == 8 && header.levels[top].pagesX == 1,
+                    "1024x1024 should have 4 levels, 8x8 pages down to 1x1") && ok;
+        if (!ok)
+        {
+            filesystem::remove(vtxPath);
+            filesystem::remove(image);
+            return 1;
+        }
+
+        // open(): só a página mais grossa, no slot 0, e toda a indireção apontando para ela
+        vector<uint32_t> sent = check.cacheUploads(0);
+        ok = expect(sent == vector<uint32_t>{ header.pageCount - 1 }, "open should upload only the coarsest page") && ok;
+        ok = expect(texture.getStats().residentPages == 1, "one resident page after open") && ok;
+        ok = check.entry(0, 7, 7, 0, 0, top, "after open") && ok;
+        ok = check.entry(1, 2, 3, 0, 0, top, "after open") && ok;
+
+        // Feedback com a página (5, 3) do nível 0: ela e as três acima; a raiz já está no cache
+        size_t mark = uploads.size();
+        feedback(texture, { { 0, 5, 3 } }, id);
+        ok = expect(readPixelsCalls == 2, "one glReadPixels per endFeedback") && ok;
+        ok = expect(texture.getStats().pagesRequested == 4 && texture.getStats().pagesMissing == 3,
+                    "feedback of one level-0 page should request 4 pages, 3 missing (got " +
+                    to_string(texture.getStats().pagesRequested) + ", " + to_string(texture.getStats().pagesMissing) + ")") && ok;
+        ok = expect(check.cacheUploads(mark).empty(), "feedback alone must not upload pages") && ok;
+
+        // Limite de uma página: a do nível 2, que já serve de substituta para o nível 0
+        mark = uploads.size();
+        ok = expect(texture.update(1) == 1, "update(1) should upload one page") && ok;
+        ok = expect(check.cacheUploads(mark) == vector<uint32_t>{ check.page(2, 1, 0) }, "update(1) should send the level-2 page first") && ok;
+        ok = check.entry(0, 5, 3, 1, 0, 2, "after update(1)") && ok;
+        ok = check.entry(0, 0, 0, 0, 0, top, "after update(1)") && ok;
+
+        // O resto: nível 1 e depois nível 0, nos slots 2 e 3
+        mark = uploads.size();
+        ok = expect(texture.update(16) == 2, "update(16) should upload the 2 remaining pages") && ok;
+        ok = expect(check.cacheUploads(mark) == vector<uint32_t>{ check.page(1, 2, 1), check.page(0, 5, 3) },
+                    "remaining pages should go coarse to fine") && ok;
+        ok = check.entry(0, 5, 3, 1, 1, 0, "after update(16)") && ok;
+        ok = check.entry(0, 4, 2, 0, 1, 1, "after update(16)") && ok;
+        ok = check.entry(1, 2, 1, 0, 1, 1, "after update(16)") && ok;
+        ok = expect(texture.update(16) == 0, "nothing left to upload") && ok;
+        ok = expect(texture.getStats().residentPages == 4 && texture.getStats().pagesEvicted == 0, "cache full, nothing evicted") && ok;
+
+        // LRU: (4, 2) divide os níveis 1 e 2 com (5, 3). Só (5, 3) ficou sem uso e sai do cache
+        mark = uploads.size();
+        feedback(texture, { { 0, 4, 2 } }, id);
+        ok = expect(texture.getStats().pagesMissing == 1, "only the new level-0 page should be missing") && ok;
+        ok = expect(texture.update(16) == 1, "LRU update should upload one page") && ok;
+        ok = expect(check.cacheUploads(mark) == vector<uint32_t>{ check.page(0, 4, 2) }, "LRU update should send (4, 2)") && ok;
+        ok = expect(texture.getStats().pagesEvicted == 1, "LRU should evict exactly one page") && ok;
+        ok = check.entry(0, 4, 2, 1, 1, 0, "after eviction") && ok;
+        ok = check.entry(0, 5, 3, 0, 1, 1, "evicted page falls back to level 1") && ok;
+        ok = check.entry(1, 2, 1, 0, 1, 1, "after eviction") && ok;
+
+        // Cache pequeno demais para o quadro: seis páginas pedidas, três slots livres de páginas
+        // do feedback atual. O update para em três e os outros seguem pendentes sem trocar nada
+        feedback(texture, { { 0, 0, 0 }, { 0, 7, 7 } }, id);
+        ok = expect(texture.getStats().pagesMissing == 6, "two distant pages should miss 6 pages (got " +
+                    to_string(texture.getStats().pagesMissing) + ")") && ok;
+        mark = uploads.size();
+        ok = expect(texture.update(16) == 3, "update should stop when every slot is in use this frame") && ok;
+        ok = expect(check.cacheUploads(mark) == vector<uint32_t>{ check.page(2, 1, 1), check.page(2, 0, 0), check.page(1, 3, 3) },
+                    "overflowing frame should still send the coarsest pages first") && ok;
+        ok = expect(texture.update(16) == 0, "no slot left for the current feedback") && ok;
+        ok = check.entry(0, 7, 7, 1, 1, 1, "overflowing frame") && ok;
+        ok = check.entry(0, 0, 0, 0, 1, 2, "overflowing frame") && ok;
+
+        // Idades diferentes: (7, 7) mantém os slots 1 e 3 em uso; o slot 2, com L2 (0, 0), fica
+        // sem pedido por dois quadros. (0, 7) não tem nada no cache além da raiz e o único envio
+        // permitido precisa tirar o slot mais antigo
+        feedback(texture, { { 0, 7, 7 } }, id);
+        feedback(texture, { { 0, 0, 7 } }, id);
+        mark = uploads.size();
+        ok = expect(texture.update(1) == 1, "update(1) with three evictable slots") && ok;
+        ok = expect(check.cacheUploads(mark) == vector<uint32_t>{ check.page(2, 0, 1) }, "LRU frame should send L2 (0, 1)") && ok;
+        ok = check.entry(0, 0, 7, 0, 1, 2, "least recently used slot replaced") && ok;
+        ok = check.entry(0, 0, 0, 0, 0, top, "evicted L2 (0, 0) falls back to the root") && ok;
+        ok = check.entry(0, 7, 7, 1, 1, 1, "recently used slots kept") && ok;
+        ok = check.entry(1, 3, 3, 1, 1, 1, "recently used slots kept") && ok;
+
+        const VirtualTextureStats& stats = texture.getStats();
+        printf("pages uploaded %zu, evicted %zu, resident %zu, feedback reads %zu\n",
+               stats.pagesUploaded, stats.pagesEvicted, stats.residentPages, readPixelsCalls);
+        vtx.close();
+        texture.close();
+    }
+
+    filesystem::remove(vtxPath);
+    filesystem::remove(image);
+    cout << (ok ? "ok" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+// Tiler da textura virtual (buildVirtualTexture, Common/VirtualTextureFile), sem OpenGL.
+//
+// Gera imagens TGA de tamanhos variados (não múltiplos da página, uma linha, uma coluna, uma
+// página só), monta o .vtx e confere o cabeçalho e cada pixel de cada página, bordas incluídas,
+// contra os níveis montados aqui com downsampleRgba.
+//
+// Uso: VirtualTextureTest [lado]
+//   com lado (p.ex. 16384) gera só uma imagem lado x lado, confere o cabeçalho e mostra o tempo
+//   e o pico de memória do processo (o tiler não copia o buffer do stb_image)
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "VirtualTextureFile.h"
+#include "MipBuilder.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+namespace
+{
+    uint8_t pattern(uint32_t x, uint32_t y, int channel)
+    {
+        return (uint8_t)((x * 7 + y * 13 + channel * 61 + ((x ^ y) & 31)) & 255);
+    }
+
+    // TGA 32 bits sem compressão, linhas de cima para baixo; gravada em faixas para não montar
+    // a imagem inteira na memória
+    bool writeTga(const string& path, uint32_t width, uint32_t height)
+    {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        const uint8_t header[18] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                     (uint8_t)width, (uint8_t)(width >> 8), (uint8_t)height, (uint8_t)(height >> 8), 32, 0x28 };
+        fwrite(header, 1, sizeof(header), f);
+        vector<uint8_t> row((size_t)width * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                // TGA guarda BGRA
+                row[x * 4 + 0] = pattern(x, y, 2);
+                row[x * 4 + 1] = pattern(x, y, 1);
+                row[x * 4 + 2] = pattern(x, y, 0);
+                row[x * 4 + 3] = pattern(x, y, 3);
+            }
+            fwrite(row.data(), 1, row.size(), f);
+        }
+        return fclose(f) == 0;
+    }
+
+    size_t peakMemoryMB()
+    {
+#ifndef _WIN32
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (size_t)usage.ru_maxrss / 1024; // KB no Linux
+#else
+        return 0;
+#endif
+    }
+
+    // Confere cabeçalho e páginas de um .vtx contra os níveis da imagem
+    bool checkTiles(const string& vtxPath, uint32_t width, uint32_t height, bool checkPixels)
+    {
+        MappedFile file;
+        if (!file.open(vtxPath) || file.getSize() < sizeof(VirtualTextureHeader))
+        {
+            cerr << "FAIL: could not map " << vtxPath << endl;
+            return false;
+        }
+        VirtualTextureHeader header;
+        memcpy(&header, file.begin(), sizeof(header));
+        if (!validVirtualTextureHeader(header, file.getSize()) || header.levels[0].width != width || header.levels[0].height != height)
+        {
+            cerr << "FAIL: invalid header for " << width << "x" << height << endl;
+            return false;
+        }
+        if (validVirtualTextureHeader(header, file.getSize() - 1))
+        {
+            cerr << "FAIL: truncated file accepted" << endl;
+            return false;
+        }
+        if (!checkPixels) return true;
+
+        vector<uint8_t> level((size_t)width * height * 4), next;
+        for (uint32_t y = 0; y < height; ++y)
+            for (uint32_t x = 0; x < width; ++x)
+                for (int c = 0; c < 4; ++c) level[((size_t)y * width + x) * 4 + c] = pattern(x, y, c);
+
+        uint32_t levelWidth = width, levelHeight = height;
+        for (uint32_t l = 0; l < header.levelCount; ++l)
+        {
+            const VirtualTextureLevel& entry = header.levels[l];
+            if (entry.width != levelWidth || entry.height != levelHeight ||
+                entry.pagesX != (levelWidth + VT_PAGE_SIZE - 1) / VT_PAGE_SIZE || entry.pagesY != (levelHeight + VT_PAGE_SIZE - 1) / VT_PAGE_SIZE)
+            {
+                cerr << "FAIL: level " << l << " of " << width << "x" << height << " has the wrong size" << endl;
+                return false;
+            }
+            for (uint32_t py = 0; py < entry.pagesY; ++py)
+            {
+                for (uint32_t px = 0; px < entry.pagesX; ++px)
+                {
+                    const uint8_t* page = (const uint8_t*)file.begin() + virtualTexturePageOffset(entry.firstPage + py * entry.pagesX + px);
+                    for (uint32_t ty = 0; ty < VT_STORED_PAGE_SIZE; ++ty)
+                    {
+                        const int64_t y = std::clamp<int64_t>((int64_t)py * VT_PAGE_SIZE + ty - VT_PAGE_BORDER, 0, levelHeight - 1);
+                        for (uint32_t tx = 0; tx < VT_STORED_PAGE_SIZE; ++tx)
+                        {
+                            const int64_t x = std::clamp<int64_t>((int64_t)px * VT_PAGE_SIZE + tx - VT_PAGE_BORDER, 0, levelWidth - 1);
+                            if (memcmp(page + ((size_t)ty * VT_STORED_PAGE_SIZE + tx) * 4, &level[((size_t)y * levelWidth + x) * 4], 4) != 0)
+                            {
+                                cerr << "FAIL: " << width << "x" << height << " level " << l << " page (" << px << ", " << py
+                                     << ") texel (" << tx << ", " << ty << ")" << endl;
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+            downsampleRgba(level.data(), levelWidth, levelHeight, next);
+            level.swap(next);
+            levelWidth = std::max(1u, levelWidth / 2);
+            levelHeight = std::max(1u, levelHeight / 2);
+        }
+        return true;
+    }
+
+    bool testSize(uint32_t width, uint32_t height, bool checkPixels)
+    {
+        const filesystem::path image = filesystem::temp_directory_path() / ("VirtualTextureTest_" + to_string(width) + "x" + to_string(height) + ".tga");
+        const string vtx = virtualTexturePath(image.string());
+        if (!writeTga(image.string(), width, height))
+        {
+            cerr << "FAIL: could not write " << image << endl;
+            return false;
+        }
+
+        auto start = chrono::steady_clock::now();
+        bool ok = buildVirtualTexture(image.string(), vtx);
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (!ok) cerr << "FAIL: buildVirtualTexture " << width << "x" << height << endl;
+        ok = ok && checkTiles(vtx, width, height, checkPixels);
+        printf("%5ux%-5u  build %9.2f ms  peak RSS %zu MB  %s\n", width, height, ms, peakMemoryMB(), ok ? "ok" : "FAIL");
+
+        filesystem::remove(vtx);
+        filesystem::remove(image);
+        return ok;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        const uint32_t side = (uint32_t)atoi(argv[1]);
+        return testSize(side, side, false) ? 0 : 1;
+    }
+
+    const pair<uint32_t, uint32_t> sizes[] = {
+        { 1000, 700 }, { 300, 1 }, { 1, 300 }, { 128, 128 }, { 129, 129 }, { 64, 40 }, { 2048, 1024 }
+    };
+    bool ok = true;
+    for (const auto& size : sizes)
+    {
+        ok = testSize(size.first, size.second, true) && ok;
+    }
+    return ok ? 0 : 1;
+}